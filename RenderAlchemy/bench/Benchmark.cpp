@@ -0,0 +1,642 @@
+// Benchmarks for the CPU side kernels of RenderAlchemy: CLUT file IO, preset generation, LUT resampling and
+// application, and the meshoptimizer passes the mesh pipeline runs. Results are written as JSON together with
+// the hardware they were measured on, and can be compared against a stored baseline run.
+//
+//   RenderAlchemyBench [--out benchmark.json] [--baseline baseline.json] [--threshold 0.10]
+//                      [--samples 15] [--filter name] [--clut file.cube]... [--mesh file.obj]... [--help]
+//
+// Every benchmark runs a calibrated number of iterations per sample, so each sample takes at least kMinSampleMs,
+// and reports the median, minimum and 95th percentile time per iteration. With a baseline, a benchmark whose
+// median is slower than the baseline median by more than the threshold is reported as a regression and the
+// program exits with 1.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/utsname.h>
+#endif
+
+#include "../src/clut/CLUT.h"
+#include "../src/core/JobSystem.h"
+#include "../src/meshoptimizer/meshoptimizer.h"
+
+namespace
+{
+	constexpr double kMinSampleMs = 10.0;
+	constexpr int kImageSize = 512; // Width and height of the image a LUT is applied to
+	constexpr int kResampleSize = 33; // Common .cube resolution, larger than any preset
+	constexpr int kSphereSegments = 256;
+
+	using Clock = std::chrono::steady_clock;
+
+	// Results are folded into this so the compiler cannot drop the work being measured
+	volatile uint64_t sink = 0;
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		uint64_t iterations = 0; // Per sample
+		int samples = 0;
+		double medianNs = 0.0; // Per iteration
+		double minNs = 0.0;
+		double p95Ns = 0.0;
+		double items = 0.0; // Work per iteration, e.g. pixels or triangles
+		std::string itemName;
+	};
+
+	struct Options
+	{
+		std::string outPath = "benchmark.json";
+		std::string baselinePath;
+		double threshold = 0.10;
+		int samples = 15;
+		std::string filter;
+		std::vector<std::string> clutPaths;
+		std::vector<std::string> meshPaths;
+		bool help = false;
+	};
+
+	struct Mesh
+	{
+		std::string name;
+		std::vector<float> vertices; // Position and normal per vertex
+		std::vector<uint32_t> indices;
+		size_t vertexCount() const { return vertices.size() / 6; }
+	};
+
+	class BenchmarkRunner
+	{
+	public:
+		explicit BenchmarkRunner(const Options& options)
+		      : options(options)
+		{
+		}
+
+		// Time body, which does items units of work per call
+		void run(const std::string& name, double items, const char* itemName, const std::function<uint64_t()>& body)
+		{
+			if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+				return;
+
+			// The first call warms caches and page tables and tells how many calls fill a sample
+			auto start = Clock::now();
+			sink = sink + body();
+			const double firstMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			const uint64_t iterations = std::max<uint64_t>(1, static_cast<uint64_t>(kMinSampleMs / std::max(firstMs, 1e-6)));
+
+			std::vector<double> times;
+			times.reserve(options.samples);
+			for (int sample = 0; sample < options.samples; ++sample)
+			{
+				start = Clock::now();
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					sink = sink + body();
+				}
+				const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+				times.push_back(ns / double(iterations));
+			}
+			std::sort(times.begin(), times.end());
+
+			BenchmarkResult result;
+			result.name = name;
+			result.iterations = iterations;
+			result.samples = options.samples;
+			result.medianNs = times[times.size() / 2];
+			result.minNs = times.front();
+			result.p95Ns = times[std::min(times.size() - 1, static_cast<size_t>(std::ceil(0.95 * times.size())) - 1)];
+			result.items = items;
+			result.itemName = itemName;
+			results.push_back(result);
+
+			std::fprintf(stderr, "%-40s %12.3f us  %10.3g %s/s\n", name.c_str(), result.medianNs / 1000.0, items / result.medianNs * 1e9, itemName);
+		}
+
+		const std::vector<BenchmarkResult>& getResults() const { return results; }
+
+	private:
+		const Options& options;
+		std::vector<BenchmarkResult> results;
+	};
+
+	std::string escapeJson(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				escaped += '\\';
+				escaped += c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char code[8];
+				std::snprintf(code, sizeof(code), "\\u%04x", c);
+				escaped += code;
+			}
+			else
+			{
+				escaped += c;
+			}
+		}
+		return escaped;
+	}
+
+	std::string readCpuModel()
+	{
+		std::ifstream cpuinfo("/proc/cpuinfo");
+		std::string line;
+		while (std::getline(cpuinfo, line))
+		{
+			if (line.rfind("model name", 0) == 0)
+			{
+				const size_t colon = line.find(':');
+				return colon == std::string::npos ? std::string() : line.substr(line.find_first_not_of(' ', colon + 1));
+			}
+		}
+		return "unknown";
+	}
+
+	std::string readOperatingSystem()
+	{
+#if defined(__linux__) || defined(__APPLE__)
+		utsname name;
+		if (uname(&name) == 0)
+			return std::string(name.sysname) + " " + name.release + " " + name.machine;
+#elif defined(_WIN32)
+		return "Windows";
+#endif
+		return "unknown";
+	}
+
+	std::string getCompiler()
+	{
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+		return "unknown";
+#endif
+	}
+
+	void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results)
+	{
+		out << "{\n";
+		out << "  \"hardware\": {\n";
+		out << "    \"cpu\": \"" << escapeJson(readCpuModel()) << "\",\n";
+		out << "    \"threads\": " << std::thread::hardware_concurrency() << ",\n";
+		out << "    \"os\": \"" << escapeJson(readOperatingSystem()) << "\",\n";
+		out << "    \"compiler\": \"" << escapeJson(getCompiler()) << "\",\n";
+#ifdef NDEBUG
+		out << "    \"build\": \"release\"\n";
+#else
+		out << "    \"build\": \"debug\"\n";
+#endif
+		out << "  },\n";
+		out << "  \"benchmarks\": [\n";
+
+		// One benchmark per line keeps the baseline reader trivial
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const BenchmarkResult& r = results[i];
+			char line[512];
+			std::snprintf(line, sizeof(line),
+			              "    { \"name\": \"%s\", \"median_ns\": %.1f, \"min_ns\": %.1f, \"p95_ns\": %.1f, \"iterations\": %llu, \"samples\": %d, \"items\": %.0f, \"item\": \"%s\", \"items_per_second\": %.1f }%s\n",
+			              escapeJson(r.name).c_str(), r.medianNs, r.minNs, r.p95Ns, static_cast<unsigned long long>(r.iterations), r.samples, r.items, r.itemName.c_str(), r.items / r.medianNs * 1e9, i + 1 < results.size() ? "," : "");
+			out << line;
+		}
+		out << "  ]\n";
+		out << "}\n";
+	}
+
+	// Median times by name from a file written by writeJson
+	bool readBaseline(const std::string& path, std::map<std::string, double>& medians)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			std::cerr << "Failed to open baseline " << path << std::endl;
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			const size_t name = line.find("\"name\": \"");
+			const size_t median = line.find("\"median_ns\": ");
+			if (name == std::string::npos || median == std::string::npos)
+				continue;
+
+			const size_t nameStart = name + std::strlen("\"name\": \"");
+			const size_t nameEnd = line.find('"', nameStart);
+			medians[line.substr(nameStart, nameEnd - nameStart)] = std::strtod(line.c_str() + median + std::strlen("\"median_ns\": "), nullptr);
+		}
+		return true;
+	}
+
+	// Print the change of every benchmark against the baseline; returns the number of regressions
+	int compareBaseline(const std::vector<BenchmarkResult>& results, const std::map<std::string, double>& baseline, double threshold)
+	{
+		int regressions = 0;
+		std::fprintf(stderr, "\n%-40s %12s %12s %9s\n", "benchmark", "baseline us", "current us", "change");
+		for (const BenchmarkResult& result : results)
+		{
+			const auto it = baseline.find(result.name);
+			if (it == baseline.end() || it->second <= 0.0)
+			{
+				std::fprintf(stderr, "%-40s %12s %12.3f %9s\n", result.name.c_str(), "-", result.medianNs / 1000.0, "new");
+				continue;
+			}
+
+			const double change = result.medianNs / it->second - 1.0;
+			const bool regressed = change > threshold;
+			regressions += regressed ? 1 : 0;
+			std::fprintf(stderr, "%-40s %12.3f %12.3f %+8.1f%%%s\n", result.name.c_str(), it->second / 1000.0, result.medianNs / 1000.0, change * 100.0, regressed ? "  REGRESSION" : "");
+		}
+		return regressions;
+	}
+
+	// UV sphere with positions and normals, the same layout the renderer's meshes use
+	Mesh generateSphere(int segments)
+	{
+		Mesh mesh;
+		mesh.name = "sphere" + std::to_string(segments);
+
+		const int rings = segments / 2;
+		for (int ring = 0; ring <= rings; ++ring)
+		{
+			const float theta = ring * 3.14159265f / rings;
+			for (int segment = 0; segment <= segments; ++segment)
+			{
+				const float phi = segment * 2.0f * 3.14159265f / segments;
+				const float normal[3] = { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+				mesh.vertices.insert(mesh.vertices.end(), { normal[0], normal[1], normal[2], normal[0], normal[1], normal[2] });
+			}
+		}
+
+		for (int ring = 0; ring < rings; ++ring)
+		{
+			for (int segment = 0; segment < segments; ++segment)
+			{
+				const uint32_t a = ring * (segments + 1) + segment;
+				const uint32_t b = a + segments + 1;
+				mesh.indices.insert(mesh.indices.end(), { a, b, a + 1, b, b + 1, a + 1 });
+			}
+		}
+		return mesh;
+	}
+
+	// Positions and triangulated faces of a Wavefront OBJ; normals are taken from the positions' direction
+	// from the origin, which is enough to give the vertex codec realistic attribute data
+	bool loadObj(const std::string& path, Mesh& mesh)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			std::cerr << "Failed to open mesh " << path << std::endl;
+			return false;
+		}
+
+		mesh.name = std::filesystem::path(path).stem().string();
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream iss(line);
+			std::string type;
+			iss >> type;
+			if (type == "v")
+			{
+				float p[3] = {};
+				iss >> p[0] >> p[1] >> p[2];
+				const float length = std::max(std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]), 1e-6f);
+				mesh.vertices.insert(mesh.vertices.end(), { p[0], p[1], p[2], p[0] / length, p[1] / length, p[2] / length });
+			}
+			else if (type == "f")
+			{
+				// Faces are fans; only the position index of v/vt/vn is used, negative indices count from the end
+				std::vector<uint32_t> face;
+				std::string vertex;
+				while (iss >> vertex)
+				{
+					const long index = std::strtol(vertex.c_str(), nullptr, 10);
+					face.push_back(static_cast<uint32_t>(index < 0 ? long(mesh.vertexCount()) + index : index - 1));
+				}
+				for (size_t i = 2; i < face.size(); ++i)
+				{
+					mesh.indices.insert(mesh.indices.end(), { face[0], face[i - 1], face[i] });
+				}
+			}
+		}
+
+		for (uint32_t index : mesh.indices)
+		{
+			if (index >= mesh.vertexCount())
+			{
+				std::cerr << "Mesh " << path << " references a missing vertex" << std::endl;
+				return false;
+			}
+		}
+		return !mesh.indices.empty();
+	}
+
+	// Sample clut on a size cubed grid, as a .cube of that resolution would store it
+	CLUT resampleClut(const CLUT& clut, int size)
+	{
+		std::vector<float> data(size_t(size) * size * size * 3);
+		for (int b = 0; b < size; ++b)
+		{
+			for (int g = 0; g < size; ++g)
+			{
+				for (int r = 0; r < size; ++r)
+				{
+					const float color[3] = { r / float(size - 1), g / float(size - 1), b / float(size - 1) };
+					clut.sample(color, &data[((size_t(b) * size + g) * size + r) * 3]);
+				}
+			}
+		}
+		return CLUT(clut.getName(), data, size, true);
+	}
+
+	// Smooth gradient with some noise, so neighbouring pixels land in nearby but different LUT cells
+	std::vector<float> generateImage(int size)
+	{
+		std::vector<float> image(size_t(size) * size * 3);
+		uint32_t state = 1;
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				state = state * 1664525u + 1013904223u;
+				const float noise = (state >> 8) / float(1 << 24) * 0.05f;
+				float* pixel = &image[(size_t(y) * size + x) * 3];
+				pixel[0] = std::min(1.0f, x / float(size) + noise);
+				pixel[1] = std::min(1.0f, y / float(size) + noise);
+				pixel[2] = std::min(1.0f, 0.5f * (x + y) / float(size) + noise);
+			}
+		}
+		return image;
+	}
+
+	uint64_t applyClut(const CLUT& clut, const std::vector<float>& image, std::vector<float>& graded)
+	{
+		for (size_t i = 0; i < image.size(); i += 3)
+		{
+			clut.sample(&image[i], &graded[i]);
+		}
+		return static_cast<uint64_t>(graded[graded.size() / 2] * 1000.0f);
+	}
+
+	void runClutBenchmarks(BenchmarkRunner& runner, const Options& options)
+	{
+		std::map<std::string, CLUT> library;
+		CLUT::createPreset1DCLUTs(library);
+		CLUT::createPreset3DCLUTs(library);
+
+		runner.run("clut/presets_1d", 1, "luts", []
+		{
+			std::map<std::string, CLUT> presets;
+			CLUT::createPreset1DCLUTs(presets);
+			return presets.size();
+		});
+		runner.run("clut/presets_3d", 1, "luts", []
+		{
+			std::map<std::string, CLUT> presets;
+			CLUT::createPreset3DCLUTs(presets);
+			return presets.size();
+		});
+
+		const CLUT& source3D = library.at("Cinematic (3D)");
+		const CLUT& source1D = library.at("Film (1D)");
+		const double gridCells = double(kResampleSize) * kResampleSize * kResampleSize;
+		runner.run("clut/resample_3d_" + std::to_string(kResampleSize), gridCells, "cells", [&]
+		{
+			return static_cast<uint64_t>(resampleClut(source3D, kResampleSize).getData().size());
+		});
+
+		const std::vector<float> image = generateImage(kImageSize);
+		std::vector<float> graded(image.size());
+		const double pixels = double(kImageSize) * kImageSize;
+		runner.run("clut/apply_1d_" + std::to_string(kImageSize), pixels, "pixels", [&] { return applyClut(source1D, image, graded); });
+		runner.run("clut/apply_3d_" + std::to_string(kImageSize), pixels, "pixels", [&] { return applyClut(source3D, image, graded); });
+
+		// File IO on a full size generated LUT, then on every LUT given on the command line
+		const std::filesystem::path cubePath = std::filesystem::temp_directory_path() / "renderalchemy_bench.cube";
+		const CLUT cube = resampleClut(source3D, kResampleSize);
+		runner.run("clut/save_3d_" + std::to_string(kResampleSize), gridCells, "cells", [&]
+		{
+			cube.saveToFile(cubePath.string());
+			return uint64_t(1);
+		});
+		cube.saveToFile(cubePath.string());
+		runner.run("clut/load_3d_" + std::to_string(kResampleSize), gridCells, "cells", [&]
+		{
+			return static_cast<uint64_t>(CLUT::loadFromFile(cubePath.string()).getSize());
+		});
+		std::error_code error;
+		std::filesystem::remove(cubePath, error);
+
+		for (const std::string& path : options.clutPaths)
+		{
+			try
+			{
+				const CLUT clut = CLUT::loadFromFile(path);
+				const double entries = clut.is3DCLUT() ? double(clut.getSize()) * clut.getSize() * clut.getSize() : clut.getSize();
+				const std::string name = std::filesystem::path(path).stem().string();
+				runner.run("clut/load_" + name, entries, "cells", [&] { return static_cast<uint64_t>(CLUT::loadFromFile(path).getSize()); });
+				runner.run("clut/apply_" + name + "_" + std::to_string(kImageSize), pixels, "pixels", [&] { return applyClut(clut, image, graded); });
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Skipping " << path << ": " << e.what() << std::endl;
+			}
+		}
+	}
+
+	void runMeshBenchmarks(BenchmarkRunner& runner, const Mesh& mesh)
+	{
+		const std::string prefix = "mesh/" + mesh.name + "/";
+		const size_t vertexCount = mesh.vertexCount();
+		const size_t vertexSize = 6 * sizeof(float);
+		const double triangles = double(mesh.indices.size() / 3);
+
+		std::vector<uint32_t> optimized(mesh.indices.size());
+		runner.run(prefix + "optimize_vertex_cache", triangles, "tris", [&]
+		{
+			meshopt_optimizeVertexCache(optimized.data(), mesh.indices.data(), mesh.indices.size(), vertexCount);
+			return uint64_t(optimized[0]);
+		});
+
+		// The codecs expect vertices in the order the optimized index buffer first uses them
+		std::vector<float> vertices(mesh.vertices.size());
+		std::vector<uint32_t> remap(vertexCount);
+		meshopt_optimizeVertexCache(optimized.data(), mesh.indices.data(), mesh.indices.size(), vertexCount);
+		const size_t fetched = meshopt_optimizeVertexFetchRemap(remap.data(), optimized.data(), optimized.size(), vertexCount);
+		meshopt_remapIndexBuffer(optimized.data(), optimized.data(), optimized.size(), remap.data());
+		meshopt_remapVertexBuffer(vertices.data(), mesh.vertices.data(), vertexCount, vertexSize, remap.data());
+
+		std::vector<unsigned char> vertexBuffer(meshopt_encodeVertexBufferBound(fetched, vertexSize));
+		size_t vertexBytes = 0;
+		runner.run(prefix + "encode_vertices", double(fetched), "verts", [&]
+		{
+			vertexBytes = meshopt_encodeVertexBuffer(vertexBuffer.data(), vertexBuffer.size(), vertices.data(), fetched, vertexSize);
+			return uint64_t(vertexBytes);
+		});
+		std::vector<float> decodedVertices(fetched * 6);
+		runner.run(prefix + "decode_vertices", double(fetched), "verts", [&]
+		{
+			return uint64_t(meshopt_decodeVertexBuffer(decodedVertices.data(), fetched, vertexSize, vertexBuffer.data(), vertexBytes) == 0);
+		});
+
+		std::vector<unsigned char> indexBuffer(meshopt_encodeIndexBufferBound(optimized.size(), fetched));
+		size_t indexBytes = 0;
+		runner.run(prefix + "encode_indices", triangles, "tris", [&]
+		{
+			indexBytes = meshopt_encodeIndexBuffer(indexBuffer.data(), indexBuffer.size(), optimized.data(), optimized.size());
+			return uint64_t(indexBytes);
+		});
+		std::vector<uint32_t> decodedIndices(optimized.size());
+		runner.run(prefix + "decode_indices", triangles, "tris", [&]
+		{
+			return uint64_t(meshopt_decodeIndexBuffer(decodedIndices.data(), decodedIndices.size(), indexBuffer.data(), indexBytes) == 0);
+		});
+
+		// Same target as the first step of MeshLod::buildChain
+		std::vector<uint32_t> simplified(mesh.indices.size());
+		runner.run(prefix + "simplify_half", triangles, "tris", [&]
+		{
+			return uint64_t(meshopt_simplify(simplified.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(), vertexCount, vertexSize, mesh.indices.size() / 2, 1e-2f));
+		});
+
+		const size_t maxVertices = 64;
+		const size_t maxTriangles = 124;
+		const size_t maxMeshlets = meshopt_buildMeshletsBound(mesh.indices.size(), maxVertices, maxTriangles);
+		std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+		std::vector<unsigned int> meshletVertices(maxMeshlets * maxVertices);
+		std::vector<unsigned char> meshletTriangles(maxMeshlets * maxTriangles * 3);
+		runner.run(prefix + "build_meshlets", triangles, "tris", [&]
+		{
+			return uint64_t(meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(), optimized.data(), optimized.size(), vertices.data(), fetched, vertexSize, maxVertices, maxTriangles, 0.25f));
+		});
+	}
+
+	void printUsage(std::ostream& stream)
+	{
+		stream << "Usage: RenderAlchemyBench [options]\n"
+		          "  --out <file>         Write results as JSON to file (default benchmark.json)\n"
+		          "  --baseline <file>    Compare against an earlier run, exit with 1 on a regression\n"
+		          "  --threshold <ratio>  Median slowdown reported as a regression (default 0.10)\n"
+		          "  --samples <count>    Samples per benchmark (default 15)\n"
+		          "  --filter <name>      Only run benchmarks whose name contains name\n"
+		          "  --clut <file.cube>   Add a CLUT file to the generated ones, may be repeated\n"
+		          "  --mesh <file.obj>    Add a mesh to the generated sphere, may be repeated\n"
+		          "  --help               Show this message" << std::endl;
+	}
+
+	bool parseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+			if (arg == "--help" || arg == "-h")
+			{
+				options.help = true;
+				return true;
+			}
+			else if (arg == "--out" && hasValue)
+				options.outPath = argv[++i];
+			else if (arg == "--baseline" && hasValue)
+				options.baselinePath = argv[++i];
+			else if (arg == "--threshold" && hasValue)
+				options.threshold = std::strtod(argv[++i], nullptr);
+			else if (arg == "--samples" && hasValue)
+				options.samples = std::max(1, std::atoi(argv[++i]));
+			else if (arg == "--filter" && hasValue)
+				options.filter = argv[++i];
+			else if (arg == "--clut" && hasValue)
+				options.clutPaths.push_back(argv[++i]);
+			else if (arg == "--mesh" && hasValue)
+				options.meshPaths.push_back(argv[++i]);
+			else
+			{
+				std::cerr << "Unknown argument or missing value: " << arg << std::endl;
+				printUsage(std::cerr);
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+		return 2;
+
+	if (options.help)
+	{
+		printUsage(std::cout);
+		return 0;
+	}
+
+	// Preset generation runs its slices as jobs, like it does in the application
+	JobSystem::init();
+
+	BenchmarkRunner runner(options);
+	runClutBenchmarks(runner, options);
+
+	runMeshBenchmarks(runner, generateSphere(kSphereSegments));
+	for (const std::string& path : options.meshPaths)
+	{
+		Mesh mesh;
+		if (loadObj(path, mesh))
+			runMeshBenchmarks(runner, mesh);
+	}
+
+	JobSystem::shutdown();
+
+	// The job system logs to stdout, so results always go to a file
+	std::ofstream out(options.outPath);
+	if (!out)
+	{
+		std::cerr << "Failed to write " << options.outPath << std::endl;
+		return 2;
+	}
+	writeJson(out, runner.getResults());
+	std::cerr << "Results written to " << options.outPath << std::endl;
+
+	if (!options.baselinePath.empty())
+	{
+		std::map<std::string, double> baseline;
+		if (!readBaseline(options.baselinePath, baseline))
+			return 2;
+
+		const int regressions = compareBaseline(runner.getResults(), baseline, options.threshold);
+		if (regressions > 0)
+		{
+			std::fprintf(stderr, "%d benchmarks regressed by more than %.0f%%\n", regressions, options.threshold * 100.0);
+			return 1;
+		}
+	}
+	return 0;
+}
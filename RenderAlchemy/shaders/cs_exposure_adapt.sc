@@ -0,0 +1,66 @@
+#include <bgfx_compute.sh>
+
+BUFFER_RW(exposureBins, uint, 0);
+IMAGE2D_RW(s_exposure, r32f, 1);
+
+uniform vec4 u_exposureRange;  // x = min log2 luminance, y = log2 luminance range, z = low percentile, w = high percentile
+uniform vec4 u_exposureAdapt;  // x = delta time in seconds, negative to jump, y = speed up, z = speed down
+uniform vec4 u_exposureLimits; // x = min exposure, y = max exposure
+
+SHARED uint counts[256];
+
+NUM_THREADS(256, 1, 1)
+void main()
+{
+    uint bin = gl_LocalInvocationIndex;
+    counts[bin] = exposureBins[bin];
+    exposureBins[bin] = 0u;
+    barrier();
+
+    if (bin != 0u)
+    {
+        return;
+    }
+
+    // Average log luminance of the samples between the two percentiles, black pixels excluded
+    uint total = 0u;
+    for (uint i = 1u; i < 256u; ++i)
+    {
+        total += counts[i];
+    }
+
+    float low = float(total) * u_exposureRange.z;
+    float high = float(total) * u_exposureRange.w;
+    float below = 0.0;
+    float weightSum = 0.0;
+    float levelSum = 0.0;
+    for (uint i = 1u; i < 256u; ++i)
+    {
+        float count = float(counts[i]);
+        float inside = max(min(below + count, high) - max(below, low), 0.0);
+        weightSum += inside;
+        levelSum += inside * (float(i) - 0.5) / 254.0;
+        below += count;
+    }
+
+    float previous = imageLoad(s_exposure, ivec2(0, 0) ).x;
+    if (weightSum <= 0.0)
+    {
+        imageStore(s_exposure, ivec2(0, 0), vec4(previous, 0.0, 0.0, 0.0) );
+        return;
+    }
+
+    // Exposure that maps the average to middle grey
+    float averageLog = levelSum / weightSum * u_exposureRange.y + u_exposureRange.x;
+    float target = clamp(0.18 / exp2(averageLog), u_exposureLimits.x, u_exposureLimits.y);
+
+    // Ease towards it in log space, frame rate independent
+    float adapted = target;
+    if (u_exposureAdapt.x >= 0.0 && previous > 0.0)
+    {
+        float speed = target > previous ? u_exposureAdapt.y : u_exposureAdapt.z;
+        float blend = 1.0 - exp(-u_exposureAdapt.x * speed);
+        adapted = exp2(mix(log2(previous), log2(target), blend) );
+    }
+    imageStore(s_exposure, ivec2(0, 0), vec4(adapted, 0.0, 0.0, 0.0) );
+}
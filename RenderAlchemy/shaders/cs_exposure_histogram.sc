@@ -0,0 +1,42 @@
+#include <bgfx_compute.sh>
+
+SAMPLER2D(s_hdrBuffer, 0);
+BUFFER_RW(exposureBins, uint, 1);
+
+uniform vec4 u_exposureSamples; // xy = sample grid size, zw = HDR image size
+uniform vec4 u_exposureRange;   // x = min log2 luminance, y = log2 luminance range, zw = percentiles
+
+// Per group histogram, flushed with one atomic per touched bin instead of one per sample
+SHARED uint groupHistogram[256];
+
+NUM_THREADS(16, 16, 1)
+void main()
+{
+    uint local = gl_LocalInvocationIndex;
+    groupHistogram[local] = 0u;
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (all(lessThan(coord, ivec2(u_exposureSamples.xy) ) ) )
+    {
+        vec2 uv = (vec2(coord) + 0.5) / u_exposureSamples.xy;
+        vec3 color = texelFetch(s_hdrBuffer, ivec2(uv * u_exposureSamples.zw), 0).rgb;
+        float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722) );
+
+        // Bin 0 takes black pixels, the rest span the log range
+        uint bin = 0u;
+        if (luminance > 1.0e-5)
+        {
+            float level = clamp( (log2(luminance) - u_exposureRange.x) / u_exposureRange.y, 0.0, 1.0);
+            bin = uint(level * 254.0 + 1.0);
+        }
+        atomicAdd(groupHistogram[bin], 1u);
+    }
+    barrier();
+
+    uint count = groupHistogram[local];
+    if (count != 0u)
+    {
+        atomicAdd(exposureBins[local], count);
+    }
+}
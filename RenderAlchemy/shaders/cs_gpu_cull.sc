@@ -0,0 +1,105 @@
+#include <bgfx_compute.sh>
+
+// Per instance: 4 transform columns, tint, world space bounding sphere, x = batch index
+BUFFER_RO(instanceInput, vec4, 0);
+// Per visible instance: 4 transform columns and tint, grouped per batch
+BUFFER_WR(instanceOutput, vec4, 1);
+// Visible instance count per batch
+BUFFER_RW(drawCounts, uint, 2);
+// Hierarchical depth built from the previous frame
+SAMPLER2D(s_hiz, 3);
+
+uniform vec4 u_cullParams;  // x = instance count, y = batch count, z = hi-z test enabled, w = hi-z mip count
+uniform vec4 u_hizParams;   // x = hi-z width, y = hi-z height, z = homogeneous depth, w = origin bottom left
+uniform vec4 u_planes[6];   // Frustum planes in world space
+uniform vec4 u_batches[16]; // x = index count, y = first index, z = first instance, w = unused
+uniform mat4 u_prevViewProj;
+
+bool isOccluded(vec3 center, float radius)
+{
+    // Project the corners of the sphere's bounding box with last frame's camera
+    vec2 rectMin = vec2(1.0, 1.0);
+    vec2 rectMax = vec2(-1.0, -1.0);
+    float nearestDepth = 1.0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = center + radius * vec3(
+              (i & 1) != 0 ? 1.0 : -1.0
+            , (i & 2) != 0 ? 1.0 : -1.0
+            , (i & 4) != 0 ? 1.0 : -1.0
+            );
+
+        vec4 clip = mul(u_prevViewProj, vec4(corner, 1.0));
+
+        // Crossing the near plane, no reliable screen rectangle
+        if (clip.w <= 0.0)
+        {
+            return false;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        rectMin = min(rectMin, ndc.xy);
+        rectMax = max(rectMax, ndc.xy);
+
+        float depth = u_hizParams.z > 0.5 ? ndc.z * 0.5 + 0.5 : ndc.z;
+        nearestDepth = min(nearestDepth, depth);
+    }
+
+    vec2 uvMin = clamp(rectMin * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(rectMax * 0.5 + 0.5, 0.0, 1.0);
+
+    if (u_hizParams.w < 0.5)
+    {
+        uvMin.y = 1.0 - uvMin.y;
+        uvMax.y = 1.0 - uvMax.y;
+    }
+
+    // Pick the mip where the rectangle covers at most 2x2 texels
+    vec2 size = abs(uvMax - uvMin) * u_hizParams.xy;
+    float mip = clamp(ceil(log2(max(max(size.x, size.y), 1.0) ) ), 0.0, u_cullParams.w - 1.0);
+
+    float farthestDepth = texture2DLod(s_hiz, vec2(uvMin.x, uvMin.y), mip).x;
+    farthestDepth = max(farthestDepth, texture2DLod(s_hiz, vec2(uvMax.x, uvMin.y), mip).x);
+    farthestDepth = max(farthestDepth, texture2DLod(s_hiz, vec2(uvMin.x, uvMax.y), mip).x);
+    farthestDepth = max(farthestDepth, texture2DLod(s_hiz, vec2(uvMax.x, uvMax.y), mip).x);
+
+    return nearestDepth > farthestDepth;
+}
+
+NUM_THREADS(64, 1, 1)
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= uint(u_cullParams.x) )
+    {
+        return;
+    }
+
+    uint src = id * 7u;
+    vec4 sphere = instanceInput[src + 5u];
+    uint batch = uint(instanceInput[src + 6u].x);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        if (dot(u_planes[i].xyz, sphere.xyz) + u_planes[i].w <= -sphere.w)
+        {
+            return;
+        }
+    }
+
+    if (u_cullParams.z > 0.5 && isOccluded(sphere.xyz, sphere.w) )
+    {
+        return;
+    }
+
+    uint slot;
+    atomicFetchAndAdd(drawCounts[batch], 1u, slot);
+
+    uint dst = (uint(u_batches[batch].z) + slot) * 5u;
+    instanceOutput[dst + 0u] = instanceInput[src + 0u];
+    instanceOutput[dst + 1u] = instanceInput[src + 1u];
+    instanceOutput[dst + 2u] = instanceInput[src + 2u];
+    instanceOutput[dst + 3u] = instanceInput[src + 3u];
+    instanceOutput[dst + 4u] = instanceInput[src + 4u];
+}
@@ -0,0 +1,31 @@
+#include <bgfx_compute.sh>
+
+BUFFER_RW(drawCounts, uint, 0);
+BUFFER_WR(indirectBuffer, uvec4, 1);
+
+uniform vec4 u_cullParams;  // x = instance count, y = batch count
+uniform vec4 u_batches[16]; // x = index count, y = first index, z = first instance, w = unused
+
+NUM_THREADS(16, 1, 1)
+void main()
+{
+    uint batch = gl_GlobalInvocationID.x;
+    if (batch >= uint(u_cullParams.y) )
+    {
+        return;
+    }
+
+    // One indexed draw per batch covering its visible instances
+    drawIndexedIndirect(
+          indirectBuffer
+        , batch
+        , uint(u_batches[batch].x)
+        , drawCounts[batch]
+        , uint(u_batches[batch].y)
+        , 0u
+        , uint(u_batches[batch].z)
+        );
+
+    // Ready for next frame's cull pass
+    drawCounts[batch] = 0u;
+}
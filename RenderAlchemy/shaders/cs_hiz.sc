@@ -0,0 +1,43 @@
+#include <bgfx_compute.sh>
+
+// Scene depth, only read for the first level; the first level binds a placeholder as s_hizIn so no level
+// is bound for reading and writing at once
+SAMPLER2D(s_depth, 0);
+IMAGE2D_RO(s_hizIn, r32f, 1);
+IMAGE2D_WR(s_hizOut, r32f, 2);
+
+uniform vec4 u_hizSize; // xy = output size, z = 1 when reading the depth buffer, w = unused
+
+NUM_THREADS(8, 8, 1)
+void main()
+{
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(coord, ivec2(u_hizSize.xy) ) ) )
+    {
+        return;
+    }
+
+    // Keep the farthest depth of each 2x2 footprint so the test stays conservative. A source with an odd size
+    // has a last row or column no footprint starts on; the edge texels take it in as a third tap.
+    ivec2 source = coord * 2;
+    ivec2 sourceSize = u_hizSize.z > 0.5 ? textureSize(s_depth, 0) : imageSize(s_hizIn);
+    ivec2 last = sourceSize - ivec2(1, 1);
+    int tapsX = coord.x == int(u_hizSize.x) - 1 ? max(sourceSize.x - source.x, 2) : 2;
+    int tapsY = coord.y == int(u_hizSize.y) - 1 ? max(sourceSize.y - source.y, 2) : 2;
+
+    float farthest = 0.0;
+    for (int y = 0; y < 3; ++y)
+    {
+        for (int x = 0; x < 3; ++x)
+        {
+            if (x < tapsX && y < tapsY)
+            {
+                ivec2 tap = min(source + ivec2(x, y), last);
+                float depth = u_hizSize.z > 0.5 ? texelFetch(s_depth, tap, 0).x : imageLoad(s_hizIn, tap).x;
+                farthest = max(farthest, depth);
+            }
+        }
+    }
+
+    imageStore(s_hizOut, coord, vec4(farthest, 0.0, 0.0, 0.0) );
+}
@@ -0,0 +1,70 @@
+#include <bgfx_compute.sh>
+
+// Image being measured, the HDR scene or the graded output
+SAMPLER2D(s_scopeSource, 0);
+// Histogram (R, G, B, luma, 256 bins each), then the waveform and vectorscope grids, 256x256 each
+BUFFER_RW(scopeBins, uint, 1);
+
+uniform vec4 u_scopeParams; // xy = sample grid size, z = 1 for an HDR source, w = exposure
+uniform vec4 u_scopeSource; // xy = source size in pixels
+
+#define WAVEFORM_OFFSET 1024u
+#define VECTORSCOPE_OFFSET 66560u
+
+// Per group histogram, flushed with one atomic per touched bin instead of one per sample
+SHARED uint groupHistogram[1024];
+
+// HDR values are log encoded from 8 stops below to 4 stops above middle grey, like a camera log curve
+vec3 encode(vec3 color)
+{
+    if (u_scopeParams.z > 0.5)
+    {
+        color = (log2(max(color * u_scopeParams.w, vec3_splat(1.0e-6) ) / 0.18) + 8.0) / 12.0;
+    }
+    return clamp(color, 0.0, 1.0);
+}
+
+NUM_THREADS(16, 16, 1)
+void main()
+{
+    uint local = gl_LocalInvocationIndex;
+    for (uint i = local; i < 1024u; i += 256u)
+    {
+        groupHistogram[i] = 0u;
+    }
+    barrier();
+
+    // Every thread measures one point of a reduced grid spread over the whole image
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (all(lessThan(coord, ivec2(u_scopeParams.xy) ) ) )
+    {
+        vec2 uv = (vec2(coord) + 0.5) / u_scopeParams.xy;
+        vec3 color = encode(texelFetch(s_scopeSource, ivec2(uv * u_scopeSource.xy), 0).rgb);
+        float luma = dot(color, vec3(0.2126, 0.7152, 0.0722) );
+
+        uvec4 level = uvec4(vec4(color, luma) * 255.0 + 0.5);
+        atomicAdd(groupHistogram[level.x], 1u);
+        atomicAdd(groupHistogram[256u + level.y], 1u);
+        atomicAdd(groupHistogram[512u + level.z], 1u);
+        atomicAdd(groupHistogram[768u + level.w], 1u);
+
+        // Waveform: image column across, luma up
+        uint column = min(uint(uv.x * 256.0), 255u);
+        atomicAdd(scopeBins[WAVEFORM_OFFSET + (255u - level.w) * 256u + column], 1u);
+
+        // Vectorscope: BT.709 Cb across, Cr up, saturated primaries near the edge
+        vec2 chroma = vec2( (color.b - luma) / 1.8556, (luma - color.r) / 1.5748);
+        uvec2 cell = uvec2(clamp(chroma + 0.5, 0.0, 1.0) * 255.0 + 0.5);
+        atomicAdd(scopeBins[VECTORSCOPE_OFFSET + cell.y * 256u + cell.x], 1u);
+    }
+    barrier();
+
+    for (uint i = local; i < 1024u; i += 256u)
+    {
+        uint count = groupHistogram[i];
+        if (count != 0u)
+        {
+            atomicAdd(scopeBins[i], count);
+        }
+    }
+}
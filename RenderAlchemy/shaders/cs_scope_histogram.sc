@@ -0,0 +1,43 @@
+#include <bgfx_compute.sh>
+
+BUFFER_RW(scopeBins, uint, 0);
+IMAGE2D_WR(s_histogram, rgba8, 1);
+
+#define HISTOGRAM_HEIGHT 128
+
+SHARED uint peak[256];
+
+// One thread per bin, the tallest bin of any channel sets the scale
+NUM_THREADS(256, 1, 1)
+void main()
+{
+    uint bin = gl_LocalInvocationIndex;
+    uvec4 counts = uvec4(scopeBins[bin], scopeBins[256u + bin], scopeBins[512u + bin], scopeBins[768u + bin]);
+
+    peak[bin] = max(max(counts.x, counts.y), max(counts.z, counts.w) );
+    barrier();
+    for (uint stride = 128u; stride > 0u; stride >>= 1)
+    {
+        if (bin < stride)
+        {
+            peak[bin] = max(peak[bin], peak[bin + stride]);
+        }
+        barrier();
+    }
+
+    vec4 heights = vec4(counts) / float(max(peak[0], 1u) ) * float(HISTOGRAM_HEIGHT);
+    for (int row = 0; row < HISTOGRAM_HEIGHT; ++row)
+    {
+        // Channels add up where they overlap, luma shows as a grey outline behind them
+        float level = float(HISTOGRAM_HEIGHT - row) - 0.5;
+        vec3 filled = step(vec3_splat(level), heights.xyz);
+        float luma = step(level, heights.w) * 0.25;
+        vec3 color = max(filled * 0.8, vec3_splat(luma) );
+        imageStore(s_histogram, ivec2(int(bin), row), vec4(color, 1.0) );
+    }
+
+    scopeBins[bin] = 0u;
+    scopeBins[256u + bin] = 0u;
+    scopeBins[512u + bin] = 0u;
+    scopeBins[768u + bin] = 0u;
+}
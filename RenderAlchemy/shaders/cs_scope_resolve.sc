@@ -0,0 +1,27 @@
+#include <bgfx_compute.sh>
+
+BUFFER_RW(scopeBins, uint, 0);
+IMAGE2D_WR(s_waveform, rgba8, 1);
+IMAGE2D_WR(s_vectorscope, rgba8, 2);
+
+uniform vec4 u_scopeResolve; // x = density gain, yzw = unused
+
+#define WAVEFORM_OFFSET 1024u
+#define VECTORSCOPE_OFFSET 66560u
+
+NUM_THREADS(16, 16, 1)
+void main()
+{
+    uvec2 coord = gl_GlobalInvocationID.xy;
+    uint cell = coord.y * 256u + coord.x;
+
+    // Exponential falloff keeps sparse traces visible without saturating dense ones
+    float waveform = 1.0 - exp(-float(scopeBins[WAVEFORM_OFFSET + cell]) * u_scopeResolve.x);
+    float vectorscope = 1.0 - exp(-float(scopeBins[VECTORSCOPE_OFFSET + cell]) * u_scopeResolve.x);
+    imageStore(s_waveform, ivec2(coord), vec4(waveform * 0.5, waveform, waveform * 0.6, 1.0) );
+    imageStore(s_vectorscope, ivec2(coord), vec4(vectorscope, vectorscope, vectorscope, 1.0) );
+
+    // Ready for the next accumulation
+    scopeBins[WAVEFORM_OFFSET + cell] = 0u;
+    scopeBins[VECTORSCOPE_OFFSET + cell] = 0u;
+}
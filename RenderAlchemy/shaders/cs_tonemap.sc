@@ -0,0 +1,78 @@
+#include <bgfx_compute.sh>
+
+SAMPLER2D(s_hdrBuffer, 0);
+SAMPLER2D(s_colorLUT1D, 1);
+SAMPLER3D(s_colorLUT3D, 2);
+SAMPLER3D(s_compareLUT, 3);
+SAMPLER2D(s_autoExposure, 4);
+IMAGE2D_WR(s_ldrImage, rgba8, 5);
+SAMPLER3D(s_comparePage0, 6);
+SAMPLER3D(s_comparePage1, 7);
+SAMPLER3D(s_comparePage2, 8);
+SAMPLER3D(s_comparePage3, 9);
+
+uniform vec4 u_tonemapImage; // xy = output size, z = 1 to flip rows like the raster pass
+
+#define CLUT1D_CACHE_SIZE 256
+
+// Values every pixel of a tile reads: the exposure and, for 1D CLUTs up to the cache size, the whole CLUT.
+// 3D CLUTs stay on the texture unit, its trilinear filter is cheaper than doing it by hand.
+SHARED vec3 clut1DCache[CLUT1D_CACHE_SIZE];
+SHARED float clut1DWidth;
+SHARED float tileExposure;
+
+// Linear filtering between texel centres, matching the sampler of the raster path
+vec3 sampleClut1D(float luminance) {
+    if (clut1DWidth > float(CLUT1D_CACHE_SIZE)) {
+        return texture2DLod(s_colorLUT1D, vec2(luminance, 0.0), 0.0).rgb;
+    }
+
+    float position = luminance * clut1DWidth - 0.5;
+    float first = clamp(floor(position), 0.0, clut1DWidth - 1.0);
+    float second = min(first + 1.0, clut1DWidth - 1.0);
+    return mix(clut1DCache[int(first)], clut1DCache[int(second)], clamp(position - first, 0.0, 1.0));
+}
+
+#define CLUT1D_SAMPLE(_luminance) sampleClut1D(_luminance)
+#include "tonemap.sh"
+
+NUM_THREADS(8, 8, 1)
+void main()
+{
+    uint local = gl_LocalInvocationIndex;
+    if (local == 0u)
+    {
+        clut1DWidth = float(textureSize(s_colorLUT1D, 0).x);
+
+        // Manual exposure, or compensation on top of the adapted exposure the auto exposure pass left in a 1x1 texture
+        tileExposure = u_params.x;
+        if (u_flags.y > 0.5)
+        {
+            tileExposure *= texelFetch(s_autoExposure, ivec2(0, 0), 0).x;
+        }
+    }
+    barrier();
+
+    // Uniform across the dispatch, so every thread of the group reaches the barrier below
+    if (u_flags.z > 0.5 && u_flags.w < 0.5 && clut1DWidth <= float(CLUT1D_CACHE_SIZE))
+    {
+        for (int i = int(local); i < int(clut1DWidth); i += 64)
+        {
+            clut1DCache[i] = texelFetch(s_colorLUT1D, ivec2(i, 0), 0).rgb;
+        }
+    }
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (all(lessThan(coord, ivec2(u_tonemapImage.xy) ) ) )
+    {
+        // The raster pass draws a quad with v = 1 at the top of clip space, which stores the image upside down
+        // on backends with a top-left origin; match it so present reads either path the same way
+        vec2 uv = (vec2(coord) + 0.5) / u_tonemapImage.xy;
+        if (u_tonemapImage.z > 0.5)
+        {
+            uv.y = 1.0 - uv.y;
+        }
+        imageStore(s_ldrImage, coord, vec4(tonemapPixel(uv, tileExposure), 1.0) );
+    }
+}
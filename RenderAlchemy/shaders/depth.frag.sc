@@ -0,0 +1,6 @@
+#include <bgfx_shader.sh>
+
+void main() {
+    // Depth only, colour writes are masked off by the render state
+    gl_FragColor = vec4_splat(0.0);
+}
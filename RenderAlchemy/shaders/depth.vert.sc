@@ -0,0 +1,8 @@
+$input a_position
+
+#include <bgfx_shader.sh>
+
+void main() {
+    // Same expression as scene.vert so the colour pass can test depth for equality
+    gl_Position = mul(u_modelViewProj, vec4(a_position, 1.0));
+}
@@ -0,0 +1,11 @@
+$input a_position, i_data0, i_data1, i_data2, i_data3
+
+#include <bgfx_shader.sh>
+
+void main() {
+    // Same transform order as scene_instanced.vert so the colour pass can test depth for equality
+    mat4 model = mtxFromCols(i_data0, i_data1, i_data2, i_data3);
+    vec4 worldPos = mul(model, vec4(a_position, 1.0));
+
+    gl_Position = mul(u_viewProj, worldPos);
+}
@@ -0,0 +1,10 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+
+// Tone mapped image, cached between frames when nothing changed
+SAMPLER2D(s_ldrBuffer, 0);
+
+void main() {
+    gl_FragColor = texture2D(s_ldrBuffer, v_texcoord0);
+}
@@ -1,4 +1,4 @@
-$input v_color, v_fragPos, v_normal
+$input v_color, v_fragPos, v_normal, v_tint
 
 #include <bgfx_shader.sh>
 
@@ -6,6 +6,43 @@ uniform vec4 u_lightPos;
 uniform vec4 u_lightColor;
 uniform vec4 u_params; // x = lightIntensity, y = ambientStrength, z = sceneType
 
+// Clustered lights, see ClusteredLights.h
+SAMPLER2D(s_lights, 0);       // Column per light: row 0 = position and radius, row 1 = colour * intensity
+SAMPLER2D(s_lightGrid, 1);    // Texel per cluster: x = offset into s_lightIndices, y = light count
+SAMPLER2D(s_lightIndices, 2); // Flat list of light indices
+uniform vec4 u_clusterParams; // xyz = cluster counts, w = light count
+uniform vec4 u_clusterDepth;  // x = near plane, y = depth slices per log unit, z = index texture width
+
+vec3 clusteredLighting(vec3 norm)
+{
+    // Cluster of this fragment: screen tile from its projected position, exponential slice from view depth
+    vec4 clip = mul(u_viewProj, vec4(v_fragPos, 1.0));
+    vec2 ndc = clip.xy / clip.w;
+    vec2 tile = clamp(floor((ndc * 0.5 + 0.5) * u_clusterParams.xy), vec2_splat(0.0), u_clusterParams.xy - 1.0);
+    float slice = clamp(floor(log(max(clip.w, u_clusterDepth.x) / u_clusterDepth.x) * u_clusterDepth.y), 0.0, u_clusterParams.z - 1.0);
+
+    vec2 grid = texelFetch(s_lightGrid, ivec2(int(tile.y * u_clusterParams.x + tile.x), int(slice)), 0).xy;
+    int offset = int(grid.x);
+    int count = int(grid.y);
+    int width = int(u_clusterDepth.z);
+
+    vec3 result = vec3_splat(0.0);
+    for (int i = 0; i < count; ++i) {
+        int entry = offset + i;
+        int light = int(texelFetch(s_lightIndices, ivec2(entry - (entry / width) * width, entry / width), 0).x);
+
+        vec4 positionRadius = texelFetch(s_lights, ivec2(light, 0), 0);
+        vec3 toLight = positionRadius.xyz - v_fragPos;
+        float dist = length(toLight);
+
+        // Smooth falloff reaching zero at the light radius
+        float range = clamp(1.0 - (dist * dist) / (positionRadius.w * positionRadius.w), 0.0, 1.0);
+        float diff = max(dot(norm, toLight / max(dist, 0.0001)), 0.0);
+        result += texelFetch(s_lights, ivec2(light, 1), 0).rgb * (diff * range * range);
+    }
+    return result;
+}
+
 void main() {
     // Ambient lighting
     vec3 ambient = u_params.y * u_lightColor.rgb;
@@ -15,6 +52,9 @@ void main() {
     vec3 lightDir = normalize(u_lightPos.xyz - v_fragPos);
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * u_lightColor.rgb * u_params.x;
+
+    // Every light whose range reaches this fragment's cluster
+    diffuse += clusteredLighting(norm);
     
     // Varying color based on scene type
     vec3 baseColor;
@@ -38,6 +78,9 @@ void main() {
         }
     }
     
+    // Per-instance tint, white for regular draws
+    baseColor *= v_tint.rgb;
+
     // Apply lighting to base color
     vec3 result = (ambient + diffuse) * baseColor;
     
@@ -0,0 +1,18 @@
+$input a_position, a_normal, a_color, i_data0, i_data1, i_data2, i_data3, i_data4
+$output v_color, v_fragPos, v_normal, v_tint
+
+#include <bgfx_shader.sh>
+
+void main() {
+    // Per-instance model matrix, one column per instance attribute
+    mat4 model = mtxFromCols(i_data0, i_data1, i_data2, i_data3);
+
+    vec4 worldPos = mul(model, vec4(a_position, 1.0));
+
+    v_color = a_color;
+    v_fragPos = worldPos.xyz;
+    v_normal = mul(model, vec4(a_normal, 0.0)).xyz;
+    v_tint = i_data4;
+
+    gl_Position = mul(u_viewProj, worldPos);
+}
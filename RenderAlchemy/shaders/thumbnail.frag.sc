@@ -0,0 +1,50 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+
+// Uniforms
+uniform vec4 u_thumbnailParams; // x: thumbnail size, y: columns, z: thumbnail count, w: CLUT grid size
+uniform vec4 u_lutAtlasParams;  // xy: CLUT atlas size in texels
+
+SAMPLER2D(s_lutAtlas, 0);
+
+// Reference image: a hue sweep from dark to bright over a neutral grey ramp
+vec3 referenceImage(vec2 uv) {
+    if (uv.y > 0.8) {
+        return vec3_splat(uv.x);
+    }
+
+    vec3 hue = clamp(abs(fract(uv.x + vec3(0.0, 2.0 / 3.0, 1.0 / 3.0)) * 6.0 - 3.0) - 1.0, 0.0, 1.0);
+    float value = 1.0 - uv.y / 0.8;
+    return mix(vec3_splat(value), hue * value, 0.75);
+}
+
+// Blue slices lie side by side in a tile: filter red and green in hardware, blend the two slices here
+vec3 sampleClut(vec3 color, vec2 tileOrigin) {
+    float size = u_thumbnailParams.w;
+    color = clamp(color, 0.0, 1.0) * (size - 1.0);
+
+    float slice0 = floor(color.b);
+    float slice1 = min(slice0 + 1.0, size - 1.0);
+    vec2 texel = color.rg + 0.5;
+
+    vec2 uv0 = (tileOrigin + vec2(slice0 * size, 0.0) + texel) / u_lutAtlasParams.xy;
+    vec2 uv1 = (tileOrigin + vec2(slice1 * size, 0.0) + texel) / u_lutAtlasParams.xy;
+    return mix(texture2DLod(s_lutAtlas, uv0, 0.0).rgb, texture2DLod(s_lutAtlas, uv1, 0.0).rgb, color.b - slice0);
+}
+
+void main() {
+    // The pixel position picks the tile, so thumbnails land on the same rows the UI samples on every backend
+    vec2 tile = floor(gl_FragCoord.xy / u_thumbnailParams.x);
+    vec2 uv = fract(gl_FragCoord.xy / u_thumbnailParams.x);
+    float slot = tile.y * u_thumbnailParams.y + tile.x;
+
+    if (slot >= u_thumbnailParams.z) {
+        gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    float size = u_thumbnailParams.w;
+    vec2 tileOrigin = tile * vec2(size * size, size);
+    gl_FragColor = vec4(sampleClut(referenceImage(uv), tileOrigin), 1.0);
+}
@@ -0,0 +1,158 @@
+// Tone mapping and CLUT grading shared by the raster pass (tonemap.frag.sc) and the compute pass (cs_tonemap.sc).
+// Include after declaring the samplers; the includer may define CLUT1D_SAMPLE to look the 1D CLUT up elsewhere.
+
+// Uniforms
+uniform vec4 u_params;          // x: exposure, y: clutStrength, z: tonemapOperator, w: splitPosition
+uniform vec4 u_flags;           // x: splitScreen, y: autoExposure, z: applyClut, w: use3DCLUT
+uniform vec4 u_clutParams;      // x: clutSize, y: atlas slot offset, z: atlas page depth
+uniform vec4 u_compareParams;   // x: candidate count (0 when off), y: layout (0 grid, 1 wipe), z: grid columns, w: grid rows
+uniform vec4 u_compareWipes[2]; // Wipe positions between neighbouring candidates
+uniform vec4 u_compareCluts[9]; // Per candidate x: atlas CLUT size (0 when resampled), y: slot offset, z: page depth, w: page
+uniform vec4 u_upscale;         // xy: scene target texel size, z: sharpness (0 at native resolution)
+
+#define COMPARE_GRID_SIZE 33.0
+#define COMPARE_MAX_CANDIDATES 9.0
+
+#ifndef CLUT1D_SAMPLE
+#	define CLUT1D_SAMPLE(_luminance) texture2DLod(s_colorLUT1D, vec2(_luminance, 0.0), 0.0).rgb
+#endif
+
+// The scene target may be smaller than the screen; the bilinear fetch upscales it, then an unsharp mask against
+// the four neighbouring texels restores some detail, clamped to their range so edges do not ring
+vec3 sampleScene(vec2 uv) {
+    vec3 color = texture2DLod(s_hdrBuffer, uv, 0.0).rgb;
+    if (u_upscale.z <= 0.0) {
+        return color;
+    }
+
+    vec3 left = texture2DLod(s_hdrBuffer, uv - vec2(u_upscale.x, 0.0), 0.0).rgb;
+    vec3 right = texture2DLod(s_hdrBuffer, uv + vec2(u_upscale.x, 0.0), 0.0).rgb;
+    vec3 up = texture2DLod(s_hdrBuffer, uv - vec2(0.0, u_upscale.y), 0.0).rgb;
+    vec3 down = texture2DLod(s_hdrBuffer, uv + vec2(0.0, u_upscale.y), 0.0).rgb;
+
+    vec3 minColor = min(color, min(min(left, right), min(up, down)));
+    vec3 maxColor = max(color, max(max(left, right), max(up, down)));
+    vec3 sharpened = color + (color - (left + right + up + down) * 0.25) * u_upscale.z;
+    return clamp(sharpened, minColor, maxColor);
+}
+
+vec3 reinhardTonemap(vec3 hdrColor) {
+    return hdrColor / (hdrColor + vec3(1.0));
+}
+
+vec3 acesTonemap(vec3 x) {
+    float a = 2.51f;
+    float b = 0.03f;
+    float c = 2.43f;
+    float d = 0.59f;
+    float e = 0.14f;
+    return clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0, 1.0);
+}
+
+vec3 apply1DCLUT(vec3 color) {
+    // Compute luminance to index the CLUT
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    
+    // Make sure luminance is in valid range [0,1]
+    luminance = clamp(luminance, 0.0, 1.0);
+    
+    // Sample the CLUT
+    vec3 clutColor = CLUT1D_SAMPLE(luminance);
+    
+    // Blend between original and CLUT mapped colors
+    return mix(color, clutColor, u_params.y); // clutStrength
+}
+
+vec3 apply3DCLUT(vec3 color) {
+    // Scale the texture coordinates to [0, 1]
+    color = clamp(color, 0.0, 1.0);
+
+    // The CLUT is one slot of an atlas page, stacked along depth starting at slice u_clutParams.y
+    float size = u_clutParams.x;
+    vec3 texel = color * (size - 1.0) + 0.5;
+    texel.z += u_clutParams.y;
+
+    // Sample the 3D CLUT at texel centres within its slot
+    vec3 clutColor = texture3DLod(s_colorLUT3D, texel / vec3(size, size, u_clutParams.z), 0.0).rgb;
+
+    // Blend between original and CLUT mapped colors
+    return mix(color, clutColor, u_params.y); // clutStrength
+}
+
+// Index of the comparison region containing a screen position, origin top left
+float compareRegion(vec2 position) {
+    if (u_compareParams.y > 0.5) { // Wipe
+        float region = 0.0;
+        for (int i = 0; i < 4; ++i) {
+            region += step(u_compareWipes[0][i], position.x) + step(u_compareWipes[1][i], position.x);
+        }
+        return region;
+    }
+
+    vec2 cell = min(floor(position * u_compareParams.zw), u_compareParams.zw - 1.0);
+    return cell.y * u_compareParams.z + cell.x;
+}
+
+// Grade with one candidate of the comparison set: 3D candidates from their slot in one of the bound atlas pages,
+// resampled ones from their slot along the depth of s_compareLUT
+vec3 applyCompareCLUT(vec3 color, float region) {
+    color = clamp(color, 0.0, 1.0);
+    vec4 clut = u_compareCluts[int(region)];
+
+    vec3 clutColor;
+    if (clut.x < 0.5) {
+        vec3 texel = color * (COMPARE_GRID_SIZE - 1.0) + 0.5;
+        texel.z += region * COMPARE_GRID_SIZE;
+        clutColor = texture3DLod(s_compareLUT, texel / vec3(COMPARE_GRID_SIZE, COMPARE_GRID_SIZE, COMPARE_GRID_SIZE * COMPARE_MAX_CANDIDATES), 0.0).rgb;
+    } else {
+        vec3 texel = color * (clut.x - 1.0) + 0.5;
+        texel.z += clut.y;
+        vec3 coord = texel / vec3(clut.x, clut.x, clut.z);
+        if (clut.w < 0.5) {
+            clutColor = texture3DLod(s_comparePage0, coord, 0.0).rgb;
+        } else if (clut.w < 1.5) {
+            clutColor = texture3DLod(s_comparePage1, coord, 0.0).rgb;
+        } else if (clut.w < 2.5) {
+            clutColor = texture3DLod(s_comparePage2, coord, 0.0).rgb;
+        } else {
+            clutColor = texture3DLod(s_comparePage3, coord, 0.0).rgb;
+        }
+    }
+    return mix(color, clutColor, u_params.y); // clutStrength
+}
+
+// The whole pass for one pixel at screen position uv, origin top left; exposure includes the auto exposure factor
+vec3 tonemapPixel(vec2 uv, float exposure) {
+    // Get HDR color from the framebuffer, upscaled when the scene rendered at a lower resolution
+    vec3 hdrColor = sampleScene(uv);
+
+    // Apply tone mapping based on selected operator
+    vec3 mapped;
+    if (u_params.z < 0.5) { // tonemapOperator == 0
+        mapped = reinhardTonemap(hdrColor * exposure);
+    } else {
+        mapped = acesTonemap(hdrColor * exposure);
+    }
+    
+    // Apply color grading with CLUT if enabled, or one candidate per region when comparing
+    vec3 finalColor = mapped;
+    if (u_compareParams.x > 0.5) {
+        float region = compareRegion(uv);
+        if (region < u_compareParams.x) {
+            finalColor = applyCompareCLUT(mapped, region);
+        }
+    } else if (u_flags.z > 0.5) { // applyClut
+        if (u_flags.w > 0.5) { // use3DCLUT
+            finalColor = apply3DCLUT(mapped);
+        } else {
+            finalColor = apply1DCLUT(mapped);
+        }
+    }
+    
+    // Split screen visualization if enabled
+    if (u_compareParams.x < 0.5 && u_flags.x > 0.5 && uv.x > u_params.w) { // splitScreen && screenPosition > splitPosition
+        finalColor = mapped; // Show without CLUT on right side
+    }
+
+    return finalColor;
+}
@@ -0,0 +1,148 @@
+#include "BatchGrader.h"
+
+#include <bimg/bimg.h>
+#include <bx/allocator.h>
+#include <bx/file.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+	// Formats bimg decodes; anything else in the input directory is skipped
+	bool isImageFile(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		static const char* const kExtensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".hdr", ".exr", ".dds", ".ktx" };
+		return std::find(std::begin(kExtensions), std::end(kExtensions), extension) != std::end(kExtensions);
+	}
+
+	uint8_t toUnorm8(float value)
+	{
+		return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+	}
+} // namespace
+
+BatchGrader::~BatchGrader()
+{
+	wait();
+}
+
+bool BatchGrader::start(const Settings& newSettings, const CLUT& newClut)
+{
+	if (isBusy())
+		return false;
+
+	std::error_code error;
+	std::vector<std::filesystem::path> inputs;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(newSettings.inputDirectory, error))
+	{
+		if (entry.is_regular_file() && isImageFile(entry.path()))
+		{
+			inputs.push_back(entry.path());
+		}
+	}
+	if (error)
+	{
+		std::cerr << "Failed to list images in " << newSettings.inputDirectory << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	std::filesystem::create_directories(newSettings.outputDirectory, error);
+	if (error)
+	{
+		std::cerr << "Failed to create grading directory " << newSettings.outputDirectory << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	settings = newSettings;
+	clut = newClut;
+	total = static_cast<uint32_t>(inputs.size());
+	graded = 0;
+	failed = 0;
+
+	// The last image to finish records the batch time
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (const std::filesystem::path& input : inputs)
+	{
+		const std::filesystem::path output = std::filesystem::path(settings.outputDirectory) / input.filename().replace_extension(".png");
+		JobSystem::run([this, inputPath = input.string(), outputPath = output.string(), start]()
+		{
+			if (!gradeImage(inputPath, outputPath))
+			{
+				std::cerr << "Failed to grade " << inputPath << std::endl;
+				failed.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			if (graded.fetch_add(1, std::memory_order_acq_rel) + 1 == total)
+			{
+				lastBatchMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+		}, &counter);
+	}
+	return true;
+}
+
+void BatchGrader::wait()
+{
+	JobSystem::wait(counter);
+}
+
+bool BatchGrader::gradeImage(const std::string& inputPath, const std::string& outputPath) const
+{
+	std::ifstream file(inputPath, std::ios::binary);
+	if (!file)
+		return false;
+
+	const std::vector<char> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (encoded.empty())
+		return false;
+
+	bx::DefaultAllocator allocator;
+	bimg::ImageContainer* image = bimg::imageParse(&allocator, encoded.data(), static_cast<uint32_t>(encoded.size()), bimg::TextureFormat::RGBA32F);
+	if (image == nullptr)
+		return false;
+
+	// Rows are independent, so they are graded in parallel within this image's job
+	const uint32_t width = image->m_width;
+	const uint32_t height = image->m_height;
+	const float* source = static_cast<const float*>(image->m_data);
+	std::vector<uint8_t> pixels(size_t(width) * height * 4);
+
+	JobSystem::parallelFor(0, height, [&](uint32_t rowBegin, uint32_t rowEnd)
+	{
+		for (uint32_t y = rowBegin; y < rowEnd; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				const size_t index = (size_t(y) * width + x) * 4;
+				float result[3];
+				clut.sample(&source[index], result);
+
+				pixels[index + 0] = toUnorm8(result[0]);
+				pixels[index + 1] = toUnorm8(result[1]);
+				pixels[index + 2] = toUnorm8(result[2]);
+				pixels[index + 3] = toUnorm8(source[index + 3]);
+			}
+		}
+	});
+	bimg::imageFree(image);
+
+	bx::FileWriter writer;
+	bx::Error error;
+	if (!bx::open(&writer, outputPath.c_str(), false, &error))
+		return false;
+
+	bimg::imageWritePng(&writer, width, height, width * 4, pixels.data(), bimg::TextureFormat::RGBA8, false, &error);
+	bx::close(&writer);
+	return error.isOk();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "../core/JobSystem.h"
+#include "CLUT.h"
+
+// Grades a folder of images with a CLUT on the CPU, off the main thread.
+// Every image is a job that decodes it to float RGBA, grades its rows with parallelFor through CLUT::sample
+// and writes the result as a PNG of the same name into the output directory. The CLUT is applied to the
+// decoded values as they are, so it suits display referred images; HDR inputs are clamped to [0, 1].
+class BatchGrader
+{
+public:
+	struct Settings
+	{
+		std::string inputDirectory = "grade_input";
+		std::string outputDirectory = "grade_output";
+	};
+
+	BatchGrader() = default;
+	~BatchGrader();
+
+	BatchGrader(const BatchGrader&) = delete;
+	BatchGrader& operator=(const BatchGrader&) = delete;
+
+	// Queue every image of the input directory, graded with a copy of clut. Returns false while a batch is
+	// running, or when the input cannot be listed or the output directory cannot be created.
+	bool start(const Settings& newSettings, const CLUT& clut);
+
+	bool isBusy() const { return !counter.isDone(); }
+
+	// Help finish the running batch on the calling thread
+	void wait();
+
+	uint32_t getTotal() const { return total; }
+	uint32_t getGraded() const { return graded.load(std::memory_order_relaxed); }
+	uint32_t getFailed() const { return failed.load(std::memory_order_relaxed); }
+	float getLastBatchMs() const { return lastBatchMs.load(std::memory_order_relaxed); }
+
+private:
+	// Decode, grade and write one image; returns false when any step failed
+	bool gradeImage(const std::string& inputPath, const std::string& outputPath) const;
+
+	Settings settings;
+	CLUT clut;
+	JobCounter counter;
+
+	uint32_t total = 0;
+	std::atomic<uint32_t> graded{ 0 };
+	std::atomic<uint32_t> failed{ 0 };
+	std::atomic<float> lastBatchMs{ 0.0f };
+};
@@ -1,11 +1,13 @@
 #include "CLUT.h"
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 
+#include "../core/JobSystem.h"
 #include "../renderer/BgfxUtils.h"
 
 CLUT::CLUT()
@@ -58,6 +60,60 @@ void CLUT::setIs3DCLUT(bool is3D)
 	this->is3D = is3D;
 }
 
+void CLUT::sample(const float color[3], float result[3]) const
+{
+	const int expected = is3D ? size * size * size * 3 : size * 3;
+	if (size < 1 || static_cast<int>(data.size()) < expected)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			result[c] = color[c];
+		}
+		return;
+	}
+
+	if (!is3D)
+	{
+		// Linear lookup by luminance
+		const float luminance = std::clamp(color[0] * 0.2126f + color[1] * 0.7152f + color[2] * 0.0722f, 0.0f, 1.0f);
+		const float position = luminance * (size - 1);
+		const int i0 = std::min(static_cast<int>(position), size - 1);
+		const int i1 = std::min(i0 + 1, size - 1);
+		const float t = position - i0;
+
+		for (int c = 0; c < 3; ++c)
+		{
+			result[c] = data[i0 * 3 + c] * (1.0f - t) + data[i1 * 3 + c] * t;
+		}
+		return;
+	}
+
+	// Trilinear lookup, stored red fastest and blue slowest
+	int i0[3], i1[3];
+	float t[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const float position = std::clamp(color[axis], 0.0f, 1.0f) * (size - 1);
+		i0[axis] = std::min(static_cast<int>(position), size - 1);
+		i1[axis] = std::min(i0[axis] + 1, size - 1);
+		t[axis] = position - i0[axis];
+	}
+
+	result[0] = result[1] = result[2] = 0.0f;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		const int r = (corner & 1) ? i1[0] : i0[0];
+		const int g = (corner & 2) ? i1[1] : i0[1];
+		const int b = (corner & 4) ? i1[2] : i0[2];
+		const float weight = ((corner & 1) ? t[0] : 1.0f - t[0]) * ((corner & 2) ? t[1] : 1.0f - t[1]) * ((corner & 4) ? t[2] : 1.0f - t[2]);
+
+		const float* texel = &data[((b * size + g) * size + r) * 3];
+		result[0] += texel[0] * weight;
+		result[1] += texel[1] * weight;
+		result[2] += texel[2] * weight;
+	}
+}
+
 void CLUT::saveToFile(const std::string& filename) const
 {
 	std::ofstream file(filename);
@@ -559,6 +615,7 @@ void CLUT::createPreset1DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 {
 	// --- 3D CLUTs ---
+	// Blue slices never share texels, so each table is filled with a parallelFor over them
 
 	// Neutral 3D CLUT (identity mapping)
 	CLUT neutral3D;
@@ -567,24 +624,27 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	neutral3D.is3D = true;
 	neutral3D.data.resize(neutral3D.size * neutral3D.size * neutral3D.size * 3);
 
-	for (int b = 0; b < neutral3D.size; b++)
+	JobSystem::parallelFor(0, neutral3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < neutral3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < neutral3D.size; r++)
+			for (int g = 0; g < neutral3D.size; g++)
 			{
-				int idx = (b * neutral3D.size * neutral3D.size + g * neutral3D.size + r) * 3;
+				for (int r = 0; r < neutral3D.size; r++)
+				{
+					int idx = (b * neutral3D.size * neutral3D.size + g * neutral3D.size + r) * 3;
 
-				float rNorm = static_cast<float>(r) / (neutral3D.size - 1);
-				float gNorm = static_cast<float>(g) / (neutral3D.size - 1);
-				float bNorm = static_cast<float>(b) / (neutral3D.size - 1);
+					float rNorm = static_cast<float>(r) / (neutral3D.size - 1);
+					float gNorm = static_cast<float>(g) / (neutral3D.size - 1);
+					float bNorm = static_cast<float>(b) / (neutral3D.size - 1);
 
-				neutral3D.data[idx + 0] = rNorm;
-				neutral3D.data[idx + 1] = gNorm;
-				neutral3D.data[idx + 2] = bNorm;
+					neutral3D.data[idx + 0] = rNorm;
+					neutral3D.data[idx + 1] = gNorm;
+					neutral3D.data[idx + 2] = bNorm;
+				}
 			}
 		}
-	}
+	});
 	clutLibrary["Neutral (3D)"] = neutral3D;
 
 	// Cinematic 3D CLUT
@@ -594,55 +654,58 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	cinematic3D.is3D = true;
 	cinematic3D.data.resize(cinematic3D.size * cinematic3D.size * cinematic3D.size * 3);
 
-	for (int b = 0; b < cinematic3D.size; b++)
+	JobSystem::parallelFor(0, cinematic3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < cinematic3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < cinematic3D.size; r++)
+			for (int g = 0; g < cinematic3D.size; g++)
 			{
-				int idx = (b * cinematic3D.size * cinematic3D.size + g * cinematic3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (cinematic3D.size - 1);
-				float gNorm = static_cast<float>(g) / (cinematic3D.size - 1);
-				float bNorm = static_cast<float>(b) / (cinematic3D.size - 1);
-
-				// Boost shadows and midtones in blue channel
-				float bNew = std::pow(bNorm, 0.85f);
-
-				// Warm up highlights
-				float rNew = rNorm * 1.05f;
-				if (rNorm > 0.7f)
-				{
-					rNew = rNorm * 1.1f;
-				}
-
-				// Increase contrast slightly
-				float contrast = 1.1f;
-				rNew = 0.5f + (rNew - 0.5f) * contrast;
-				gNorm = 0.5f + (gNorm - 0.5f) * contrast;
-				bNew = 0.5f + (bNew - 0.5f) * contrast;
-
-				// Add subtle orange-teal color scheme
-				if (rNorm > 0.6f && gNorm > 0.6f)
-				{
-					// Warm highlights
-					rNew = std::min(1.0f, rNew * 1.1f);
-					gNorm = std::min(1.0f, gNorm * 1.05f);
-					bNew = std::max(0.0f, bNew * 0.95f);
-				}
-				else if (bNorm > 0.5f)
+				for (int r = 0; r < cinematic3D.size; r++)
 				{
-					// Cooler shadows
-					rNew = std::max(0.0f, rNew * 0.95f);
-					bNew = std::min(1.0f, bNew * 1.05f);
+					int idx = (b * cinematic3D.size * cinematic3D.size + g * cinematic3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (cinematic3D.size - 1);
+					float gNorm = static_cast<float>(g) / (cinematic3D.size - 1);
+					float bNorm = static_cast<float>(b) / (cinematic3D.size - 1);
+
+					// Boost shadows and midtones in blue channel
+					float bNew = std::pow(bNorm, 0.85f);
+
+					// Warm up highlights
+					float rNew = rNorm * 1.05f;
+					if (rNorm > 0.7f)
+					{
+						rNew = rNorm * 1.1f;
+					}
+
+					// Increase contrast slightly
+					float contrast = 1.1f;
+					rNew = 0.5f + (rNew - 0.5f) * contrast;
+					gNorm = 0.5f + (gNorm - 0.5f) * contrast;
+					bNew = 0.5f + (bNew - 0.5f) * contrast;
+
+					// Add subtle orange-teal color scheme
+					if (rNorm > 0.6f && gNorm > 0.6f)
+					{
+						// Warm highlights
+						rNew = std::min(1.0f, rNew * 1.1f);
+						gNorm = std::min(1.0f, gNorm * 1.05f);
+						bNew = std::max(0.0f, bNew * 0.95f);
+					}
+					else if (bNorm > 0.5f)
+					{
+						// Cooler shadows
+						rNew = std::max(0.0f, rNew * 0.95f);
+						bNew = std::min(1.0f, bNew * 1.05f);
+					}
+
+					cinematic3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
+					cinematic3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNorm));
+					cinematic3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 				}
-
-				cinematic3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
-				cinematic3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNorm));
-				cinematic3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 			}
 		}
-	}
+	});
 	clutLibrary["Cinematic (3D)"] = cinematic3D;
 
 	// Cross-processed 3D CLUT
@@ -652,52 +715,55 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	crossProcess3D.is3D = true;
 	crossProcess3D.data.resize(crossProcess3D.size * crossProcess3D.size * crossProcess3D.size * 3);
 
-	for (int b = 0; b < crossProcess3D.size; b++)
+	JobSystem::parallelFor(0, crossProcess3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < crossProcess3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < crossProcess3D.size; r++)
+			for (int g = 0; g < crossProcess3D.size; g++)
 			{
-				int idx = (b * crossProcess3D.size * crossProcess3D.size + g * crossProcess3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (crossProcess3D.size - 1);
-				float gNorm = static_cast<float>(g) / (crossProcess3D.size - 1);
-				float bNorm = static_cast<float>(b) / (crossProcess3D.size - 1);
-
-				// Cross-processing effect (mimics developing C41 film in E6 chemicals or vice versa)
-				float rNew, gNew, bNew;
-
-				// Increase contrast
-				rNorm = 0.5f + (rNorm - 0.5f) * 1.3f;
-				gNorm = 0.5f + (gNorm - 0.5f) * 1.3f;
-				bNorm = 0.5f + (bNorm - 0.5f) * 1.3f;
-
-				rNorm = std::max(0.0f, std::min(1.0f, rNorm));
-				gNorm = std::max(0.0f, std::min(1.0f, gNorm));
-				bNorm = std::max(0.0f, std::min(1.0f, bNorm));
-
-				// Cyan in shadows, yellow in highlights
-				if (rNorm + gNorm + bNorm < 1.5f)
-				{
-					// Shadows to cyan
-					rNew = rNorm * 0.8f;
-					gNew = gNorm * 1.1f;
-					bNew = bNorm * 1.2f;
-				}
-				else
+				for (int r = 0; r < crossProcess3D.size; r++)
 				{
-					// Highlights to yellow
-					rNew = rNorm * 1.2f;
-					gNew = gNorm * 1.1f;
-					bNew = bNorm * 0.7f;
+					int idx = (b * crossProcess3D.size * crossProcess3D.size + g * crossProcess3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (crossProcess3D.size - 1);
+					float gNorm = static_cast<float>(g) / (crossProcess3D.size - 1);
+					float bNorm = static_cast<float>(b) / (crossProcess3D.size - 1);
+
+					// Cross-processing effect (mimics developing C41 film in E6 chemicals or vice versa)
+					float rNew, gNew, bNew;
+
+					// Increase contrast
+					rNorm = 0.5f + (rNorm - 0.5f) * 1.3f;
+					gNorm = 0.5f + (gNorm - 0.5f) * 1.3f;
+					bNorm = 0.5f + (bNorm - 0.5f) * 1.3f;
+
+					rNorm = std::max(0.0f, std::min(1.0f, rNorm));
+					gNorm = std::max(0.0f, std::min(1.0f, gNorm));
+					bNorm = std::max(0.0f, std::min(1.0f, bNorm));
+
+					// Cyan in shadows, yellow in highlights
+					if (rNorm + gNorm + bNorm < 1.5f)
+					{
+						// Shadows to cyan
+						rNew = rNorm * 0.8f;
+						gNew = gNorm * 1.1f;
+						bNew = bNorm * 1.2f;
+					}
+					else
+					{
+						// Highlights to yellow
+						rNew = rNorm * 1.2f;
+						gNew = gNorm * 1.1f;
+						bNew = bNorm * 0.7f;
+					}
+
+					crossProcess3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
+					crossProcess3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
+					crossProcess3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 				}
-
-				crossProcess3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
-				crossProcess3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
-				crossProcess3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 			}
 		}
-	}
+	});
 	clutLibrary["Cross Processed (3D)"] = crossProcess3D;
 
 	// Bleach Bypass 3D CLUT
@@ -707,52 +773,55 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	bleachBypass3D.is3D = true;
 	bleachBypass3D.data.resize(bleachBypass3D.size * bleachBypass3D.size * bleachBypass3D.size * 3);
 
-	for (int b = 0; b < bleachBypass3D.size; b++)
+	JobSystem::parallelFor(0, bleachBypass3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < bleachBypass3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < bleachBypass3D.size; r++)
+			for (int g = 0; g < bleachBypass3D.size; g++)
 			{
-				int idx = (b * bleachBypass3D.size * bleachBypass3D.size + g * bleachBypass3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (bleachBypass3D.size - 1);
-				float gNorm = static_cast<float>(g) / (bleachBypass3D.size - 1);
-				float bNorm = static_cast<float>(b) / (bleachBypass3D.size - 1);
-
-				// Calculate luminance
-				float luminance = 0.2126f * rNorm + 0.7152f * gNorm + 0.0722f * bNorm;
-
-				// Bleach bypass - desaturate and increase contrast
-				float desaturationAmount = 0.6f;
-				float contrastAmount = 1.5f;
-
-				// Blend desaturated and original
-				float rNew = rNorm * (1.0f - desaturationAmount) + luminance * desaturationAmount;
-				float gNew = gNorm * (1.0f - desaturationAmount) + luminance * desaturationAmount;
-				float bNew = bNorm * (1.0f - desaturationAmount) + luminance * desaturationAmount;
-
-				// Apply contrast
-				rNew = 0.5f + (rNew - 0.5f) * contrastAmount;
-				gNew = 0.5f + (gNew - 0.5f) * contrastAmount;
-				bNew = 0.5f + (bNew - 0.5f) * contrastAmount;
-
-				// Add slight blue to shadows and yellow/orange to highlights
-				if (luminance < 0.5f)
-				{
-					bNew = std::min(1.0f, bNew * 1.1f);
-				}
-				else
+				for (int r = 0; r < bleachBypass3D.size; r++)
 				{
-					rNew = std::min(1.0f, rNew * 1.1f);
-					gNew = std::min(1.0f, gNew * 1.05f);
+					int idx = (b * bleachBypass3D.size * bleachBypass3D.size + g * bleachBypass3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (bleachBypass3D.size - 1);
+					float gNorm = static_cast<float>(g) / (bleachBypass3D.size - 1);
+					float bNorm = static_cast<float>(b) / (bleachBypass3D.size - 1);
+
+					// Calculate luminance
+					float luminance = 0.2126f * rNorm + 0.7152f * gNorm + 0.0722f * bNorm;
+
+					// Bleach bypass - desaturate and increase contrast
+					float desaturationAmount = 0.6f;
+					float contrastAmount = 1.5f;
+
+					// Blend desaturated and original
+					float rNew = rNorm * (1.0f - desaturationAmount) + luminance * desaturationAmount;
+					float gNew = gNorm * (1.0f - desaturationAmount) + luminance * desaturationAmount;
+					float bNew = bNorm * (1.0f - desaturationAmount) + luminance * desaturationAmount;
+
+					// Apply contrast
+					rNew = 0.5f + (rNew - 0.5f) * contrastAmount;
+					gNew = 0.5f + (gNew - 0.5f) * contrastAmount;
+					bNew = 0.5f + (bNew - 0.5f) * contrastAmount;
+
+					// Add slight blue to shadows and yellow/orange to highlights
+					if (luminance < 0.5f)
+					{
+						bNew = std::min(1.0f, bNew * 1.1f);
+					}
+					else
+					{
+						rNew = std::min(1.0f, rNew * 1.1f);
+						gNew = std::min(1.0f, gNew * 1.05f);
+					}
+
+					bleachBypass3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
+					bleachBypass3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
+					bleachBypass3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 				}
-
-				bleachBypass3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
-				bleachBypass3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
-				bleachBypass3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 			}
 		}
-	}
+	});
 	clutLibrary["Bleach Bypass (3D)"] = bleachBypass3D;
 
 	// Teal and Orange 3D CLUT
@@ -762,52 +831,55 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	tealOrange3D.is3D = true;
 	tealOrange3D.data.resize(tealOrange3D.size * tealOrange3D.size * tealOrange3D.size * 3);
 
-	for (int b = 0; b < tealOrange3D.size; b++)
+	JobSystem::parallelFor(0, tealOrange3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < tealOrange3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < tealOrange3D.size; r++)
+			for (int g = 0; g < tealOrange3D.size; g++)
 			{
-				int idx = (b * tealOrange3D.size * tealOrange3D.size + g * tealOrange3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (tealOrange3D.size - 1);
-				float gNorm = static_cast<float>(g) / (tealOrange3D.size - 1);
-				float bNorm = static_cast<float>(b) / (tealOrange3D.size - 1);
-
-				// Calculate luminance
-				float luminance = 0.2126f * rNorm + 0.7152f * gNorm + 0.0722f * bNorm;
-
-				// Push shadows towards teal and highlights towards orange
-				float rNew = rNorm;
-				float gNew = gNorm;
-				float bNew = bNorm;
-
-				if (luminance < 0.5f)
+				for (int r = 0; r < tealOrange3D.size; r++)
 				{
-					// Shadows to teal (reduce red, boost blue and green)
-					rNew *= 0.8f;
-					gNew *= 1.1f;
-					bNew *= 1.2f;
+					int idx = (b * tealOrange3D.size * tealOrange3D.size + g * tealOrange3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (tealOrange3D.size - 1);
+					float gNorm = static_cast<float>(g) / (tealOrange3D.size - 1);
+					float bNorm = static_cast<float>(b) / (tealOrange3D.size - 1);
+
+					// Calculate luminance
+					float luminance = 0.2126f * rNorm + 0.7152f * gNorm + 0.0722f * bNorm;
+
+					// Push shadows towards teal and highlights towards orange
+					float rNew = rNorm;
+					float gNew = gNorm;
+					float bNew = bNorm;
+
+					if (luminance < 0.5f)
+					{
+						// Shadows to teal (reduce red, boost blue and green)
+						rNew *= 0.8f;
+						gNew *= 1.1f;
+						bNew *= 1.2f;
+					}
+					else
+					{
+						// Highlights to orange (boost red and green, reduce blue)
+						rNew *= 1.3f;
+						gNew *= 1.1f;
+						bNew *= 0.6f;
+					}
+
+					// Increase contrast overall
+					rNew = 0.5f + (rNew - 0.5f) * 1.2f;
+					gNew = 0.5f + (gNew - 0.5f) * 1.2f;
+					bNew = 0.5f + (bNew - 0.5f) * 1.2f;
+
+					tealOrange3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
+					tealOrange3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
+					tealOrange3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 				}
-				else
-				{
-					// Highlights to orange (boost red and green, reduce blue)
-					rNew *= 1.3f;
-					gNew *= 1.1f;
-					bNew *= 0.6f;
-				}
-
-				// Increase contrast overall
-				rNew = 0.5f + (rNew - 0.5f) * 1.2f;
-				gNew = 0.5f + (gNew - 0.5f) * 1.2f;
-				bNew = 0.5f + (bNew - 0.5f) * 1.2f;
-
-				tealOrange3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
-				tealOrange3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
-				tealOrange3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 			}
 		}
-	}
+	});
 	clutLibrary["Teal and Orange (3D)"] = tealOrange3D;
 
 	// Fujifilm Pro 400H 3D CLUT (film emulation)
@@ -817,51 +889,54 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	fujiPro3D.is3D = true;
 	fujiPro3D.data.resize(fujiPro3D.size * fujiPro3D.size * fujiPro3D.size * 3);
 
-	for (int b = 0; b < fujiPro3D.size; b++)
+	JobSystem::parallelFor(0, fujiPro3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < fujiPro3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < fujiPro3D.size; r++)
+			for (int g = 0; g < fujiPro3D.size; g++)
 			{
-				int idx = (b * fujiPro3D.size * fujiPro3D.size + g * fujiPro3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (fujiPro3D.size - 1);
-				float gNorm = static_cast<float>(g) / (fujiPro3D.size - 1);
-				float bNorm = static_cast<float>(b) / (fujiPro3D.size - 1);
-
-				// Fuji Pro 400H is known for its subtle pastel colors and slightly greenish midtones
-				float rNew = rNorm;
-				float gNew = gNorm;
-				float bNew = bNorm;
-
-				// Softer contrast in shadows
-				if (rNorm < 0.3f)
-					rNew = rNorm * 1.1f;
-				if (gNorm < 0.3f)
-					gNew = gNorm * 1.05f;
-				if (bNorm < 0.3f)
-					bNew = bNorm * 1.1f;
-
-				// Greenish-blue tint in midtones
-				if (rNorm >= 0.3f && rNorm < 0.7f)
+				for (int r = 0; r < fujiPro3D.size; r++)
 				{
-					gNew = std::min(1.0f, gNorm * 1.05f);
-					bNew = std::min(1.0f, bNorm * 1.03f);
+					int idx = (b * fujiPro3D.size * fujiPro3D.size + g * fujiPro3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (fujiPro3D.size - 1);
+					float gNorm = static_cast<float>(g) / (fujiPro3D.size - 1);
+					float bNorm = static_cast<float>(b) / (fujiPro3D.size - 1);
+
+					// Fuji Pro 400H is known for its subtle pastel colors and slightly greenish midtones
+					float rNew = rNorm;
+					float gNew = gNorm;
+					float bNew = bNorm;
+
+					// Softer contrast in shadows
+					if (rNorm < 0.3f)
+						rNew = rNorm * 1.1f;
+					if (gNorm < 0.3f)
+						gNew = gNorm * 1.05f;
+					if (bNorm < 0.3f)
+						bNew = bNorm * 1.1f;
+
+					// Greenish-blue tint in midtones
+					if (rNorm >= 0.3f && rNorm < 0.7f)
+					{
+						gNew = std::min(1.0f, gNorm * 1.05f);
+						bNew = std::min(1.0f, bNorm * 1.03f);
+					}
+
+					// Soft pastel highlights with a subtle purple tint
+					if (rNorm >= 0.7f)
+					{
+						rNew = std::min(1.0f, 0.9f + (rNorm - 0.7f) * 0.33f);
+						bNew = std::min(1.0f, bNorm * 1.1f);
+					}
+
+					fujiPro3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
+					fujiPro3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
+					fujiPro3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 				}
-
-				// Soft pastel highlights with a subtle purple tint
-				if (rNorm >= 0.7f)
-				{
-					rNew = std::min(1.0f, 0.9f + (rNorm - 0.7f) * 0.33f);
-					bNew = std::min(1.0f, bNorm * 1.1f);
-				}
-
-				fujiPro3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
-				fujiPro3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
-				fujiPro3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 			}
 		}
-	}
+	});
 	clutLibrary["Fujifilm Pro 400H (3D)"] = fujiPro3D;
 
 	// Kodak Portra 400 3D CLUT (film emulation)
@@ -871,53 +946,56 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	portra3D.is3D = true;
 	portra3D.data.resize(portra3D.size * portra3D.size * portra3D.size * 3);
 
-	for (int b = 0; b < portra3D.size; b++)
+	JobSystem::parallelFor(0, portra3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < portra3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < portra3D.size; r++)
+			for (int g = 0; g < portra3D.size; g++)
 			{
-				int idx = (b * portra3D.size * portra3D.size + g * portra3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (portra3D.size - 1);
-				float gNorm = static_cast<float>(g) / (portra3D.size - 1);
-				float bNorm = static_cast<float>(b) / (portra3D.size - 1);
-
-				// Portra is known for its warm, natural skin tones and muted colors
-				float rNew = rNorm;
-				float gNew = gNorm;
-				float bNew = bNorm;
-
-				// Softer shadow contrast
-				if (rNorm < 0.3f)
-					rNew = rNorm * 1.05f;
-				if (gNorm < 0.3f)
-					gNew = gNorm * 1.05f;
-				if (bNorm < 0.3f)
-					bNew = bNorm * 0.95f;
-
-				// Warm midtones (slightly golden)
-				if (rNorm >= 0.3f && rNorm < 0.7f)
+				for (int r = 0; r < portra3D.size; r++)
 				{
-					rNew = std::min(1.0f, rNorm * 1.05f);
-					gNew = std::min(1.0f, gNorm * 1.03f);
-					bNew = std::min(1.0f, bNorm * 0.98f);
+					int idx = (b * portra3D.size * portra3D.size + g * portra3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (portra3D.size - 1);
+					float gNorm = static_cast<float>(g) / (portra3D.size - 1);
+					float bNorm = static_cast<float>(b) / (portra3D.size - 1);
+
+					// Portra is known for its warm, natural skin tones and muted colors
+					float rNew = rNorm;
+					float gNew = gNorm;
+					float bNew = bNorm;
+
+					// Softer shadow contrast
+					if (rNorm < 0.3f)
+						rNew = rNorm * 1.05f;
+					if (gNorm < 0.3f)
+						gNew = gNorm * 1.05f;
+					if (bNorm < 0.3f)
+						bNew = bNorm * 0.95f;
+
+					// Warm midtones (slightly golden)
+					if (rNorm >= 0.3f && rNorm < 0.7f)
+					{
+						rNew = std::min(1.0f, rNorm * 1.05f);
+						gNew = std::min(1.0f, gNorm * 1.03f);
+						bNew = std::min(1.0f, bNorm * 0.98f);
+					}
+
+					// Soft pastel highlights
+					if (rNorm >= 0.7f)
+					{
+						rNew = std::min(1.0f, 0.9f + (rNorm - 0.7f) * 0.33f);
+						gNew = std::min(1.0f, gNorm * 1.05f);
+						bNew = std::min(1.0f, bNorm * 1.03f);
+					}
+
+					portra3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
+					portra3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
+					portra3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 				}
-
-				// Soft pastel highlights
-				if (rNorm >= 0.7f)
-				{
-					rNew = std::min(1.0f, 0.9f + (rNorm - 0.7f) * 0.33f);
-					gNew = std::min(1.0f, gNorm * 1.05f);
-					bNew = std::min(1.0f, bNorm * 1.03f);
-				}
-
-				portra3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rNew));
-				portra3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gNew));
-				portra3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bNew));
 			}
 		}
-	}
+	});
 	clutLibrary["Kodak Portra 400 (3D)"] = portra3D;
 
 	// Toon 3D CLUT (cel shading)
@@ -930,50 +1008,53 @@ void CLUT::createPreset3DCLUTs(std::map<std::string, CLUT>& clutLibrary)
 	// Define number of steps (bands) for cel shading effect
 	const int numBands = 4;
 
-	for (int b = 0; b < toon3D.size; b++)
+	JobSystem::parallelFor(0, toon3D.size, [&](uint32_t bBegin, uint32_t bEnd)
 	{
-		for (int g = 0; g < toon3D.size; g++)
+		for (int b = static_cast<int>(bBegin); b < static_cast<int>(bEnd); b++)
 		{
-			for (int r = 0; r < toon3D.size; r++)
+			for (int g = 0; g < toon3D.size; g++)
 			{
-				int idx = (b * toon3D.size * toon3D.size + g * toon3D.size + r) * 3;
-
-				float rNorm = static_cast<float>(r) / (toon3D.size - 1);
-				float gNorm = static_cast<float>(g) / (toon3D.size - 1);
-				float bNorm = static_cast<float>(b) / (toon3D.size - 1);
-
-				// Quantize each color channel to create distinct bands
-				float rQuant = std::floor(rNorm * numBands) / (numBands - 1);
-				float gQuant = std::floor(gNorm * numBands) / (numBands - 1);
-				float bQuant = std::floor(bNorm * numBands) / (numBands - 1);
-
-				// Add slight boost to emphasize color transitions
-				rQuant = std::min(1.0f, rQuant * 1.05f);
-				gQuant = std::min(1.0f, gQuant * 1.05f);
-				bQuant = std::min(1.0f, bQuant * 1.05f);
-
-				// Calculate luminance
-				float luminance = 0.2126f * rNorm + 0.7152f * gNorm + 0.0722f * bNorm;
-
-				// Boost saturation to make colors more vibrant (cartoon-like)
-				float saturationBoost = 1.2f;
-				float luminanceWeight = 0.3f;
-
-				rQuant = rQuant * (1.0f - luminanceWeight) + luminance * luminanceWeight;
-				gQuant = gQuant * (1.0f - luminanceWeight) + luminance * luminanceWeight;
-				bQuant = bQuant * (1.0f - luminanceWeight) + luminance * luminanceWeight;
-
-				// Apply saturation boost
-				float avgColor = (rQuant + gQuant + bQuant) / 3.0f;
-				rQuant = avgColor + (rQuant - avgColor) * saturationBoost;
-				gQuant = avgColor + (gQuant - avgColor) * saturationBoost;
-				bQuant = avgColor + (bQuant - avgColor) * saturationBoost;
-
-				toon3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rQuant));
-				toon3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gQuant));
-				toon3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bQuant));
+				for (int r = 0; r < toon3D.size; r++)
+				{
+					int idx = (b * toon3D.size * toon3D.size + g * toon3D.size + r) * 3;
+
+					float rNorm = static_cast<float>(r) / (toon3D.size - 1);
+					float gNorm = static_cast<float>(g) / (toon3D.size - 1);
+					float bNorm = static_cast<float>(b) / (toon3D.size - 1);
+
+					// Quantize each color channel to create distinct bands
+					float rQuant = std::floor(rNorm * numBands) / (numBands - 1);
+					float gQuant = std::floor(gNorm * numBands) / (numBands - 1);
+					float bQuant = std::floor(bNorm * numBands) / (numBands - 1);
+
+					// Add slight boost to emphasize color transitions
+					rQuant = std::min(1.0f, rQuant * 1.05f);
+					gQuant = std::min(1.0f, gQuant * 1.05f);
+					bQuant = std::min(1.0f, bQuant * 1.05f);
+
+					// Calculate luminance
+					float luminance = 0.2126f * rNorm + 0.7152f * gNorm + 0.0722f * bNorm;
+
+					// Boost saturation to make colors more vibrant (cartoon-like)
+					float saturationBoost = 1.2f;
+					float luminanceWeight = 0.3f;
+
+					rQuant = rQuant * (1.0f - luminanceWeight) + luminance * luminanceWeight;
+					gQuant = gQuant * (1.0f - luminanceWeight) + luminance * luminanceWeight;
+					bQuant = bQuant * (1.0f - luminanceWeight) + luminance * luminanceWeight;
+
+					// Apply saturation boost
+					float avgColor = (rQuant + gQuant + bQuant) / 3.0f;
+					rQuant = avgColor + (rQuant - avgColor) * saturationBoost;
+					gQuant = avgColor + (gQuant - avgColor) * saturationBoost;
+					bQuant = avgColor + (bQuant - avgColor) * saturationBoost;
+
+					toon3D.data[idx + 0] = std::max(0.0f, std::min(1.0f, rQuant));
+					toon3D.data[idx + 1] = std::max(0.0f, std::min(1.0f, gQuant));
+					toon3D.data[idx + 2] = std::max(0.0f, std::min(1.0f, bQuant));
+				}
 			}
 		}
-	}
+	});
 	clutLibrary["Toon (3D)"] = toon3D;
 }
@@ -24,6 +24,10 @@ public:
 	void setSize(int size);
 	void setIs3DCLUT(bool is3D);
 
+	// Grade a color on the CPU the way the tonemap shader does: trilinear for 3D CLUTs, by luminance
+	// for 1D ones. Colors are clamped to [0, 1]; an empty or truncated CLUT returns the color unchanged.
+	void sample(const float color[3], float result[3]) const;
+
 	// Save and load CLUT data to/from a file
 	void saveToFile(const std::string& filename) const;
 	static CLUT loadFromFile(const std::string& filename);
@@ -0,0 +1,137 @@
+#include "ClutAtlas.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <bx/math.h>
+
+#include "CLUT.h"
+
+void ClutAtlasLocation::getParams(float params[4]) const
+{
+	params[0] = float(size);
+	params[1] = offset;
+	params[2] = depth;
+	params[3] = 0.0f;
+}
+
+ClutAtlas::~ClutAtlas()
+{
+	destroy();
+}
+
+void ClutAtlas::destroy()
+{
+	for (Page& page : pages)
+	{
+		if (bgfx::isValid(page.texture))
+		{
+			bgfx::destroy(page.texture);
+		}
+	}
+
+	pages.clear();
+	entries.clear();
+	allocatedBytes = 0;
+	usedBytes = 0;
+}
+
+bool ClutAtlas::allocate(int size, Entry& entry)
+{
+	int lastCapacity = 0;
+	for (size_t i = 0; i < pages.size(); ++i)
+	{
+		Page& page = pages[i];
+		if (page.size != size)
+			continue;
+
+		if (page.used < page.capacity)
+		{
+			entry = { static_cast<int>(i), page.used++ };
+			return true;
+		}
+		lastCapacity = std::max(lastCapacity, page.capacity);
+	}
+
+	// Grow geometrically, but never past the depth limit or the remaining budget
+	const int maxSlots = kMaxDepth / size;
+	const uint64_t remaining = budgetBytes > allocatedBytes ? budgetBytes - allocatedBytes : 0;
+	const int affordable = static_cast<int>(std::min<uint64_t>(remaining / slotBytes(size), uint64_t(maxSlots)));
+	const int capacity = std::min(lastCapacity > 0 ? lastCapacity * 2 : kFirstPageSlots, affordable);
+	if (capacity < 1 || maxSlots < 1)
+	{
+		std::cerr << "CLUT atlas budget of " << (budgetBytes >> 20) << " MB exceeded, " << size << "^3 CLUT not resident" << std::endl;
+		return false;
+	}
+
+	Page page;
+	page.size = size;
+	page.capacity = capacity;
+	page.used = 1;
+	page.texture = bgfx::createTexture3D(uint16_t(size), uint16_t(size), uint16_t(size * capacity), false, bgfx::TextureFormat::RGBA16F, BGFX_SAMPLER_UVW_CLAMP);
+	if (!bgfx::isValid(page.texture))
+	{
+		std::cerr << "Failed to create CLUT atlas page" << std::endl;
+		return false;
+	}
+
+	pages.push_back(page);
+	allocatedBytes += slotBytes(size) * capacity;
+	entry = { static_cast<int>(pages.size()) - 1, 0 };
+	return true;
+}
+
+ClutAtlasLocation ClutAtlas::update(const std::string& name, const CLUT& clut)
+{
+	const int size = clut.getSize();
+	const std::vector<float>& data = clut.getData();
+	if (!clut.is3DCLUT() || size < 2 || data.size() < size_t(size) * size * size * 3)
+		return {};
+
+	// A CLUT that changed size keeps its old slot allocated until the atlas is destroyed
+	auto it = entries.find(name);
+	if (it == entries.end() || pages[it->second.page].size != size)
+	{
+		Entry entry;
+		if (!allocate(size, entry))
+			return {};
+
+		usedBytes += slotBytes(size);
+		it = entries.insert_or_assign(name, entry).first;
+	}
+
+	const size_t texels = size_t(size) * size * size;
+	staging.resize(texels * 4);
+	for (size_t i = 0; i < texels; ++i)
+	{
+		staging[i * 4 + 0] = bx::halfFromFloat(data[i * 3 + 0]);
+		staging[i * 4 + 1] = bx::halfFromFloat(data[i * 3 + 1]);
+		staging[i * 4 + 2] = bx::halfFromFloat(data[i * 3 + 2]);
+		staging[i * 4 + 3] = bx::halfFromFloat(1.0f);
+	}
+
+	const Page& page = pages[it->second.page];
+	const bgfx::Memory* mem = bgfx::copy(staging.data(), uint32_t(staging.size() * sizeof(uint16_t)));
+	bgfx::updateTexture3D(page.texture, 0, 0, 0, uint16_t(it->second.slot * size), uint16_t(size), uint16_t(size), uint16_t(size), mem);
+	++uploadCount;
+
+	return locate(it->second);
+}
+
+ClutAtlasLocation ClutAtlas::find(const std::string& name) const
+{
+	auto it = entries.find(name);
+	return it != entries.end() ? locate(it->second) : ClutAtlasLocation{};
+}
+
+ClutAtlasLocation ClutAtlas::locate(const Entry& entry) const
+{
+	const Page& page = pages[entry.page];
+
+	ClutAtlasLocation location;
+	location.texture = page.texture;
+	location.size = page.size;
+	location.offset = float(entry.slot * page.size);
+	location.depth = float(page.size * page.capacity);
+	return location;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CLUT;
+
+// Where a resident 3D CLUT lives: the page texture and the first slice of its slot
+struct ClutAtlasLocation
+{
+	bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+	int size = 0;         // CLUT resolution per axis
+	float offset = 0.0f;  // First depth slice of the slot
+	float depth = 0.0f;   // Depth of the page texture, in slices
+
+	bool isValid() const { return bgfx::isValid(texture); }
+
+	// u_clutParams for the tonemap shader: x = size, y = slot offset, z = page depth
+	void getParams(float params[4]) const;
+};
+
+// Keeps 3D CLUTs resident on the GPU so switching between them only changes uniforms.
+// CLUTs of the same size share pages: RGBA16F 3D textures holding several CLUTs stacked along depth.
+// A page of a size is only created once the previous one is full, each twice as deep as the last, and
+// pages are only allocated while the total stays within the memory budget.
+class ClutAtlas
+{
+public:
+	// Common limit on 3D texture depth; a page never holds more slices than this
+	static constexpr int kMaxDepth = 2048;
+	static constexpr int kFirstPageSlots = 4;
+
+	ClutAtlas() = default;
+	~ClutAtlas();
+
+	// Budget for page allocations; lowering it only affects pages created later
+	void setBudget(uint64_t bytes) { budgetBytes = bytes; }
+	uint64_t getBudget() const { return budgetBytes; }
+
+	// Upload a 3D CLUT, replacing the one with the same name in place when the size matches.
+	// Returns its location, invalid when it is not a 3D CLUT or no page fits the budget.
+	ClutAtlasLocation update(const std::string& name, const CLUT& clut);
+
+	// Location of a resident CLUT, invalid when it has none
+	ClutAtlasLocation find(const std::string& name) const;
+
+	// Release every page; all locations become invalid
+	void destroy();
+
+	uint64_t getAllocatedBytes() const { return allocatedBytes; }
+	uint64_t getUsedBytes() const { return usedBytes; }
+	uint32_t getClutCount() const { return static_cast<uint32_t>(entries.size()); }
+	uint32_t getPageCount() const { return static_cast<uint32_t>(pages.size()); }
+	uint32_t getUploadCount() const { return uploadCount; }
+
+private:
+	struct Page
+	{
+		bgfx::TextureHandle texture;
+		int size;
+		int capacity; // Slots
+		int used;
+	};
+
+	struct Entry
+	{
+		int page;
+		int slot;
+	};
+
+	static uint64_t slotBytes(int size) { return uint64_t(size) * size * size * 8; }
+
+	// Find a free slot for a CLUT of this size, creating a page when needed; false when over budget
+	bool allocate(int size, Entry& entry);
+
+	ClutAtlasLocation locate(const Entry& entry) const;
+
+	std::vector<Page> pages;
+	std::unordered_map<std::string, Entry> entries;
+	std::vector<uint16_t> staging;
+
+	uint64_t budgetBytes = 256ull << 20;
+	uint64_t allocatedBytes = 0;
+	uint64_t usedBytes = 0;
+	uint32_t uploadCount = 0;
+};
@@ -0,0 +1,298 @@
+#include "ClutCompare.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <bx/math.h>
+
+#include "CLUT.h"
+
+ClutCompare::~ClutCompare()
+{
+	destroy();
+}
+
+bool ClutCompare::create(ClutAtlas& clutAtlas)
+{
+	destroy();
+
+	atlas = &clutAtlas;
+	texture = bgfx::createTexture3D(uint16_t(kGridSize), uint16_t(kGridSize), uint16_t(kGridSize * kMaxCandidates), false, bgfx::TextureFormat::RGBA16F, BGFX_SAMPLER_UVW_CLAMP);
+	sampler = bgfx::createUniform("s_compareLUT", bgfx::UniformType::Sampler);
+	paramsUniform = bgfx::createUniform("u_compareParams", bgfx::UniformType::Vec4);
+	wipesUniform = bgfx::createUniform("u_compareWipes", bgfx::UniformType::Vec4, 2);
+	clutsUniform = bgfx::createUniform("u_compareCluts", bgfx::UniformType::Vec4, kMaxCandidates);
+	for (int i = 0; i < kMaxPages; ++i)
+	{
+		const std::string name = "s_comparePage" + std::to_string(i);
+		pageSamplers[i] = bgfx::createUniform(name.c_str(), bgfx::UniformType::Sampler);
+	}
+
+	if (!bgfx::isValid(texture))
+	{
+		std::cerr << "Failed to create CLUT comparison texture" << std::endl;
+		destroy();
+		return false;
+	}
+
+	resetWipes();
+	return true;
+}
+
+void ClutCompare::destroy()
+{
+	if (bgfx::isValid(texture))
+	{
+		bgfx::destroy(texture);
+		texture = BGFX_INVALID_HANDLE;
+	}
+
+	bgfx::UniformHandle* uniforms[] = { &sampler, &paramsUniform, &wipesUniform, &clutsUniform, &pageSamplers[0], &pageSamplers[1], &pageSamplers[2], &pageSamplers[3] };
+	for (bgfx::UniformHandle* handle : uniforms)
+	{
+		if (bgfx::isValid(*handle))
+		{
+			bgfx::destroy(*handle);
+			*handle = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	names.clear();
+	locations.clear();
+	texels.clear();
+	atlas = nullptr;
+}
+
+bool ClutCompare::contains(const std::string& name) const
+{
+	return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+bool ClutCompare::add(const std::string& name, const CLUT& clut)
+{
+	if (getCount() >= kMaxCandidates || contains(name))
+		return false;
+
+	names.push_back(name);
+	locations.emplace_back();
+	texels.resize(names.size() * kSlotTexels * 4);
+	assign(getCount() - 1, clut);
+	resetWipes();
+	return true;
+}
+
+void ClutCompare::refresh(const std::string& name, const CLUT& clut)
+{
+	auto it = std::find(names.begin(), names.end(), name);
+	if (it != names.end())
+	{
+		assign(static_cast<int>(it - names.begin()), clut);
+	}
+}
+
+void ClutCompare::remove(int index)
+{
+	if (index < 0 || index >= getCount())
+		return;
+
+	// Later slots move down one, the whole texture is uploaded again anyway
+	names.erase(names.begin() + index);
+	locations.erase(locations.begin() + index);
+	texels.erase(texels.begin() + size_t(index) * kSlotTexels * 4, texels.begin() + size_t(index + 1) * kSlotTexels * 4);
+	resetWipes();
+	dirty = true;
+}
+
+void ClutCompare::clear()
+{
+	names.clear();
+	locations.clear();
+	texels.clear();
+	dirty = true;
+	++revision;
+}
+
+void ClutCompare::setLayout(Layout value)
+{
+	if (layout != value)
+	{
+		layout = value;
+		++revision;
+	}
+}
+
+void ClutCompare::setWipe(int index, float position)
+{
+	// Wipes cannot cross their neighbours, so every candidate keeps a region
+	const float low = index > 0 ? wipes[index - 1] : 0.0f;
+	const float high = index < getCount() - 2 ? wipes[index + 1] : 1.0f;
+	position = std::clamp(position, low, high);
+	if (wipes[index] != position)
+	{
+		wipes[index] = position;
+		++revision;
+	}
+}
+
+void ClutCompare::resetWipes()
+{
+	const int count = std::max(getCount(), 1);
+	for (int i = 0; i < kMaxCandidates - 1; ++i)
+	{
+		wipes[i] = i < count - 1 ? float(i + 1) / count : 1.0f;
+	}
+	++revision;
+}
+
+void ClutCompare::getGrid(int& columns, int& rows) const
+{
+	const int count = std::max(getCount(), 1);
+	columns = static_cast<int>(std::ceil(std::sqrt(float(count))));
+	rows = (count + columns - 1) / columns;
+}
+
+void ClutCompare::getRegion(int index, float& x0, float& y0, float& x1, float& y1) const
+{
+	if (layout == Layout::Wipe)
+	{
+		x0 = index > 0 ? wipes[index - 1] : 0.0f;
+		x1 = index < getCount() - 1 ? wipes[index] : 1.0f;
+		y0 = 0.0f;
+		y1 = 1.0f;
+		return;
+	}
+
+	int columns, rows;
+	getGrid(columns, rows);
+	x0 = float(index % columns) / columns;
+	y0 = float(index / columns) / rows;
+	x1 = x0 + 1.0f / columns;
+	y1 = y0 + 1.0f / rows;
+}
+
+int ClutCompare::getResidentCount() const
+{
+	return static_cast<int>(std::count_if(locations.begin(), locations.end(), [](const ClutAtlasLocation& location) { return location.isValid(); }));
+}
+
+void ClutCompare::assign(int index, const CLUT& clut)
+{
+	ClutAtlasLocation location;
+	if (clut.is3DCLUT() && atlas != nullptr)
+	{
+		location = atlas->find(names[index]);
+		if (!location.isValid())
+		{
+			location = atlas->update(names[index], clut);
+		}
+	}
+
+	// The page must already be bound for another candidate or take a free stage
+	if (location.isValid())
+	{
+		uint16_t pages[kMaxCandidates];
+		int pageCount = 0;
+		bool bound = false;
+		for (int i = 0; i < getCount(); ++i)
+		{
+			if (i == index || !locations[i].isValid())
+				continue;
+
+			const uint16_t page = locations[i].texture.idx;
+			if (std::find(pages, pages + pageCount, page) == pages + pageCount)
+			{
+				pages[pageCount++] = page;
+			}
+			bound |= page == location.texture.idx;
+		}
+		if (!bound && pageCount >= kMaxPages)
+		{
+			location = {};
+		}
+	}
+
+	locations[index] = location;
+	if (location.isValid())
+	{
+		++revision;
+		return;
+	}
+
+	resample(index, clut);
+}
+
+void ClutCompare::resample(int index, const CLUT& clut)
+{
+	uint16_t* slot = &texels[size_t(index) * kSlotTexels * 4];
+	for (int b = 0; b < kGridSize; ++b)
+	{
+		for (int g = 0; g < kGridSize; ++g)
+		{
+			for (int r = 0; r < kGridSize; ++r)
+			{
+				const float color[3] = { r / float(kGridSize - 1), g / float(kGridSize - 1), b / float(kGridSize - 1) };
+				float graded[3];
+				clut.sample(color, graded);
+
+				uint16_t* texel = &slot[((b * kGridSize + g) * kGridSize + r) * 4];
+				texel[0] = bx::halfFromFloat(graded[0]);
+				texel[1] = bx::halfFromFloat(graded[1]);
+				texel[2] = bx::halfFromFloat(graded[2]);
+				texel[3] = bx::halfFromFloat(1.0f);
+			}
+		}
+	}
+
+	dirty = true;
+	++revision;
+}
+
+void ClutCompare::bind(uint8_t stage, uint8_t pageStage, bool enabled)
+{
+	if (dirty && !texels.empty())
+	{
+		const bgfx::Memory* mem = bgfx::copy(texels.data(), uint32_t(texels.size() * sizeof(uint16_t)));
+		bgfx::updateTexture3D(texture, 0, 0, 0, 0, uint16_t(kGridSize), uint16_t(kGridSize), uint16_t(kGridSize * getCount()), mem);
+	}
+	dirty = false;
+
+	int columns, rows;
+	getGrid(columns, rows);
+	const float params[4] = { enabled ? float(getCount()) : 0.0f, layout == Layout::Wipe ? 1.0f : 0.0f, float(columns), float(rows) };
+	bgfx::setUniform(paramsUniform, params);
+	bgfx::setUniform(wipesUniform, wipes, 2);
+	bgfx::setTexture(stage, sampler, texture);
+
+	// Per candidate: x = CLUT size (0 when resampled), y = slot offset, z = page depth, w = page index.
+	// Stages without a page get the candidate texture so every sampler the shader declares is bound.
+	float cluts[kMaxCandidates][4] = {};
+	bgfx::TextureHandle pages[kMaxPages] = { texture, texture, texture, texture };
+	int pageCount = 0;
+	for (int i = 0; i < getCount(); ++i)
+	{
+		const ClutAtlasLocation& location = locations[i];
+		if (!location.isValid())
+			continue;
+
+		int page = 0;
+		while (page < pageCount && pages[page].idx != location.texture.idx)
+		{
+			++page;
+		}
+		if (page == pageCount)
+		{
+			pages[pageCount++] = location.texture;
+		}
+
+		location.getParams(cluts[i]);
+		cluts[i][3] = float(page);
+	}
+
+	bgfx::setUniform(clutsUniform, cluts, kMaxCandidates);
+	for (int i = 0; i < kMaxPages; ++i)
+	{
+		bgfx::setTexture(uint8_t(pageStage + i), pageSamplers[i], pages[i]);
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ClutAtlas.h"
+
+class CLUT;
+
+// Candidate grades for side by side review, applied by the tonemap pass in a single draw.
+// 3D candidates are sampled where they already live in the ClutAtlas, each region reading its slot of one of
+// up to kMaxPages bound atlas pages. Only 1D candidates, and 3D ones the atlas cannot hold or whose page would
+// not fit the bound stages, are resampled into a slot of a shared 3D texture, uploaded when the set changes.
+class ClutCompare
+{
+public:
+	static constexpr int kMaxCandidates = 9;
+	static constexpr int kGridSize = 33; // Resampled CLUT resolution per axis
+	static constexpr int kMaxPages = 4;  // Atlas pages bound per draw, on consecutive stages
+
+	enum class Layout
+	{
+		Grid, // Tiles the viewport, filled row by row
+		Wipe  // Vertical strips between draggable wipe positions
+	};
+
+	ClutCompare() = default;
+	~ClutCompare();
+
+	// Create the candidate texture and uniforms; 3D candidates are kept resident in clutAtlas, which must outlive
+	// this. Returns false when they could not be created.
+	bool create(ClutAtlas& clutAtlas);
+
+	// Release all GPU resources and candidates
+	void destroy();
+
+	// Append a candidate; false when the set is full or it is already a candidate
+	bool add(const std::string& name, const CLUT& clut);
+
+	// Replace the CLUT of a candidate that is already in the set, if any; update the atlas first for 3D ones
+	void refresh(const std::string& name, const CLUT& clut);
+
+	void remove(int index);
+	void clear();
+
+	int getCount() const { return static_cast<int>(names.size()); }
+	const std::string& getName(int index) const { return names[index]; }
+	bool contains(const std::string& name) const;
+
+	void setLayout(Layout value);
+	Layout getLayout() const { return layout; }
+
+	// Wipe positions in [0, 1], one between each pair of neighbouring candidates, kept sorted
+	float getWipe(int index) const { return wipes[index]; }
+	void setWipe(int index, float position);
+	void resetWipes();
+
+	// Grid columns and rows for the current count
+	void getGrid(int& columns, int& rows) const;
+
+	// Region of a candidate in normalized viewport coordinates, origin top left
+	void getRegion(int index, float& x0, float& y0, float& x1, float& y1) const;
+
+	// Upload a changed set and bind the texture, the atlas pages from pageStage on and the uniforms for the
+	// next tonemap draw. When disabled the uniforms tell the shader to skip the comparison.
+	void bind(uint8_t stage, uint8_t pageStage, bool enabled);
+
+	// Candidates sampled from the atlas rather than resampled
+	int getResidentCount() const;
+
+	// Changes whenever the output of the comparison would, for render on demand
+	uint32_t getRevision() const { return revision; }
+
+private:
+	static constexpr int kSlotTexels = kGridSize * kGridSize * kGridSize;
+
+	// Point a candidate at its atlas slot, or resample it when it has none or its page would not be bound
+	void assign(int index, const CLUT& clut);
+	void resample(int index, const CLUT& clut);
+
+	ClutAtlas* atlas = nullptr;
+	std::vector<std::string> names;
+	std::vector<ClutAtlasLocation> locations; // Invalid for resampled candidates
+	std::vector<uint16_t> texels;             // RGBA16F, one slot per candidate, only filled for resampled ones
+	float wipes[kMaxCandidates - 1] = {};
+	Layout layout = Layout::Grid;
+	bool dirty = false;
+	uint32_t revision = 0;
+
+	bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle sampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle paramsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle wipesUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle clutsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle pageSamplers[kMaxPages] = { BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE };
+};
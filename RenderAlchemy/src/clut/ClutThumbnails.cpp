@@ -0,0 +1,172 @@
+#include "ClutThumbnails.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "../renderer/Geometry.h"
+#include "../renderer/Shader.h"
+#include "CLUT.h"
+
+namespace
+{
+	constexpr int kLutAtlasWidth = ClutThumbnails::kGridSize * ClutThumbnails::kGridSize * ClutThumbnails::kColumns;
+	constexpr int kAtlasWidth = ClutThumbnails::kThumbnailSize * ClutThumbnails::kColumns;
+
+	uint8_t toUnorm8(float value)
+	{
+		return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+	}
+} // namespace
+
+ClutThumbnails::~ClutThumbnails()
+{
+	destroy();
+}
+
+bool ClutThumbnails::create()
+{
+	destroy();
+
+	program = std::make_unique<Shader>("shaders/tonemap.vert.sc", "shaders/thumbnail.frag.sc");
+
+	const uint64_t flags = BGFX_SAMPLER_UVW_CLAMP;
+	lutAtlas = bgfx::createTexture2D(uint16_t(kLutAtlasWidth), uint16_t(kRows * kGridSize), false, 1, bgfx::TextureFormat::RGBA8, flags);
+	atlasFramebuffer = bgfx::createFrameBuffer(uint16_t(kAtlasWidth), uint16_t(kRows * kThumbnailSize), bgfx::TextureFormat::RGBA8, flags);
+
+	lutSampler = bgfx::createUniform("s_lutAtlas", bgfx::UniformType::Sampler);
+	thumbnailParamsUniform = bgfx::createUniform("u_thumbnailParams", bgfx::UniformType::Vec4);
+	lutAtlasParamsUniform = bgfx::createUniform("u_lutAtlasParams", bgfx::UniformType::Vec4);
+
+	if (!bgfx::isValid(program->m_program) || !bgfx::isValid(lutAtlas) || !bgfx::isValid(atlasFramebuffer))
+	{
+		std::cerr << "Failed to create CLUT thumbnail atlas" << std::endl;
+		destroy();
+		return false;
+	}
+
+	return true;
+}
+
+void ClutThumbnails::destroy()
+{
+	if (bgfx::isValid(lutAtlas))
+	{
+		bgfx::destroy(lutAtlas);
+		lutAtlas = BGFX_INVALID_HANDLE;
+	}
+
+	if (bgfx::isValid(atlasFramebuffer))
+	{
+		bgfx::destroy(atlasFramebuffer);
+		atlasFramebuffer = BGFX_INVALID_HANDLE;
+	}
+
+	bgfx::UniformHandle* uniforms[] = { &lutSampler, &thumbnailParamsUniform, &lutAtlasParamsUniform };
+	for (bgfx::UniformHandle* handle : uniforms)
+	{
+		if (bgfx::isValid(*handle))
+		{
+			bgfx::destroy(*handle);
+			*handle = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	program.reset();
+	slots.clear();
+	pendingSlots.clear();
+	pendingTexels.clear();
+}
+
+void ClutThumbnails::resample(const CLUT& clut, uint8_t* texels)
+{
+	const int rowPitch = kGridSize * kGridSize;
+	for (int b = 0; b < kGridSize; ++b)
+	{
+		for (int g = 0; g < kGridSize; ++g)
+		{
+			for (int r = 0; r < kGridSize; ++r)
+			{
+				const float color[3] = { r / float(kGridSize - 1), g / float(kGridSize - 1), b / float(kGridSize - 1) };
+				float graded[3];
+				clut.sample(color, graded);
+
+				uint8_t* texel = &texels[(g * rowPitch + b * kGridSize + r) * 4];
+				texel[0] = toUnorm8(graded[0]);
+				texel[1] = toUnorm8(graded[1]);
+				texel[2] = toUnorm8(graded[2]);
+				texel[3] = 255;
+			}
+		}
+	}
+}
+
+int ClutThumbnails::update(const std::string& name, const CLUT& clut)
+{
+	int slot = getSlot(name);
+	if (slot < 0)
+	{
+		if (slots.size() >= kMaxThumbnails)
+			return -1;
+
+		slot = static_cast<int>(slots.size());
+		slots.emplace(name, slot);
+	}
+
+	// A slot updated twice before the next render only uploads its latest data
+	size_t pending = std::find(pendingSlots.begin(), pendingSlots.end(), slot) - pendingSlots.begin();
+	if (pending == pendingSlots.size())
+	{
+		pendingSlots.push_back(slot);
+		pendingTexels.resize(pendingSlots.size() * kTileTexels * 4);
+	}
+
+	resample(clut, &pendingTexels[pending * kTileTexels * 4]);
+	return slot;
+}
+
+bool ClutThumbnails::render(bgfx::ViewId view, const Geometry& quad)
+{
+	if (pendingSlots.empty() || !bgfx::isValid(atlasFramebuffer))
+		return false;
+
+	for (size_t i = 0; i < pendingSlots.size(); ++i)
+	{
+		const int slot = pendingSlots[i];
+		const bgfx::Memory* mem = bgfx::copy(&pendingTexels[i * kTileTexels * 4], kTileTexels * 4);
+		bgfx::updateTexture2D(lutAtlas, 0, 0, uint16_t((slot % kColumns) * kGridSize * kGridSize), uint16_t((slot / kColumns) * kGridSize), uint16_t(kGridSize * kGridSize), uint16_t(kGridSize), mem);
+	}
+	pendingSlots.clear();
+	pendingTexels.clear();
+
+	// One draw regrades every thumbnail; the shader picks the tile and its CLUT from the pixel position
+	bgfx::setViewFrameBuffer(view, atlasFramebuffer);
+	bgfx::setViewRect(view, 0, 0, uint16_t(kAtlasWidth), uint16_t(kRows * kThumbnailSize));
+	bgfx::setViewClear(view, BGFX_CLEAR_NONE);
+
+	const float thumbnailParams[4] = { float(kThumbnailSize), float(kColumns), float(slots.size()), float(kGridSize) };
+	const float lutAtlasParams[4] = { float(kLutAtlasWidth), float(kRows * kGridSize), 0.0f, 0.0f };
+	bgfx::setUniform(thumbnailParamsUniform, thumbnailParams);
+	bgfx::setUniform(lutAtlasParamsUniform, lutAtlasParams);
+	bgfx::setTexture(0, lutSampler, lutAtlas);
+	quad.drawInView(view, program->m_program, BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
+
+	++redrawCount;
+	return true;
+}
+
+int ClutThumbnails::getSlot(const std::string& name) const
+{
+	auto it = slots.find(name);
+	return it != slots.end() ? it->second : -1;
+}
+
+void ClutThumbnails::getUv(int slot, float uv0[2], float uv1[2]) const
+{
+	const float width = 1.0f / kColumns;
+	const float height = 1.0f / kRows;
+	uv0[0] = (slot % kColumns) * width;
+	uv0[1] = (slot / kColumns) * height;
+	uv1[0] = uv0[0] + width;
+	uv1[1] = uv0[1] + height;
+}
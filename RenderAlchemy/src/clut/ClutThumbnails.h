@@ -0,0 +1,75 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CLUT;
+class Geometry;
+class Shader;
+
+// Thumbnails for the CLUT preset browser.
+// Every CLUT is resampled to a small 3D grid and packed into one 2D LUT atlas, its blue slices side by
+// side in a tile. A single draw over the thumbnail atlas then grades a procedural reference image with
+// every CLUT at once, one thumbnail tile per CLUT. CLUTs are only resampled and uploaded when they change,
+// and the atlas is only redrawn after an upload, so browsing the library costs nothing but the UI draws.
+class ClutThumbnails
+{
+public:
+	static constexpr int kGridSize = 16;      // Resampled CLUT resolution per axis
+	static constexpr int kThumbnailSize = 64; // Thumbnail side in pixels
+	static constexpr int kColumns = 16;       // Tiles per row, in both atlases
+	static constexpr int kMaxThumbnails = 512;
+
+	ClutThumbnails() = default;
+	~ClutThumbnails();
+
+	// Create the atlases and the grading program; returns false when they could not be created
+	bool create();
+
+	// Release all GPU resources
+	void destroy();
+
+	// Add a CLUT, or replace the one with the same name; returns its slot, -1 once the atlas is full
+	int update(const std::string& name, const CLUT& clut);
+
+	// Upload the CLUTs changed since the last call and regrade the thumbnails into view, using a
+	// full screen quad. Returns true when the atlas was redrawn.
+	bool render(bgfx::ViewId view, const Geometry& quad);
+
+	// True while updated CLUTs are waiting for render()
+	bool isDirty() const { return !pendingSlots.empty(); }
+
+	// Slot of a CLUT by name, -1 when it has none
+	int getSlot(const std::string& name) const;
+
+	// Thumbnail atlas and the texture coordinates of a slot within it
+	bgfx::TextureHandle getTexture() const { return bgfx::getTexture(atlasFramebuffer); }
+	void getUv(int slot, float uv0[2], float uv1[2]) const;
+
+	uint32_t getCount() const { return static_cast<uint32_t>(slots.size()); }
+	uint32_t getRedrawCount() const { return redrawCount; }
+
+private:
+	static constexpr int kRows = (kMaxThumbnails + kColumns - 1) / kColumns;
+	static constexpr int kTileTexels = kGridSize * kGridSize * kGridSize;
+
+	// Resample a CLUT into an RGBA8 LUT atlas tile, kGridSize slices of kGridSize squared texels
+	static void resample(const CLUT& clut, uint8_t* texels);
+
+	std::unordered_map<std::string, int> slots;
+	std::vector<int> pendingSlots;
+	std::vector<uint8_t> pendingTexels; // One tile per pending slot, in the same order
+
+	uint32_t redrawCount = 0;
+
+	std::unique_ptr<Shader> program;
+	bgfx::TextureHandle lutAtlas = BGFX_INVALID_HANDLE;
+	bgfx::FrameBufferHandle atlasFramebuffer = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle lutSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle thumbnailParamsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle lutAtlasParamsUniform = BGFX_INVALID_HANDLE;
+};
@@ -0,0 +1,388 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include <bx/allocator.h>
+#include <bx/bx.h>
+#include <imgui.h>
+
+#include "../meshoptimizer/meshoptimizer.h"
+
+namespace
+{
+	constexpr size_t kSubsystemCount = static_cast<size_t>(AllocationSubsystem::Count);
+
+	// Zero initialised static storage, so allocations made before main are counted too
+	std::atomic<uint32_t> allocationCounts[kSubsystemCount];
+	std::atomic<uint64_t> allocationBytes[kSubsystemCount];
+	std::atomic<uint32_t> freeCount;
+
+	thread_local AllocationSubsystem currentSubsystem = AllocationSubsystem::App;
+
+	// Frame bookkeeping, only touched by the main thread
+	AllocationStats lastFrame;
+	float history[AllocationTracker::kHistoryFrames] = {};
+	int historyOffset = 0;
+	int settledFrames = 0;
+	uint32_t cleanFrames = 0;
+	uint32_t violations = 0;
+	bool zeroAllocationMode = false;
+
+	void charge(AllocationSubsystem subsystem, size_t bytes)
+	{
+		const size_t index = static_cast<size_t>(subsystem);
+		allocationCounts[index].fetch_add(1, std::memory_order_relaxed);
+		allocationBytes[index].fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	void countFree(void* ptr)
+	{
+		if (ptr != nullptr)
+		{
+			freeCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	AllocationStats takeCounters()
+	{
+		AllocationStats stats;
+		for (size_t i = 0; i < kSubsystemCount; ++i)
+		{
+			stats.count[i] = allocationCounts[i].exchange(0, std::memory_order_relaxed);
+			stats.bytes[i] = allocationBytes[i].exchange(0, std::memory_order_relaxed);
+		}
+		stats.frees = freeCount.exchange(0, std::memory_order_relaxed);
+		return stats;
+	}
+
+	void* allocate(size_t size)
+	{
+		charge(currentSubsystem, size);
+		return std::malloc(size != 0 ? size : 1);
+	}
+
+	void* allocateAligned(size_t size, std::align_val_t alignment)
+	{
+		charge(currentSubsystem, size);
+		const size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+		return _aligned_malloc(size != 0 ? size : 1, align);
+#else
+		// aligned_alloc wants a multiple of the alignment
+		return std::aligned_alloc(align, (size + align - 1) / align * align + (size == 0 ? align : 0));
+#endif
+	}
+
+	void releaseAligned(void* ptr)
+	{
+		countFree(ptr);
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+
+	// bgfx and bimg allocate through the default bx allocator, counted on the way
+	class TrackingAllocator : public bx::DefaultAllocator
+	{
+	public:
+		void* realloc(void* ptr, size_t size, size_t align, const char* filePath, uint32_t line) override
+		{
+			if (size == 0)
+			{
+				countFree(ptr);
+			}
+			else
+			{
+				charge(AllocationSubsystem::Bgfx, size);
+			}
+			return bx::DefaultAllocator::realloc(ptr, size, align, filePath, line);
+		}
+	};
+
+	TrackingAllocator bgfxAllocator;
+
+	void* MESHOPTIMIZER_ALLOC_CALLCONV meshoptAllocate(size_t size)
+	{
+		charge(AllocationSubsystem::Meshopt, size);
+		return std::malloc(size);
+	}
+
+	void MESHOPTIMIZER_ALLOC_CALLCONV meshoptDeallocate(void* ptr)
+	{
+		countFree(ptr);
+		std::free(ptr);
+	}
+
+	void* imguiAllocate(size_t size, void*)
+	{
+		charge(AllocationSubsystem::Ui, size);
+		return std::malloc(size);
+	}
+
+	void imguiFree(void* ptr, void*)
+	{
+		countFree(ptr);
+		std::free(ptr);
+	}
+} // namespace
+
+uint32_t AllocationStats::getTotalCount() const
+{
+	uint32_t total = 0;
+	for (uint32_t value : count)
+	{
+		total += value;
+	}
+	return total;
+}
+
+uint64_t AllocationStats::getTotalBytes() const
+{
+	uint64_t total = 0;
+	for (uint64_t value : bytes)
+	{
+		total += value;
+	}
+	return total;
+}
+
+void AllocationTracker::install()
+{
+	meshopt_setAllocator(meshoptAllocate, meshoptDeallocate);
+	ImGui::SetAllocatorFunctions(imguiAllocate, imguiFree);
+}
+
+bx::AllocatorI* AllocationTracker::getBgfxAllocator()
+{
+	return &bgfxAllocator;
+}
+
+AllocationSubsystem AllocationTracker::setSubsystem(AllocationSubsystem subsystem)
+{
+	const AllocationSubsystem previous = currentSubsystem;
+	currentSubsystem = subsystem;
+	return previous;
+}
+
+void AllocationTracker::endFrame(bool steady)
+{
+	lastFrame = takeCounters();
+	const uint32_t total = lastFrame.getTotalCount();
+	history[historyOffset] = static_cast<float>(total);
+	historyOffset = (historyOffset + 1) % kHistoryFrames;
+
+	settledFrames = steady ? settledFrames + 1 : 0;
+	if (settledFrames <= kSettleFrames)
+	{
+		cleanFrames = 0;
+		return;
+	}
+
+	if (total == 0)
+	{
+		++cleanFrames;
+		return;
+	}
+
+	cleanFrames = 0;
+	++violations;
+	if (!zeroAllocationMode)
+		return;
+
+	std::cerr << "Steady frame allocated " << total << " times, " << lastFrame.getTotalBytes() << " bytes:";
+	for (size_t i = 0; i < kSubsystemCount; ++i)
+	{
+		if (lastFrame.count[i] > 0)
+		{
+			std::cerr << " " << getSubsystemName(static_cast<AllocationSubsystem>(i)) << " " << lastFrame.count[i] << " (" << lastFrame.bytes[i] << " bytes)";
+		}
+	}
+	std::cerr << std::endl;
+
+	// The report may allocate itself; that should not count against the next frame
+	takeCounters();
+	BX_ASSERT(false, "Steady frame allocated %u times", total);
+}
+
+void AllocationTracker::setZeroAllocationMode(bool enabled)
+{
+	zeroAllocationMode = enabled;
+}
+
+bool AllocationTracker::isZeroAllocationMode()
+{
+	return zeroAllocationMode;
+}
+
+const AllocationStats& AllocationTracker::getLastFrame()
+{
+	return lastFrame;
+}
+
+const float* AllocationTracker::getHistory()
+{
+	return history;
+}
+
+int AllocationTracker::getHistoryOffset()
+{
+	return historyOffset;
+}
+
+uint32_t AllocationTracker::getCleanFrameCount()
+{
+	return cleanFrames;
+}
+
+uint32_t AllocationTracker::getViolationCount()
+{
+	return violations;
+}
+
+const char* AllocationTracker::getSubsystemName(AllocationSubsystem subsystem)
+{
+	switch (subsystem)
+	{
+	case AllocationSubsystem::App:
+		return "App";
+	case AllocationSubsystem::Scene:
+		return "Scene";
+	case AllocationSubsystem::Post:
+		return "Post";
+	case AllocationSubsystem::Ui:
+		return "UI";
+	case AllocationSubsystem::Clut:
+		return "CLUT";
+	case AllocationSubsystem::Bgfx:
+		return "bgfx";
+	case AllocationSubsystem::Meshopt:
+		return "meshopt";
+	default:
+		return "Unknown";
+	}
+}
+
+// Global allocation functions; every other form of new and delete forwards to these in the standard library,
+// but replacing them all keeps the behaviour the same across standard library implementations
+void* operator new(size_t size)
+{
+	if (void* ptr = allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (void* ptr = allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* ptr = allocateAligned(size, alignment))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	if (void* ptr = allocateAligned(size, alignment))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	countFree(ptr);
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	countFree(ptr);
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	countFree(ptr);
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	countFree(ptr);
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	countFree(ptr);
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	countFree(ptr);
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	releaseAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	releaseAligned(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+	releaseAligned(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+	releaseAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	releaseAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	releaseAligned(ptr);
+}
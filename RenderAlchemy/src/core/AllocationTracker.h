@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bx
+{
+	struct AllocatorI;
+}
+
+// What an allocation is charged to
+enum class AllocationSubsystem : uint8_t
+{
+	App,     // Anything outside the scopes below, including job worker threads
+	Scene,   // Scene pass: culling, LOD selection and submission
+	Post,    // Exposure, tone mapping, scopes, export and present
+	Ui,      // Interface code and ImGui itself
+	Clut,    // CLUT selection, loading and editing
+	Bgfx,    // bgfx and bimg, through the allocator given to bgfx::Init
+	Meshopt, // meshoptimizer scratch memory
+	Count
+};
+
+// Allocations of one frame, per subsystem
+struct AllocationStats
+{
+	uint32_t count[static_cast<size_t>(AllocationSubsystem::Count)] = {};
+	uint64_t bytes[static_cast<size_t>(AllocationSubsystem::Count)] = {};
+	uint32_t frees = 0;
+
+	uint32_t getTotalCount() const;
+	uint64_t getTotalBytes() const;
+};
+
+// Counts heap allocations per frame and per subsystem. The global operator new and delete are replaced, and
+// bgfx, meshoptimizer and ImGui allocate through hooks, so nothing reaches the heap unseen except plain malloc.
+// operator new charges the subsystem of the innermost AllocationScope on the allocating thread.
+// A frame the caller reports as steady, one with the same inputs as the last whether it renders again, only
+// presents cached results or is skipped while idle, should not allocate at all; once a few steady frames in a row have passed, one that still allocates is
+// counted, and in zero allocation mode also reported with its breakdown and asserted on in debug builds.
+namespace AllocationTracker
+{
+	constexpr int kHistoryFrames = 120;
+	constexpr int kSettleFrames = 8; // Steady frames before allocations count against one, e.g. for lazily grown buffers
+
+	// Route meshoptimizer and ImGui allocations through the tracker; call before either is used
+	void install();
+
+	// Allocator for bgfx::Init
+	bx::AllocatorI* getBgfxAllocator();
+
+	// Charge operator new on this thread to subsystem from now on; returns the previous one
+	AllocationSubsystem setSubsystem(AllocationSubsystem subsystem);
+
+	// Close the frame on the main thread; its counters become getLastFrame() and restart from zero
+	void endFrame(bool steady);
+
+	void setZeroAllocationMode(bool enabled);
+	bool isZeroAllocationMode();
+
+	const AllocationStats& getLastFrame();
+
+	// Allocation counts of the last kHistoryFrames frames, oldest at getHistoryOffset()
+	const float* getHistory();
+	int getHistoryOffset();
+
+	// Settled steady frames in a row without an allocation
+	uint32_t getCleanFrameCount();
+
+	// Settled steady frames that allocated
+	uint32_t getViolationCount();
+
+	const char* getSubsystemName(AllocationSubsystem subsystem);
+} // namespace AllocationTracker
+
+// Charges allocations on this thread to a subsystem until it goes out of scope
+class AllocationScope
+{
+public:
+	explicit AllocationScope(AllocationSubsystem subsystem)
+	      : previous(AllocationTracker::setSubsystem(subsystem))
+	{
+	}
+
+	~AllocationScope() { AllocationTracker::setSubsystem(previous); }
+
+	AllocationScope(const AllocationScope&) = delete;
+	AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+	AllocationSubsystem previous;
+};
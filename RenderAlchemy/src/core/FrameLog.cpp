@@ -0,0 +1,249 @@
+#include "FrameLog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+	constexpr uint8_t kFrameTag = 'F';
+	constexpr uint8_t kClutTag = 'C';
+
+	// Longest run of unchanged or changed bytes in one pair
+	constexpr size_t kMaxRun = 255;
+
+	float percentile(std::vector<float> values, float fraction)
+	{
+		if (values.empty())
+			return 0.0f;
+
+		const size_t index = std::min(static_cast<size_t>(fraction * values.size()), values.size() - 1);
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+
+	float mean(const std::vector<float>& values)
+	{
+		return values.empty() ? 0.0f : std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+	}
+} // namespace
+
+bool FrameRecorder::start(const std::string& path)
+{
+	stop();
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Failed to create frame log " << path << std::endl;
+		return false;
+	}
+
+	// The first frame is encoded against zeroed inputs
+	previous = FrameInputs();
+	previousClut.clear();
+	frameCount = 0;
+	byteCount = 0;
+
+	const uint32_t header[3] = { FrameLog::kMagic, FrameLog::kVersion, static_cast<uint32_t>(sizeof(FrameInputs)) };
+	write(header, sizeof(header));
+	return true;
+}
+
+void FrameRecorder::record(const FrameInputs& inputs, const std::string& clutName)
+{
+	if (!isRecording())
+		return;
+
+	encoded.clear();
+	if (clutName != previousClut || frameCount == 0)
+	{
+		const uint16_t length = static_cast<uint16_t>(std::min<size_t>(clutName.size(), UINT16_MAX));
+		encoded.push_back(kClutTag);
+		encoded.push_back(static_cast<uint8_t>(length & 0xff));
+		encoded.push_back(static_cast<uint8_t>(length >> 8));
+		encoded.insert(encoded.end(), clutName.begin(), clutName.begin() + length);
+		previousClut = clutName;
+	}
+
+	// Pairs of (unchanged, changed) run lengths, each followed by the changed bytes XOR the previous frame.
+	// A (0, 0) pair ends the frame early when the remaining bytes did not change.
+	const uint8_t* current = reinterpret_cast<const uint8_t*>(&inputs);
+	const uint8_t* before = reinterpret_cast<const uint8_t*>(&previous);
+	const size_t size = sizeof(FrameInputs);
+	encoded.push_back(kFrameTag);
+	size_t i = 0;
+	while (i < size)
+	{
+		size_t unchanged = 0;
+		while (i + unchanged < size && unchanged < kMaxRun && current[i + unchanged] == before[i + unchanged])
+		{
+			++unchanged;
+		}
+
+		if (i + unchanged == size)
+		{
+			encoded.push_back(0);
+			encoded.push_back(0);
+			break;
+		}
+
+		const size_t start = i + unchanged;
+		size_t changed = 0;
+		while (start + changed < size && changed < kMaxRun && current[start + changed] != before[start + changed])
+		{
+			++changed;
+		}
+
+		encoded.push_back(static_cast<uint8_t>(unchanged));
+		encoded.push_back(static_cast<uint8_t>(changed));
+		for (size_t k = start; k < start + changed; ++k)
+		{
+			encoded.push_back(current[k] ^ before[k]);
+		}
+		i = start + changed;
+	}
+
+	write(encoded.data(), encoded.size());
+	std::memcpy(&previous, &inputs, sizeof(FrameInputs));
+	++frameCount;
+}
+
+void FrameRecorder::stop()
+{
+	if (file.is_open())
+	{
+		file.close();
+	}
+}
+
+void FrameRecorder::write(const void* data, size_t size)
+{
+	file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+	byteCount += size;
+}
+
+bool FrameReplay::open(const std::string& path)
+{
+	close();
+
+	file.open(path, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "Failed to open frame log " << path << std::endl;
+		return false;
+	}
+
+	uint32_t header[3] = {};
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!file || header[0] != FrameLog::kMagic || header[1] != FrameLog::kVersion || header[2] != sizeof(FrameInputs))
+	{
+		std::cerr << "Frame log " << path << " was written by an incompatible build" << std::endl;
+		close();
+		return false;
+	}
+
+	current = FrameInputs();
+	currentClut.clear();
+	frameIndex = 0;
+	return true;
+}
+
+bool FrameReplay::next(FrameInputs& inputs, std::string& clutName)
+{
+	if (!isOpen())
+		return false;
+
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(&current);
+	const size_t size = sizeof(FrameInputs);
+	for (;;)
+	{
+		const int tag = file.get();
+		if (tag == kClutTag)
+		{
+			uint8_t length[2] = {};
+			file.read(reinterpret_cast<char*>(length), 2);
+			currentClut.resize(length[0] | (length[1] << 8));
+			file.read(currentClut.data(), static_cast<std::streamsize>(currentClut.size()));
+			continue;
+		}
+
+		if (tag != kFrameTag)
+			return false;
+
+		size_t i = 0;
+		while (i < size)
+		{
+			uint8_t runs[2] = {};
+			if (!file.read(reinterpret_cast<char*>(runs), 2))
+				return false;
+
+			if (runs[0] == 0 && runs[1] == 0)
+				break;
+
+			i += runs[0];
+			if (i + runs[1] > size)
+				return false;
+
+			for (size_t k = i; k < i + runs[1]; ++k)
+			{
+				bytes[k] ^= static_cast<uint8_t>(file.get());
+			}
+			i += runs[1];
+		}
+
+		if (!file)
+			return false;
+
+		inputs = current;
+		clutName = currentClut;
+		++frameIndex;
+		return true;
+	}
+}
+
+void FrameReplay::close()
+{
+	if (file.is_open())
+	{
+		file.close();
+	}
+}
+
+bool FrameTimingLog::open(const std::string& path)
+{
+	close();
+
+	file.open(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Failed to create timing log " << path << std::endl;
+		return false;
+	}
+
+	filePath = path;
+	cpuTimes.clear();
+	gpuTimes.clear();
+	file << "frame,cpu_ms,gpu_ms,scene_gpu_ms,post_gpu_ms,wait_render_ms\n";
+	return true;
+}
+
+void FrameTimingLog::write(uint32_t frame, float cpuMs, float gpuMs, float sceneGpuMs, float postGpuMs, float waitRenderMs)
+{
+	if (!isOpen())
+		return;
+
+	file << frame << ',' << cpuMs << ',' << gpuMs << ',' << sceneGpuMs << ',' << postGpuMs << ',' << waitRenderMs << '\n';
+	cpuTimes.push_back(cpuMs);
+	gpuTimes.push_back(gpuMs);
+}
+
+void FrameTimingLog::close()
+{
+	if (!file.is_open())
+		return;
+
+	file.close();
+	std::cout << "Replay timings written to " << filePath << ": " << cpuTimes.size() << " frames, CPU mean " << mean(cpuTimes) << " ms, p95 " << percentile(cpuTimes, 0.95f) << " ms, GPU mean " << mean(gpuTimes) << " ms, p95 " << percentile(gpuTimes, 0.95f) << " ms" << std::endl;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Everything that decides what a frame renders, captured at the same point of every frame.
+// Fields are all four bytes wide so the layout has no padding and frames can be compared bytewise;
+// bump FrameLog::kVersion whenever a field is added, removed or changes meaning.
+struct FrameInputs
+{
+	int32_t windowWidth = 0;
+	int32_t windowHeight = 0;
+
+	float cameraPos[3] = {};
+	float modelRotation[3] = {};
+	float lightPos[3] = {};
+	float lightColor[3] = {};
+	float lightIntensity = 0.0f;
+	float ambientStrength = 0.0f;
+	int32_t sceneType = 0;
+
+	float exposure = 0.0f;
+	float clutStrength = 0.0f;
+	int32_t tonemapOperator = 0;
+	float splitPosition = 0.0f;
+
+	float lodPixelThreshold = 0.0f;
+	int32_t instancePlacement = 0;
+	int32_t instanceCount = 0;
+	float instanceSpacing = 0.0f;
+	float instanceScale = 0.0f;
+	uint32_t instanceSeed = 0;
+	int32_t submitThreads = 0;
+	int32_t maxOccluders = 0;
+	int32_t depthPrepassMode = 0;
+	int32_t stressLightPreset = 0;
+	float stressLightRadius = 0.0f;
+	int32_t hdrTier = 0;
+	float resolutionTargetMs = 0.0f;
+
+	uint32_t toggles = 0; // FrameToggle bits
+};
+
+static_assert(std::is_trivially_copyable_v<FrameInputs> && sizeof(FrameInputs) % 4 == 0, "FrameInputs is logged bytewise");
+
+// UI toggles packed into FrameInputs::toggles
+enum FrameToggle : uint32_t
+{
+	kToggleApplyClut = 1u << 0,
+	kToggleUse3DClut = 1u << 1,
+	kToggleSplitScreen = 1u << 2,
+	kToggleWireframe = 1u << 3,
+	kToggleLod = 1u << 4,
+	kToggleMeshlets = 1u << 5,
+	kToggleInstancing = 1u << 6,
+	kTogglePerDrawSubmission = 1u << 7,
+	kToggleOcclusionCulling = 1u << 8,
+	kToggleGpuDriven = 1u << 9,
+	kToggleGpuOcclusionCulling = 1u << 10,
+	kToggleAutoExposure = 1u << 11,
+	kToggleComputeTonemap = 1u << 12,
+	kToggleDynamicResolution = 1u << 13,
+	kToggleJobsSingleThreaded = 1u << 14
+};
+
+// Binary log of FrameInputs. After a short header every frame is stored as the XOR against the frame before
+// it, written as alternating runs of unchanged and changed bytes, so a frame where nothing moved takes three
+// bytes and a moving camera a few dozen. The name of the current CLUT is written whenever it changes.
+namespace FrameLog
+{
+	constexpr uint32_t kMagic = 0x474c4152; // "RALG"
+	constexpr uint32_t kVersion = 1;
+} // namespace FrameLog
+
+// Writes a log, one record per frame
+class FrameRecorder
+{
+public:
+	// Create the log at path; returns false when it cannot be written
+	bool start(const std::string& path);
+
+	// Append the inputs of a frame and the CLUT it grades with
+	void record(const FrameInputs& inputs, const std::string& clutName);
+
+	// Flush and close the log
+	void stop();
+
+	bool isRecording() const { return file.is_open(); }
+	uint32_t getFrameCount() const { return frameCount; }
+	uint64_t getByteCount() const { return byteCount; }
+
+private:
+	void write(const void* data, size_t size);
+
+	std::ofstream file;
+	FrameInputs previous;
+	std::string previousClut;
+	std::vector<uint8_t> encoded;
+	uint32_t frameCount = 0;
+	uint64_t byteCount = 0;
+};
+
+// Reads a log back frame by frame
+class FrameReplay
+{
+public:
+	// Open the log at path; returns false when it is missing or written by an incompatible build
+	bool open(const std::string& path);
+
+	// Decode the next frame; returns false at the end of the log, or on a damaged record
+	bool next(FrameInputs& inputs, std::string& clutName);
+
+	void close();
+
+	bool isOpen() const { return file.is_open(); }
+	uint32_t getFrameIndex() const { return frameIndex; }
+
+private:
+	std::ifstream file;
+	FrameInputs current;
+	std::string currentClut;
+	uint32_t frameIndex = 0;
+};
+
+// Per frame timings of a replay as CSV, with a summary once closed
+class FrameTimingLog
+{
+public:
+	// Create the CSV at path; returns false when it cannot be written
+	bool open(const std::string& path);
+
+	void write(uint32_t frame, float cpuMs, float gpuMs, float sceneGpuMs, float postGpuMs, float waitRenderMs);
+
+	// Close the CSV and print the mean and 95th percentile of the CPU and GPU times
+	void close();
+
+	bool isOpen() const { return file.is_open(); }
+
+private:
+	std::ofstream file;
+	std::string filePath;
+	std::vector<float> cpuTimes;
+	std::vector<float> gpuTimes;
+};
@@ -0,0 +1,590 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace JobSystem
+{
+	// A queued job: either a function or one chunk of a parallelFor
+	struct Job
+	{
+		std::function<void()> function;
+		const std::function<void(uint32_t, uint32_t)>* range = nullptr;
+		uint32_t first = 0;
+		uint32_t last = 0;
+		JobCounter* counter = nullptr;
+		Job* next = nullptr; // Free list or continuation list link
+	};
+
+	namespace
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		// Jobs are recycled through a free list so steady frames don't allocate; it grows a block at a time
+		// and is only released at exit
+		constexpr size_t kJobBlockSize = 256;
+
+		std::mutex jobPoolMutex;
+		Job* freeJobs = nullptr;
+		std::vector<std::unique_ptr<Job[]>> jobBlocks;
+
+		Job* allocateJob()
+		{
+			std::lock_guard<std::mutex> lock(jobPoolMutex);
+			if (!freeJobs)
+			{
+				jobBlocks.push_back(std::make_unique<Job[]>(kJobBlockSize));
+				Job* block = jobBlocks.back().get();
+				for (size_t i = 0; i < kJobBlockSize; ++i)
+				{
+					block[i].next = i + 1 < kJobBlockSize ? &block[i + 1] : nullptr;
+				}
+				freeJobs = block;
+			}
+
+			Job* job = freeJobs;
+			freeJobs = job->next;
+			job->next = nullptr;
+			return job;
+		}
+
+		void freeJob(Job* job)
+		{
+			// Destroy the captures outside the lock, they may run arbitrary code
+			job->function = nullptr;
+			job->range = nullptr;
+			job->counter = nullptr;
+
+			std::lock_guard<std::mutex> lock(jobPoolMutex);
+			job->next = freeJobs;
+			freeJobs = job;
+		}
+
+		// Chase-Lev deque with a fixed capacity. The owning worker pushes and pops at the bottom,
+		// any other thread steals from the top; only the last element is contended.
+		class WorkStealingDeque
+		{
+		public:
+			static constexpr int64_t kCapacity = 4096;
+
+			// Owner only; returns false when full
+			bool push(Job* job)
+			{
+				const int64_t b = bottom.load(std::memory_order_relaxed);
+				const int64_t t = top.load(std::memory_order_acquire);
+				if (b - t >= kCapacity)
+					return false;
+
+				slots[b & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return true;
+			}
+
+			// Owner only; takes the most recently pushed job
+			Job* pop()
+			{
+				const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+				bottom.store(b, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t t = top.load(std::memory_order_relaxed);
+
+				if (t > b)
+				{
+					bottom.store(b + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				Job* job = slots[b & (kCapacity - 1)].load(std::memory_order_relaxed);
+				if (t == b)
+				{
+					// Last job, race any thief for it
+					if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					{
+						job = nullptr;
+					}
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+				return job;
+			}
+
+			// Any thread; takes the oldest job
+			Job* steal()
+			{
+				int64_t t = top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t b = bottom.load(std::memory_order_acquire);
+				if (t >= b)
+					return nullptr;
+
+				Job* job = slots[t & (kCapacity - 1)].load(std::memory_order_relaxed);
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+
+				return job;
+			}
+
+		private:
+			alignas(64) std::atomic<int64_t> top{ 0 };
+			alignas(64) std::atomic<int64_t> bottom{ 0 };
+			std::atomic<Job*> slots[kCapacity] = {};
+		};
+
+		struct Worker
+		{
+			WorkStealingDeque queue;
+			std::thread thread;
+
+			std::atomic<uint32_t> jobs{ 0 };
+			std::atomic<uint32_t> steals{ 0 };
+			std::atomic<uint64_t> busyNs{ 0 };
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::atomic<bool> running{ false };
+		std::atomic<bool> singleThreaded{ false };
+
+		// Jobs pushed but not yet taken; idle workers sleep while this is zero
+		std::atomic<int32_t> queuedJobs{ 0 };
+		std::mutex sleepMutex;
+		std::condition_variable wakeCondition;
+
+		// Jobs submitted from threads that are not workers
+		std::mutex injectionMutex;
+		std::deque<Job*> injectionQueue;
+
+		std::mutex mainThreadMutex;
+		std::vector<std::function<void()>> mainThreadQueue;
+		std::vector<std::function<void()>> mainThreadRunning;
+
+		Clock::time_point sampleStart;
+
+		// Worker index of the current thread, -1 for threads outside the pool
+		thread_local int workerIndex = -1;
+
+		void wakeWorkers(int count)
+		{
+			queuedJobs.fetch_add(count, std::memory_order_release);
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			if (count == 1)
+			{
+				wakeCondition.notify_one();
+			}
+			else
+			{
+				wakeCondition.notify_all();
+			}
+		}
+
+		// Jobs running on this thread; a job started while another waits only adds to the count, not busy time
+		thread_local int jobDepth = 0;
+
+		void recordJob(int index, Clock::time_point start)
+		{
+			if (index < 0 || index >= static_cast<int>(workers.size()))
+				return;
+
+			Worker& worker = *workers[index];
+			worker.jobs.fetch_add(1, std::memory_order_relaxed);
+			if (jobDepth == 0)
+			{
+				worker.busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(), std::memory_order_relaxed);
+			}
+		}
+
+		void runInline(std::function<void()>& function, JobCounter* counter)
+		{
+			const Clock::time_point start = Clock::now();
+			++jobDepth;
+			function();
+			--jobDepth;
+			recordJob(workerIndex, start);
+
+			if (counter)
+			{
+				counter->release();
+			}
+		}
+
+		void execute(Job* job, int index)
+		{
+			const Clock::time_point start = Clock::now();
+			++jobDepth;
+			if (job->range)
+			{
+				(*job->range)(job->first, job->last);
+			}
+			else
+			{
+				job->function();
+			}
+			--jobDepth;
+			recordJob(index, start);
+
+			// The counter may live in state the job owns (see JobSystem::async), so release it before recycling
+			// the job; after that only the job itself is touched, a waiter may destroy the counter once done
+			if (job->counter)
+			{
+				job->counter->release();
+			}
+			freeJob(job);
+		}
+
+		Job* findJob(int index)
+		{
+			Job* job = nullptr;
+
+			if (index >= 0)
+			{
+				job = workers[index]->queue.pop();
+			}
+
+			if (!job)
+			{
+				std::lock_guard<std::mutex> lock(injectionMutex);
+				if (!injectionQueue.empty())
+				{
+					job = injectionQueue.front();
+					injectionQueue.pop_front();
+				}
+			}
+
+			// Steal from the other workers, starting after our own index to spread thieves out
+			const int count = static_cast<int>(workers.size());
+			for (int i = 1; !job && i <= count; ++i)
+			{
+				const int victim = (std::max(index, 0) + i) % count;
+				if (victim == index)
+					continue;
+
+				job = workers[victim]->queue.steal();
+				if (job && index >= 0)
+				{
+					workers[index]->steals.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			if (job)
+			{
+				queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+			}
+			return job;
+		}
+
+		void workerLoop(int index)
+		{
+			workerIndex = index;
+
+			while (running.load(std::memory_order_acquire))
+			{
+				if (Job* job = findJob(index))
+				{
+					execute(job, index);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				wakeCondition.wait(lock, []() { return queuedJobs.load(std::memory_order_acquire) > 0 || !running.load(std::memory_order_acquire); });
+			}
+		}
+
+		void submit(Job* job)
+		{
+			if (workerIndex >= 0 && workers[workerIndex]->queue.push(job))
+			{
+				wakeWorkers(1);
+				return;
+			}
+
+			if (workerIndex < 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(injectionMutex);
+					injectionQueue.push_back(job);
+				}
+				wakeWorkers(1);
+				return;
+			}
+
+			// Our deque is full, run the job now rather than grow
+			execute(job, workerIndex);
+		}
+
+		// Queue a job, or run it now when there are no workers to take it
+		void dispatch(Job* job)
+		{
+			if (!running || singleThreaded)
+			{
+				execute(job, workerIndex);
+				return;
+			}
+
+			submit(job);
+		}
+	} // namespace
+
+	void init(int workerCount, bool startSingleThreaded)
+	{
+		if (running)
+			return;
+
+		if (workerCount <= 0)
+		{
+			workerCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+		}
+
+		singleThreaded = startSingleThreaded;
+		queuedJobs = 0;
+
+		workers.clear();
+		for (int i = 0; i < workerCount; ++i)
+		{
+			workers.push_back(std::make_unique<Worker>());
+		}
+
+		// The calling thread is worker 0 and executes jobs whenever it waits
+		workerIndex = 0;
+		running = true;
+		for (int i = 1; i < workerCount; ++i)
+		{
+			workers[i]->thread = std::thread(workerLoop, i);
+		}
+
+		sampleStart = Clock::now();
+		std::cout << "Job system started with " << workerCount << " threads" << std::endl;
+	}
+
+	void shutdown()
+	{
+		if (!running)
+			return;
+
+		// Drain what is left so no counter or future is left waiting forever
+		while (Job* job = findJob(workerIndex))
+		{
+			execute(job, workerIndex);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			running = false;
+		}
+		wakeCondition.notify_all();
+
+		for (size_t i = 1; i < workers.size(); ++i)
+		{
+			workers[i]->thread.join();
+		}
+
+		// A worker may still have been finishing a job that queued another
+		while (Job* job = findJob(workerIndex))
+		{
+			execute(job, workerIndex);
+		}
+
+		workers.clear();
+		workerIndex = -1;
+
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		mainThreadQueue.clear();
+	}
+
+	void setSingleThreaded(bool enabled)
+	{
+		singleThreaded = enabled;
+	}
+
+	bool isSingleThreaded()
+	{
+		return singleThreaded;
+	}
+
+	int getThreadCount()
+	{
+		return running && !singleThreaded ? static_cast<int>(workers.size()) : 1;
+	}
+
+	void run(std::function<void()> job, JobCounter* counter)
+	{
+		if (counter)
+		{
+			counter->add();
+		}
+
+		if (!running || singleThreaded)
+		{
+			runInline(job, counter);
+			return;
+		}
+
+		Job* entry = allocateJob();
+		entry->function = std::move(job);
+		entry->counter = counter;
+		submit(entry);
+	}
+
+	void runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter)
+	{
+		if (counter)
+		{
+			counter->add();
+		}
+
+		Job* entry = allocateJob();
+		entry->function = std::move(job);
+		entry->counter = counter;
+
+		{
+			// Park the job on the dependency while it has unfinished jobs; a round that already finished, or is
+			// being released, has nothing left to wait for
+			std::lock_guard<std::mutex> lock(dependency.continuationMutex);
+			if ((dependency.pending.load(std::memory_order_acquire) & ~JobCounter::kFinishing) != 0)
+			{
+				entry->next = dependency.continuations;
+				dependency.continuations = entry;
+				return;
+			}
+		}
+
+		dispatch(entry);
+	}
+
+	void wait(JobCounter& counter)
+	{
+		while (!counter.isDone())
+		{
+			if (Job* job = findJob(workerIndex))
+			{
+				execute(job, workerIndex);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t)>& body, uint32_t grain)
+	{
+		if (begin >= end)
+			return;
+
+		const uint32_t count = end - begin;
+		const uint32_t threads = static_cast<uint32_t>(getThreadCount());
+		if (grain == 0)
+		{
+			grain = std::max(1u, count / (threads * 4));
+		}
+
+		if (threads == 1 || count <= grain)
+		{
+			body(begin, end);
+			return;
+		}
+
+		// Queue every chunk but the first, which the caller takes before helping with the rest. Chunks point
+		// at body rather than wrapping it, so queuing them doesn't allocate.
+		JobCounter counter;
+		for (uint32_t first = begin + grain; first < end; first += grain)
+		{
+			Job* job = allocateJob();
+			job->range = &body;
+			job->first = first;
+			job->last = std::min(first + grain, end);
+			job->counter = &counter;
+			counter.add();
+			submit(job);
+		}
+
+		body(begin, begin + grain);
+		wait(counter);
+	}
+
+	void runOnMainThread(std::function<void()> continuation)
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		mainThreadQueue.push_back(std::move(continuation));
+	}
+
+	void pumpMainThread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mainThreadMutex);
+			mainThreadRunning.swap(mainThreadQueue);
+		}
+
+		// Continuations queued while these run wait for the next frame
+		for (std::function<void()>& continuation : mainThreadRunning)
+		{
+			continuation();
+		}
+		mainThreadRunning.clear();
+	}
+
+	void sampleStats(std::vector<JobWorkerStats>& stats)
+	{
+		const Clock::time_point now = Clock::now();
+		const float wallMs = std::chrono::duration<float, std::milli>(now - sampleStart).count();
+		sampleStart = now;
+
+		stats.resize(workers.size());
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			Worker& worker = *workers[i];
+			JobWorkerStats& entry = stats[i];
+			entry.jobs = worker.jobs.exchange(0, std::memory_order_relaxed);
+			entry.steals = worker.steals.exchange(0, std::memory_order_relaxed);
+			entry.busyMs = static_cast<float>(worker.busyNs.exchange(0, std::memory_order_relaxed)) / 1.0e6f;
+			entry.utilization = wallMs > 0.0f ? std::min(1.0f, entry.busyMs / wallMs) : 0.0f;
+		}
+	}
+} // namespace JobSystem
+
+void JobCounter::release()
+{
+	int32_t value = pending.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		if ((value & ~kFinishing) > 1)
+		{
+			if (pending.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+				return;
+			continue;
+		}
+
+		// Last job of a round that started while the previous one was still being released; let that finish
+		if ((value & kFinishing) != 0)
+		{
+			std::this_thread::yield();
+			value = pending.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// Claim the finish; an add since the load fails the exchange and makes this an ordinary release
+		if (pending.compare_exchange_weak(value, kFinishing, std::memory_order_acq_rel, std::memory_order_relaxed))
+			break;
+	}
+
+	// Take the continuations before clearing kFinishing, since a waiter may destroy the counter right after
+	JobSystem::Job* ready = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(continuationMutex);
+		ready = continuations;
+		continuations = nullptr;
+	}
+
+	while (ready)
+	{
+		JobSystem::Job* job = ready;
+		ready = job->next;
+		job->next = nullptr;
+		JobSystem::dispatch(job);
+	}
+
+	pending.fetch_sub(kFinishing, std::memory_order_acq_rel);
+}
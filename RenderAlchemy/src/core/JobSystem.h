@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class JobCounter;
+
+namespace JobSystem
+{
+	struct Job;
+
+	void runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter);
+} // namespace JobSystem
+
+// Tracks a group of jobs; done once every job added to it has finished.
+// A counter must outlive the jobs it tracks, i.e. wait on it before it goes out of scope. Jobs queued with
+// JobSystem::runAfter are kept on the counter and handed to the workers by the release that finishes it.
+// The release that takes the count to zero claims the finish atomically, so jobs added from then on start
+// a new round that later continuations wait for, while the ones already queued are released.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+	void add(int32_t count = 1) { pending.fetch_add(count, std::memory_order_relaxed); }
+	void release();
+
+private:
+	friend void JobSystem::runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter);
+
+	// Set on pending while the release that finished a round hands out its continuations
+	static constexpr int32_t kFinishing = 1 << 30;
+
+	// Unfinished jobs, plus kFinishing while a finished round is being released
+	std::atomic<int32_t> pending{ 0 };
+
+	// Jobs waiting for this counter, linked through Job::next
+	std::mutex continuationMutex;
+	JobSystem::Job* continuations = nullptr;
+};
+
+// Per worker statistics since the previous JobSystem::sampleStats call
+struct JobWorkerStats
+{
+	uint32_t jobs = 0;         // Jobs executed, including stolen ones
+	uint32_t steals = 0;       // Jobs taken from another worker's queue
+	float busyMs = 0.0f;       // Time spent executing jobs
+	float utilization = 0.0f;  // busyMs over the wall time of the sample, 0..1
+};
+
+// Shared worker pool.
+// Every worker, including the main thread as worker 0, owns a lock-free work-stealing deque: it pushes
+// and pops jobs at the bottom while idle workers steal from the top of the others. Threads that are not
+// workers hand their jobs to a shared injection queue. Waiting on a counter executes pending jobs rather
+// than blocking, so jobs may wait on other jobs. Before init, and in single-threaded mode, every job runs
+// inline on the calling thread in submission order, which keeps results and timings deterministic.
+// Jobs come from a recycled pool and parallelFor chunks don't copy the body, so once the pool has grown
+// queuing work doesn't allocate unless a function's captures outgrow std::function's inline storage.
+namespace JobSystem
+{
+	// Start the workers; workerCount counts the main thread and 0 picks one per hardware thread
+	void init(int workerCount = 0, bool singleThreaded = false);
+
+	// Finish every queued job and join the workers; main thread continuations still pending are dropped
+	void shutdown();
+
+	// Run new jobs inline on the calling thread instead of handing them to workers
+	void setSingleThreaded(bool enabled);
+	bool isSingleThreaded();
+
+	// Number of threads executing jobs, including the main thread
+	int getThreadCount();
+
+	// Queue a job; the counter, if any, is done once it has finished
+	void run(std::function<void()> job, JobCounter* counter = nullptr);
+
+	// Queue a job that starts only after dependency is done
+	void runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+
+	// Execute queued jobs on the calling thread until the counter is done
+	void wait(JobCounter& counter);
+
+	// Call body(first, last) over [begin, end) split into chunks of grain items, returning once all have run.
+	// A grain of 0 picks one that gives every thread a few chunks to balance uneven work.
+	void parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t)>& body, uint32_t grain = 0);
+
+	// Queue work that must happen on the main thread, such as bgfx resource creation after a load
+	void runOnMainThread(std::function<void()> continuation);
+
+	// Run the queued main thread continuations; call once per frame from the main thread
+	void pumpMainThread();
+
+	// Fill one entry per worker, worker 0 being the main thread, and start a new sample
+	void sampleStats(std::vector<JobWorkerStats>& stats);
+} // namespace JobSystem
+
+// Result of a job started with JobSystem::async
+template <typename T>
+class JobFuture
+{
+public:
+	struct State
+	{
+		JobCounter counter;
+		T value{};
+	};
+
+	JobFuture() = default;
+	explicit JobFuture(std::shared_ptr<State> newState) : state(std::move(newState)) {}
+
+	bool valid() const { return state != nullptr; }
+	bool isReady() const { return state && state->counter.isDone(); }
+
+	// Help execute jobs until the result is available
+	void wait() const
+	{
+		if (state)
+		{
+			JobSystem::wait(state->counter);
+		}
+	}
+
+	// Wait for and take the result, leaving the future invalid
+	T get()
+	{
+		wait();
+		T value = std::move(state->value);
+		state.reset();
+		return value;
+	}
+
+private:
+	std::shared_ptr<State> state;
+};
+
+namespace JobSystem
+{
+	// Run a function returning a value as a job; the result type must be default constructible
+	template <typename F>
+	JobFuture<std::invoke_result_t<std::decay_t<F>&>> async(F&& function)
+	{
+		using Result = std::invoke_result_t<std::decay_t<F>&>;
+		auto state = std::make_shared<typename JobFuture<Result>::State>();
+		run([state, function = std::forward<F>(function)]() mutable { state->value = function(); }, &state->counter);
+		return JobFuture<Result>(state);
+	}
+} // namespace JobSystem
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer triple buffer.
+// The producer fills the back slot and publishes it; the consumer takes the most recently published slot.
+// Neither side ever waits on the other: a slow consumer only skips packets, a slow producer only means
+// the consumer keeps reading the last one it acquired.
+template <typename T>
+class TripleBuffer
+{
+public:
+	// Producer: slot to fill before publish(); it holds an older packet, so every field must be written
+	T& write() { return slots[back]; }
+
+	// Producer: hand the back slot to the consumer and take over the spare one
+	void publish()
+	{
+		back = middle.exchange(static_cast<uint8_t>(back | kFresh), std::memory_order_acq_rel) & kIndexMask;
+	}
+
+	// Consumer: switch to the newest published slot; returns false when nothing new was published
+	bool acquire()
+	{
+		if ((middle.load(std::memory_order_relaxed) & kFresh) == 0)
+			return false;
+
+		front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+		return true;
+	}
+
+	// Consumer: the slot taken by the last acquire()
+	const T& read() const { return slots[front]; }
+
+private:
+	static constexpr uint8_t kIndexMask = 0x3;
+	static constexpr uint8_t kFresh = 0x4;
+
+	T slots[3] = {};
+	uint8_t back = 0;
+	uint8_t front = 1;
+	std::atomic<uint8_t> middle{ 2 };
+};
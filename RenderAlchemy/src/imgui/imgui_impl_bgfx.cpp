@@ -2,6 +2,7 @@
 #include "bgfx/bgfx.h"
 #include "bgfx/platform.h"
 #include "bx/math.h"
+#include <cstring>
 #include <vector>
 #include "vs_imgui_bin.h"
 #include "fs_imgui_bin.h"
@@ -14,12 +15,6 @@ static bgfx::ProgramHandle g_ShaderProgram;
 static bgfx::UniformHandle g_UniformTexture;
 static bgfx::TextureHandle g_FontTexture;
 
-struct ImGuiVertex {
-    float pos[2];
-    float uv[2];
-    uint32_t col;
-};
-
 bool ImGui_ImplBgfx_Init(bgfx::ViewId viewId) {
     g_ViewId = viewId;
 
@@ -47,7 +42,14 @@ bool ImGui_ImplBgfx_Init(bgfx::ViewId viewId) {
         (uint16_t)width, (uint16_t)height, false, 1, bgfx::TextureFormat::BGRA8,
         0, bgfx::copy(pixels, width * height * 4)
     );
-    io.Fonts->TexID = (ImTextureID)(uintptr_t)g_FontTexture.idx;
+    io.Fonts->TexID = ImGui_ImplBgfx_GetTextureId(g_FontTexture);
+
+    // Draws index into one shared vertex buffer per frame, so large lists can use more than 64k vertices
+    io.BackendRendererName = "imgui_impl_bgfx";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+    // The UI draws in submission order, over anything submitted to the view before it
+    bgfx::setViewMode(g_ViewId, bgfx::ViewMode::Sequential);
 
     // Assert valid DisplaySize
 	io.DisplaySize = ImVec2(1280, 720);
@@ -75,64 +77,116 @@ void ImGui_ImplBgfx_Shutdown() {
     bgfx::destroy(g_ShaderProgram);
 }
 
+bgfx::TextureHandle ImGui_ImplBgfx_GetTexture(ImTextureID textureId) {
+    bgfx::TextureHandle texture = { uint16_t((uintptr_t)textureId) };
+    return texture;
+}
+
 void ImGui_ImplBgfx_RenderDrawData(ImDrawData* draw_data) {
     // Avoid rendering when minimized
     if (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f)
         return;
 
+    const uint32_t numVertices = (uint32_t)draw_data->TotalVtxCount;
+    const uint32_t numIndices = (uint32_t)draw_data->TotalIdxCount;
+    if (numVertices == 0 || numIndices == 0)
+        return;
+
     const bgfx::Caps* caps = bgfx::getCaps();
     const float width = draw_data->DisplaySize.x;
     const float height = draw_data->DisplaySize.y;
 
     // Setup orthographic projection matrix
     float ortho[16];
-    bx::mtxOrtho(ortho, 0.0f, width, height, 0.0f, 0.0f, 1000.0f, 0.0f, caps->homogeneousDepth);
+    bx::mtxOrtho(ortho, draw_data->DisplayPos.x, draw_data->DisplayPos.x + width, draw_data->DisplayPos.y + height, draw_data->DisplayPos.y, 0.0f, 1000.0f, 0.0f, caps->homogeneousDepth);
 
     bgfx::setViewTransform(g_ViewId, NULL, ortho);
-    bgfx::setViewRect(g_ViewId, 0, 0, uint16_t(width), uint16_t(height));
+    bgfx::setViewRect(g_ViewId, 0, 0, uint16_t(width * draw_data->FramebufferScale.x), uint16_t(height * draw_data->FramebufferScale.y));
 
-    // Render command lists
-    for (int n = 0; n < draw_data->CmdListsCount; n++) {
-        const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const ImDrawIdx* idx_buffer_offset = 0;
+    // One allocation for every command list; drawing only part of the UI would be worse than skipping a frame
+    const bool index32 = sizeof(ImDrawIdx) == 4;
+    bgfx::TransientVertexBuffer tvb;
+    bgfx::TransientIndexBuffer tib;
+    if (!bgfx::allocTransientBuffers(&tvb, g_VertexLayout, numVertices, &tib, numIndices, index32))
+        return;
 
-        // Create vertex and index buffers
-        bgfx::TransientVertexBuffer tvb;
-        bgfx::TransientIndexBuffer tib;
-        uint32_t numVertices = (uint32_t)cmd_list->VtxBuffer.Size;
-        uint32_t numIndices = (uint32_t)cmd_list->IdxBuffer.Size;
+    // Lists are packed back to back; commands address them through VtxOffset and IdxOffset from the list start
+    uint32_t listVertexStart = 0;
+    uint32_t listIndexStart = 0;
 
-        if (!bgfx::getAvailTransientVertexBuffer(numVertices, g_VertexLayout) || !bgfx::getAvailTransientIndexBuffer(numIndices))
-            return;
+    // Submissions keep their vertex buffer, texture and scissor state so only what changes is set again
+    const uint64_t state = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_MSAA | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA);
+    uint32_t boundVertexStart = UINT32_MAX;
+    uint16_t boundTexture = bgfx::kInvalidHandle;
+    uint16_t boundScissor[4] = { 0, 0, 0, 0 };
+    bool stateSet = false;
 
-        bgfx::allocTransientVertexBuffer(&tvb, numVertices, g_VertexLayout);
-        bgfx::allocTransientIndexBuffer(&tib, numIndices);
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
 
-        ImGuiVertex* verts = (ImGuiVertex*)tvb.data;
-        memcpy(verts, cmd_list->VtxBuffer.Data, numVertices * sizeof(ImGuiVertex));
-        memcpy(tib.data, cmd_list->IdxBuffer.Data, numIndices * sizeof(ImDrawIdx));
+        memcpy(tvb.data + listVertexStart * sizeof(ImDrawVert), cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        memcpy(tib.data + listIndexStart * sizeof(ImDrawIdx), cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
 
-        // Render command lists
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
             const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
             if (pcmd->UserCallback) {
-                pcmd->UserCallback(cmd_list, pcmd);
-            } else {
-                const uint16_t xx = uint16_t(bx::max(pcmd->ClipRect.x, 0.0f));
-                const uint16_t yy = uint16_t(bx::max(pcmd->ClipRect.y, 0.0f));
-                const uint16_t ww = uint16_t(bx::min(pcmd->ClipRect.z, 65535.0f) - xx);
-                const uint16_t hh = uint16_t(bx::min(pcmd->ClipRect.w, 65535.0f) - yy);
-
-                bgfx::setScissor(xx, yy, ww, hh);
-                bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_MSAA);
-                bgfx::setTexture(0, g_UniformTexture, g_FontTexture);
-                bgfx::setVertexBuffer(0, &tvb, 0, numVertices);
-                bgfx::setIndexBuffer(&tib, (uint32_t)idx_buffer_offset, pcmd->ElemCount);
-                bgfx::submit(g_ViewId, g_ShaderProgram);
+                // The callback may submit draws of its own, so rebind everything afterwards
+                if (pcmd->UserCallback != ImDrawCallback_ResetRenderState)
+                    pcmd->UserCallback(cmd_list, pcmd);
+                bgfx::discard(BGFX_DISCARD_ALL);
+                boundVertexStart = UINT32_MAX;
+                boundTexture = bgfx::kInvalidHandle;
+                stateSet = false;
+                continue;
+            }
+
+            // Clip rectangle in framebuffer pixels, skipping commands that are clipped away entirely
+            const float clipX0 = (pcmd->ClipRect.x - draw_data->DisplayPos.x) * draw_data->FramebufferScale.x;
+            const float clipY0 = (pcmd->ClipRect.y - draw_data->DisplayPos.y) * draw_data->FramebufferScale.y;
+            const float clipX1 = (pcmd->ClipRect.z - draw_data->DisplayPos.x) * draw_data->FramebufferScale.x;
+            const float clipY1 = (pcmd->ClipRect.w - draw_data->DisplayPos.y) * draw_data->FramebufferScale.y;
+            if (clipX1 <= clipX0 || clipY1 <= clipY0 || pcmd->ElemCount == 0)
+                continue;
+
+            const uint16_t xx = uint16_t(bx::max(clipX0, 0.0f));
+            const uint16_t yy = uint16_t(bx::max(clipY0, 0.0f));
+            const uint16_t scissor[4] = {
+                xx,
+                yy,
+                uint16_t(bx::min(clipX1, 65535.0f) - xx),
+                uint16_t(bx::min(clipY1, 65535.0f) - yy),
+            };
+
+            // Scissor is part of the draw state in bgfx, so both are set together
+            if (!stateSet || memcmp(scissor, boundScissor, sizeof(scissor)) != 0) {
+                bgfx::setState(state);
+                bgfx::setScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+                memcpy(boundScissor, scissor, sizeof(scissor));
+                stateSet = true;
+            }
+
+            const bgfx::TextureHandle texture = ImGui_ImplBgfx_GetTexture(pcmd->GetTexID());
+            if (texture.idx != boundTexture) {
+                bgfx::setTexture(0, g_UniformTexture, texture);
+                boundTexture = texture.idx;
             }
-            idx_buffer_offset += pcmd->ElemCount;
+
+            const uint32_t vertexStart = listVertexStart + pcmd->VtxOffset;
+            if (vertexStart != boundVertexStart) {
+                bgfx::setVertexBuffer(0, &tvb, vertexStart, numVertices - vertexStart);
+                boundVertexStart = vertexStart;
+            }
+
+            bgfx::setIndexBuffer(&tib, listIndexStart + pcmd->IdxOffset, pcmd->ElemCount);
+            bgfx::submit(g_ViewId, g_ShaderProgram, 0, BGFX_DISCARD_INDEX_BUFFER);
         }
+
+        listVertexStart += (uint32_t)cmd_list->VtxBuffer.Size;
+        listIndexStart += (uint32_t)cmd_list->IdxBuffer.Size;
     }
+
+    // Leave no state behind for whatever is submitted next
+    bgfx::discard(BGFX_DISCARD_ALL);
 }
 
 void ImGui_ImplBgfx_NewFrame() {
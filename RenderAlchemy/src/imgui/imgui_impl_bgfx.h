@@ -8,3 +8,7 @@ bool ImGui_ImplBgfx_Init(bgfx::ViewId viewId);
 void ImGui_ImplBgfx_Shutdown();
 void ImGui_ImplBgfx_RenderDrawData(ImDrawData* draw_data);
 void ImGui_ImplBgfx_NewFrame();
+
+// Texture ids for ImGui::Image and the draw list, and back; any bgfx 2D texture can be drawn by the UI
+inline ImTextureID ImGui_ImplBgfx_GetTextureId(bgfx::TextureHandle texture) { return (ImTextureID)(uintptr_t)texture.idx; }
+bgfx::TextureHandle ImGui_ImplBgfx_GetTexture(ImTextureID textureId);
@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #define GLFW_INCLUDE_NONE
@@ -13,20 +20,44 @@
 #define GLFW_EXPOSE_NATIVE_WGL
 #include <GLFW/glfw3native.h>
 
+#include <bx/math.h>
+
 #include "clut/clut.h"
+#include "clut/BatchGrader.h"
+#include "clut/ClutAtlas.h"
+#include "clut/ClutCompare.h"
+#include "clut/ClutThumbnails.h"
+#include "core/AllocationTracker.h"
+#include "core/FrameLog.h"
+#include "core/JobSystem.h"
+#include "core/TripleBuffer.h"
 #include "fonts/IconsLucide.h"
 #include "imgui/imgui_impl_bgfx.h"
+#include "renderer/AutoExposure.h"
 #include "renderer/BgfxUtils.h"
+#include "renderer/ClusteredLights.h"
+#include "renderer/ComputeTonemap.h"
+#include "renderer/DepthPrepass.h"
+#include "renderer/DynamicResolution.h"
+#include "renderer/FrameExporter.h"
 #include "renderer/Framebuffer.h"
+#include "renderer/FrustumCuller.h"
 #include "renderer/Geometry.h"
+#include "renderer/GpuDrivenScene.h"
+#include "renderer/GpuScopes.h"
+#include "renderer/HdrTarget.h"
+#include "renderer/MeshLod.h"
+#include "renderer/OcclusionCuller.h"
+#include "renderer/ParallelSubmit.h"
 #include "renderer/Shader.h"
 #include "ui/ImGuiUtils.h"
 
 // Forward declarations
 void framebufferSizeCallback(int width, int height);
-void processInput(GLFWwindow* window);
+void publishFramePacket(GLFWwindow* window);
+bool processInput(bool waitForInput);
 void initImGui();
-void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& currentClut, const char*& currentPreset, bgfx::TextureHandle& clut1DTexture, bgfx::TextureHandle& clut3DTexture, bool& use3DCLUT, char* customLutName, bool& editingMode, float* cameraPos);
+void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& currentClut, const char*& currentPreset, bgfx::TextureHandle& clut1DTexture, bool& use3DCLUT, char* customLutName, bool& editingMode, float* cameraPos);
 
 // Global variables
 int windowWidth = 1280;
@@ -34,14 +65,179 @@ int windowHeight = 720;
 float rotationAngle = 0.0f;
 bool framebufferResized = false;
 
+// Window and input state, captured by the render thread after every event poll
+struct FramePacket
+{
+	int framebufferWidth;
+	int framebufferHeight;
+	float mouseX;
+	float mouseY;
+	bool mouseDown[3];
+	float scrollTotal; // Accumulated wheel offset; the reader applies the difference to the last packet it read
+	bool closeRequested;
+
+	bool operator==(const FramePacket&) const = default;
+};
+
+// The render thread publishes packets and the application thread takes the newest one each frame
+TripleBuffer<FramePacket> framePackets;
+std::atomic<bool> applicationRunning{ true };
+float scrollTotal = 0.0f;     // Render thread only, fed by the scroll callback
+float lastScrollTotal = 0.0f; // Application thread only
+
+// Lets the application thread sleep until the render thread publishes a packet
+std::mutex framePacketMutex;
+std::condition_variable framePacketCondition;
+uint64_t framePacketCount = 0;
+uint64_t framePacketsRead = 0;
+FramePacket lastFramePacket = {};
+bool inputChanged = false;
+
+// Longest the render thread waits for a frame before pumping window events again
+constexpr int32_t kRenderFrameTimeoutMs = 16;
+
+// Time the application thread waited for the render thread, and the render thread for submissions
+float apiWaitRenderMs = 0.0f;
+float renderWaitSubmitMs = 0.0f;
+
+// Render on demand: the scene pass only runs when its inputs change and the tonemap pass only when the
+// scene or a post setting changes, otherwise the cached HDR and LDR targets are presented again. With
+// nothing changing at all no frame is submitted and both threads sleep on window events.
+bool renderOnDemand = true;
+std::atomic<bool> applicationIdle{ false };
+uint32_t clutRevision = 0; // Bumped whenever a CLUT texture is recreated
+uint32_t scenePasses = 0;
+uint32_t postPasses = 0;
+uint32_t presentedFrames = 0;
+
+// Frames still rendered after the last change, so ImGui can settle hover and popup state
+constexpr int kIdleGraceFrames = 3;
+
+// Longest an idle thread sleeps before checking for finished jobs and window events again
+constexpr double kIdleWaitSeconds = 0.1;
+
 // Scene settings
 int sceneType = 0; // 0: Cube, 1: Sphere, 2: Plane
 float lightPos[3] = { 3.0f, 3.0f, 3.0f };
 float lightColor[3] = { 1.0f, 1.0f, 1.0f };
 float lightIntensity = 1.0f;
 float ambientStrength = 0.1f;
+
+// Clustered light stress test, the preset indexes kStressLightCounts
+constexpr uint32_t kStressLightCounts[] = { 0, 1, 100, 1000 };
+int stressLightPreset = 0;
+float stressLightRadius = 2.0f;
+uint32_t clusteredLightCount = 0;
+uint32_t clusteredIndexCount = 0;
+uint32_t clusteredMaxPerCluster = 0;
+float clusterAssignMs = 0.0f;
+
+// GPU time of the prepass and scene views, and of the exposure and tonemap views, in the last completed frame
+float sceneGpuMs = 0.0f;
+float postGpuMs = 0.0f;
+
+// Colour format tier of the HDR scene target, with an A/B benchmark of the tiers
+HdrTarget hdrTarget;
+uint32_t hdrColorBytes = 0;
+
+// Resolution scale of the scene pass, chosen to hold a GPU frame time
+DynamicResolution dynamicResolution;
+DynamicResolution::Settings dynamicResolutionSettings;
+float gpuFrameMs = 0.0f;
+int sceneWidth = windowWidth;
+int sceneHeight = windowHeight;
+
+// Histogram, waveform and vectorscope of the graded output (0) or the HDR scene (1), computed on the GPU
+GpuScopes gpuScopes;
+bool showScopesWindow = false;
+int scopeSource = 0;
+float scopeGpuMs = 0.0f;
+
+// Auto exposure adapts to the HDR image on the GPU, the exposure slider then acts as compensation
+AutoExposure autoExposure;
+AutoExposure::Settings autoExposureSettings;
+bool autoExposureEnabled = false;
+float autoExposureGpuMs = 0.0f;
+
+// Tonemap pass through the raster pipeline or a compute shader, with the last GPU time of each path
+ComputeTonemap computeTonemap;
+bool useComputeTonemap = false;
+float tonemapGpuMs[2] = { -1.0f, -1.0f }; // Raster, compute; negative until measured
+
+// Image sequence export through asynchronous read backs
+FrameExporter frameExporter;
+FrameExporter::Settings frameExportSettings;
+
+// Per frame input recording, and replay in fixed time steps with the timings written per frame. A replay
+// given on the command line exits once it ends, headless ones run with a hidden window and no UI.
+FrameRecorder frameRecorder;
+FrameReplay frameReplay;
+FrameTimingLog frameTimingLog;
+bool exitAfterReplay = false;
+bool replayHeadless = false;
+constexpr double kReplayStepMs = 1000.0 / 60.0;
+
 float modelRotation[3] = { 0.0f, 0.0f, 0.0f };
 
+// Level of detail settings
+bool enableLod = true;
+float lodPixelThreshold = 1.0f;
+int activeLod = 0;
+int activeLodCount = 1;
+uint32_t activeTriangles = 0;
+
+// Meshlet culling settings
+bool enableMeshlets = false;
+uint32_t visibleMeshlets = 0;
+uint32_t totalMeshlets = 0;
+
+// Instancing settings, the layout is shared by the instanced and GPU driven paths
+bool enableInstancing = false;
+InstanceLayout instanceLayout;
+uint32_t instancesDrawn = 0;
+
+// Per-draw submission of the instance layout, recorded on several threads with their own encoders
+bool perDrawSubmission = false;
+int submitThreads = static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 1u, static_cast<unsigned>(ParallelSubmit::kMaxThreads)));
+SubmitStats submitStats;
+
+// Job system settings and per-worker statistics, sampled a few times per second
+bool jobsSingleThreaded = false;
+std::vector<JobWorkerStats> jobWorkerStats;
+double jobStatsTime = 0.0;
+
+// CLUT files are loaded as jobs; the control window reports the result once the textures are created
+enum class ClutLoadResult
+{
+	None,
+	Loaded,
+	Failed
+};
+bool clutLoadPending = false;
+ClutLoadResult clutLoadResult = ClutLoadResult::None;
+
+// Software occlusion culling settings, used by the instanced path
+bool enableOcclusionCulling = false;
+int maxOccluders = 32;
+uint32_t occludedInstances = 0;
+uint32_t occlusionOccluders = 0;
+float occlusionRasterizeMs = 0.0f;
+
+// Frustum culling of the instanced path, which always runs before occlusion culling
+uint32_t frustumTestedInstances = 0;
+uint32_t frustumVisibleInstances = 0;
+float frustumCullMs = 0.0f;
+
+// Depth prepass settings, only the default and instanced paths support it
+DepthPrepass depthPrepass;
+
+// GPU driven rendering settings
+constexpr int kMaxGpuInstances = 131072;
+bool gpuDrivenSupported = false;
+bool enableGpuDriven = false;
+bool gpuOcclusionCulling = true;
+uint32_t gpuDrawCalls = 0;
+
 // Auto-rotation settings
 bool autoRotateModel = false;
 float modelRotationSpeed = 0.5f;
@@ -59,6 +255,25 @@ bool splitScreen = false;
 float splitPosition = 0.5f;
 bool showClut = true;
 
+// Middle blue slice of the current 3D CLUT, drawn by the UI as its preview
+bgfx::TextureHandle clutPreviewTexture = BGFX_INVALID_HANDLE;
+uint32_t clutPreviewRevision = UINT32_MAX;
+
+// Graded thumbnails of every CLUT in the library, for the preset browser
+ClutThumbnails clutThumbnails;
+
+// Folder of images graded with the current CLUT on the job system
+BatchGrader batchGrader;
+
+// Every 3D CLUT stays resident in the atlas, selecting one only changes the slot the tonemap pass samples
+ClutAtlas clutAtlas;
+ClutAtlasLocation activeClut3D;
+int clutAtlasBudgetMB = 256;
+
+// Multi-grade comparison: each viewport region graded with its own candidate CLUT in the tonemap pass
+ClutCompare clutCompare;
+bool compareMode = false;
+
 // CLUT editing
 float clutContrast = 1.0f;
 float clutSaturation = 1.0f;
@@ -74,59 +289,475 @@ bool showPreferencesWindow = false;
 // For bgfx view IDs
 constexpr uint8_t kSceneView = 0;
 constexpr uint8_t kPostProcessView = 1;
+constexpr uint8_t kCullView = 2;
+constexpr uint8_t kHiZView = 3;
+constexpr uint8_t kDepthPrepassView = 4;
+constexpr uint8_t kTonemapView = 5;
+constexpr uint8_t kThumbnailView = 6;
+constexpr uint8_t kScopeView = 7;
+constexpr uint8_t kExposureView = 8;
+constexpr uint8_t kExportView = 9;
 
 static void* glfwNativeWindowHandle(GLFWwindow* _window)
 {
 	return glfwGetWin32Window(_window);
 }
 
-int main()
+// Rebuild the 3D CLUT preview when the CLUT changed since the last one was built
+static void updateClutPreview(const CLUT& clut)
 {
-	// Create a native window for bgfx using glfw
-	if (!glfwInit())
+	if (clutPreviewRevision == clutRevision && bgfx::isValid(clutPreviewTexture))
+		return;
+
+	if (bgfx::isValid(clutPreviewTexture))
 	{
-		std::cerr << "Failed to initialize GLFW" << std::endl;
-		return -1;
+		bgfx::destroy(clutPreviewTexture);
 	}
 
-	// Set OpenGL version to 4.3
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	const int size = clut.getSize();
+	const int b = size / 2;
+	const std::vector<float>& data = clut.getData();
+	std::vector<float> texels(size * size * 4);
+	for (int g = 0; g < size; ++g)
+	{
+		for (int r = 0; r < size; ++r)
+		{
+			const int idx = (b * size * size + g * size + r) * 3;
+			float* texel = &texels[(g * size + r) * 4];
+			texel[0] = data[idx + 0];
+			texel[1] = data[idx + 1];
+			texel[2] = data[idx + 2];
+			texel[3] = 1.0f;
+		}
+	}
 
-	// Create a windowed mode window and its OpenGL context
-	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "RenderAlchemy", NULL, NULL);
-	if (!window)
+	const bgfx::Memory* mem = bgfx::copy(texels.data(), texels.size() * sizeof(float));
+	clutPreviewTexture = bgfx::createTexture2D(size, size, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP, mem);
+	clutPreviewRevision = clutRevision;
+}
+
+// Histogram, waveform and vectorscope, drawn straight from the images the scope passes wrote
+static void renderScopesWindow()
+{
+	if (!showScopesWindow)
+		return;
+
+	ImGui::SetNextWindowSize(ImVec2(540, 520), ImGuiCond_FirstUseEver);
+	ImGui::Begin("Scopes", &showScopesWindow);
+
+	if (!gpuScopes.isValid())
 	{
-		std::cerr << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
+		ImGui::TextWrapped("Scopes need compute shader support, which this renderer does not provide.");
+		ImGui::End();
+		return;
 	}
 
-	// Make the window's context current
-	glfwMakeContextCurrent(window);
+	ImGui::RadioButton("Graded Output", &scopeSource, 0);
+	ImGui::SameLine();
+	ImGui::RadioButton("HDR Scene (Log)", &scopeSource, 1);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Scene linear values after exposure, log encoded from -8 to +4 stops around middle grey");
 
-	// Initialize bgfx
-	if (!BgfxUtils::init(windowWidth, windowHeight, glfwNativeWindowHandle(window)))
+	float density = gpuScopes.getDensity();
+	ImGui::SetNextItemWidth(200.0f);
+	if (ImGui::SliderFloat("Trace Density", &density, 0.1f, 10.0f, "%.1f", ImGuiSliderFlags_Logarithmic))
 	{
-		std::cerr << "Failed to initialize bgfx" << std::endl;
-		return -1;
+		gpuScopes.setDensity(density);
 	}
+	ImGui::Text("%u samples, %.3f ms GPU", gpuScopes.getSampleCount(), scopeGpuMs);
 
-	// Initialize ImGui
-	initImGui();
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	const ImU32 gridColor = IM_COL32(255, 255, 255, 48);
+	const float width = ImGui::GetContentRegionAvail().x;
+
+	// Histogram across the full width, levels 0 to 255
+	ImGui::Image(ImGui_ImplBgfx_GetTextureId(gpuScopes.getHistogram()), ImVec2(width, width * 0.3f));
+
+	// Waveform with a line every 10%, vectorscope with its 75% saturation ring beside it
+	const float side = std::max((width - ImGui::GetStyle().ItemSpacing.x) * 0.5f, 1.0f);
+	ImGui::Image(ImGui_ImplBgfx_GetTextureId(gpuScopes.getWaveform()), ImVec2(side, side));
+	ImVec2 min = ImGui::GetItemRectMin();
+	ImVec2 max = ImGui::GetItemRectMax();
+	for (int i = 1; i < 10; ++i)
+	{
+		const float y = max.y - (max.y - min.y) * i / 10.0f;
+		drawList->AddLine(ImVec2(min.x, y), ImVec2(max.x, y), gridColor);
+	}
+
+	ImGui::SameLine();
+	ImGui::Image(ImGui_ImplBgfx_GetTextureId(gpuScopes.getVectorscope()), ImVec2(side, side));
+	min = ImGui::GetItemRectMin();
+	max = ImGui::GetItemRectMax();
+	const ImVec2 center((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f);
+	drawList->AddLine(ImVec2(min.x, center.y), ImVec2(max.x, center.y), gridColor);
+	drawList->AddLine(ImVec2(center.x, min.y), ImVec2(center.x, max.y), gridColor);
+	drawList->AddCircle(center, side * 0.5f * 0.75f, gridColor, 64);
+
+	// Skin tone line, at 123 degrees from the Cb axis
+	const float skinAngle = 123.0f * 3.14159265f / 180.0f;
+	drawList->AddLine(center, ImVec2(center.x + std::cos(skinAngle) * side * 0.5f, center.y - std::sin(skinAngle) * side * 0.5f), IM_COL32(255, 200, 150, 96));
+
+	ImGui::End();
+}
+
+// Name each comparison region over the viewport, and let the wipe lines be dragged directly
+static void drawCompareOverlay()
+{
+	if (!compareMode || clutCompare.getCount() == 0)
+		return;
+
+	ImGuiIO& io = ImGui::GetIO();
+	ImDrawList* drawList = ImGui::GetForegroundDrawList();
+	const float width = io.DisplaySize.x;
+	const float height = io.DisplaySize.y;
+
+	static int draggedWipe = -1;
+	if (clutCompare.getLayout() == ClutCompare::Layout::Wipe)
+	{
+		const float grabDistance = 6.0f;
+		int hoveredWipe = -1;
+		for (int i = 0; i < clutCompare.getCount() - 1; ++i)
+		{
+			const float x = clutCompare.getWipe(i) * width;
+			const bool hovered = !io.WantCaptureMouse && std::abs(io.MousePos.x - x) < grabDistance;
+			if (hovered && hoveredWipe < 0)
+			{
+				hoveredWipe = i;
+			}
+			drawList->AddLine(ImVec2(x, 0.0f), ImVec2(x, height), hovered || draggedWipe == i ? IM_COL32(255, 255, 255, 255) : IM_COL32(255, 255, 255, 160), 2.0f);
+		}
+
+		if (ImGui::IsMouseClicked(0))
+		{
+			draggedWipe = hoveredWipe;
+		}
+		else if (!ImGui::IsMouseDown(0))
+		{
+			draggedWipe = -1;
+		}
+
+		if (draggedWipe >= 0 && draggedWipe < clutCompare.getCount() - 1)
+		{
+			clutCompare.setWipe(draggedWipe, io.MousePos.x / width);
+		}
+		if (draggedWipe >= 0 || hoveredWipe >= 0)
+		{
+			ImGui::SetMouseCursor(ImGuiMouseCursor_ResizeEW);
+		}
+	}
+	else
+	{
+		draggedWipe = -1;
+	}
+
+	for (int i = 0; i < clutCompare.getCount(); ++i)
+	{
+		float x0, y0, x1, y1;
+		clutCompare.getRegion(i, x0, y0, x1, y1);
+		if (clutCompare.getLayout() == ClutCompare::Layout::Grid)
+		{
+			drawList->AddRect(ImVec2(x0 * width, y0 * height), ImVec2(x1 * width, y1 * height), IM_COL32(0, 0, 0, 160));
+		}
+
+		const char* name = clutCompare.getName(i).c_str();
+		const ImVec2 textSize = ImGui::CalcTextSize(name);
+		const ImVec2 position(x0 * width + 8.0f, y1 * height - textSize.y - 12.0f);
+		drawList->AddRectFilled(ImVec2(position.x - 4.0f, position.y - 2.0f), ImVec2(position.x + textSize.x + 4.0f, position.y + textSize.y + 2.0f), IM_COL32(0, 0, 0, 160), 3.0f);
+		drawList->AddText(position, IM_COL32(255, 255, 255, 255), name);
+	}
+}
+
+// FNV-1a over raw bytes, chained through hash; fingerprints the settings a pass depends on
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+template <typename T>
+static uint64_t hashValue(uint64_t hash, const T& value)
+{
+	return hashBytes(hash, &value, sizeof(T));
+}
+
+// Hand the instances to the GPU driven scene, alternating between the two batches
+static void fillGpuScene(GpuDrivenScene& scene, uint32_t cubeBatch, uint32_t sphereBatch, const std::vector<InstanceData>& instances)
+{
+	scene.clearInstances();
+
+	for (size_t i = 0; i < instances.size(); ++i)
+	{
+		scene.addInstance((i & 1) ? sphereBatch : cubeBatch, instances[i]);
+	}
+}
+
+// World space bounding spheres of the instances, for frustum culling
+static void buildInstanceBounds(FrustumCuller& culler, const Geometry& geometry, const std::vector<InstanceData>& instances)
+{
+	culler.clear();
+	const float* boundsCenter = geometry.getBoundsCenter();
+	for (const InstanceData& instance : instances)
+	{
+		// Largest axis scale keeps the sphere conservative under non-uniform scaling
+		const float* transform = instance.transform;
+		float scale = 0.0f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float* column = &transform[axis * 4];
+			scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+		}
+
+		float center[3];
+		bx::store(center, bx::mul(bx::load<bx::Vec3>(boundsCenter), transform));
+		culler.add(center, geometry.getBoundsRadius() * scale);
+	}
+}
+
+// Rasterize the instances that cover the most screen as occluders, then keep only the instances
+// that are not hidden behind them
+static void cullOccludedInstances(OcclusionCuller& culler, const Geometry& geometry, const float* viewProj, const float* eye, const InstanceData* instances, uint32_t count, std::vector<InstanceData>& visible)
+{
+	culler.beginFrame(viewProj);
+
+	// Scratch kept across frames, so culling does not allocate once the instance count settles
+	static std::vector<float> sizes;
+	static std::vector<uint32_t> order;
+	sizes.resize(count);
+	order.resize(count);
+
+	const float* boundsCenter = geometry.getBoundsCenter();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		// Projected size estimate: scaled radius over distance to the camera
+		const float* transform = instances[i].transform;
+		const float scale = std::sqrt(transform[0] * transform[0] + transform[1] * transform[1] + transform[2] * transform[2]);
+		const float dx = transform[12] - eye[0];
+		const float dy = transform[13] - eye[1];
+		const float dz = transform[14] - eye[2];
+		sizes[i] = scale * geometry.getBoundsRadius() / std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-3f);
+		order[i] = i;
+	}
+
+	const uint32_t occluders = std::min<uint32_t>(count, static_cast<uint32_t>(maxOccluders));
+	std::partial_sort(order.begin(), order.begin() + occluders, order.end(), [](uint32_t a, uint32_t b) { return sizes[a] > sizes[b]; });
+
+	const std::vector<float>& positions = geometry.getPositions();
+	const std::vector<uint32_t>& indices = geometry.getIndices();
+	for (uint32_t i = 0; i < occluders; ++i)
+	{
+		culler.addOccluder(positions.data(), indices.data(), static_cast<uint32_t>(indices.size()), instances[order[i]].transform);
+	}
+	culler.rasterize();
+
+	visible.clear();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (culler.isVisible(boundsCenter, geometry.getBoundsRadius(), instances[i].transform))
+		{
+			visible.push_back(instances[i]);
+		}
+	}
+}
+
+// Make a library entry the current CLUT, from the UI or a replay
+static void selectClutPreset(const std::pair<const std::string, CLUT>& preset, CLUT& currentClut, const char*& currentPreset, bgfx::TextureHandle& clut1DTexture, bool& use3DCLUT, bool& editingMode)
+{
+	AllocationScope allocationScope(AllocationSubsystem::Clut);
+	currentPreset = preset.first.c_str();
+	currentClut = preset.second;
+
+	// Update use3DCLUT flag based on the selected preset
+	use3DCLUT = preset.second.is3DCLUT();
+
+	// Update appropriate texture based on CLUT type
+	if (use3DCLUT)
+	{
+		// Resident CLUTs only switch slots, anything else is uploaded once
+		activeClut3D = clutAtlas.find(preset.first);
+		if (!activeClut3D.isValid())
+		{
+			activeClut3D = clutAtlas.update(preset.first, preset.second);
+		}
+	}
+	else
+	{
+		// Expand to RGBA straight into the upload, without a staging vector
+		bgfx::destroy(clut1DTexture);
+		const bgfx::Memory* mem1D = bgfx::alloc(currentClut.getSize() * 4 * sizeof(float));
+		float* clutDataWithAlpha = reinterpret_cast<float*>(mem1D->data);
+		for (int i = 0; i < currentClut.getSize(); ++i) {
+			clutDataWithAlpha[i * 4 + 0] = currentClut.getData()[i * 3 + 0];
+			clutDataWithAlpha[i * 4 + 1] = currentClut.getData()[i * 3 + 1];
+			clutDataWithAlpha[i * 4 + 2] = currentClut.getData()[i * 3 + 2];
+			clutDataWithAlpha[i * 4 + 3] = 1.0f; // Set alpha to 1.0
+		}
+		clut1DTexture = bgfx::createTexture2D(currentClut.getSize(), 1, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem1D);
+	}
+	++clutRevision;
+
+	// Reset CLUT editing parameters when selecting a preset
+	clutContrast = 1.0f;
+	clutSaturation = 1.0f;
+	clutTemperature = 0.0f;
+	clutTint = 0.0f;
+	editingMode = false;
+}
+
+// Snapshot of the settings a frame renders with, for the frame log
+static FrameInputs captureFrameInputs(const float* cameraPos, bool wireframeMode, bool use3DCLUT)
+{
+	FrameInputs inputs;
+	inputs.windowWidth = windowWidth;
+	inputs.windowHeight = windowHeight;
+	std::copy(cameraPos, cameraPos + 3, inputs.cameraPos);
+	std::copy(modelRotation, modelRotation + 3, inputs.modelRotation);
+	std::copy(lightPos, lightPos + 3, inputs.lightPos);
+	std::copy(lightColor, lightColor + 3, inputs.lightColor);
+	inputs.lightIntensity = lightIntensity;
+	inputs.ambientStrength = ambientStrength;
+	inputs.sceneType = sceneType;
+
+	inputs.exposure = exposure;
+	inputs.clutStrength = clutStrength;
+	inputs.tonemapOperator = tonemapOperator;
+	inputs.splitPosition = splitPosition;
+
+	inputs.lodPixelThreshold = lodPixelThreshold;
+	inputs.instancePlacement = static_cast<int32_t>(instanceLayout.placement);
+	inputs.instanceCount = instanceLayout.count;
+	inputs.instanceSpacing = instanceLayout.spacing;
+	inputs.instanceScale = instanceLayout.scale;
+	inputs.instanceSeed = instanceLayout.seed;
+	inputs.submitThreads = submitThreads;
+	inputs.maxOccluders = maxOccluders;
+	inputs.depthPrepassMode = static_cast<int32_t>(depthPrepass.getMode());
+	inputs.stressLightPreset = stressLightPreset;
+	inputs.stressLightRadius = stressLightRadius;
+	inputs.hdrTier = static_cast<int32_t>(hdrTarget.getTier());
+	inputs.resolutionTargetMs = dynamicResolutionSettings.targetMs;
+
+	const std::pair<bool, FrameToggle> toggles[] = {
+		{ applyClut, kToggleApplyClut },
+		{ use3DCLUT, kToggleUse3DClut },
+		{ splitScreen, kToggleSplitScreen },
+		{ wireframeMode, kToggleWireframe },
+		{ enableLod, kToggleLod },
+		{ enableMeshlets, kToggleMeshlets },
+		{ enableInstancing, kToggleInstancing },
+		{ perDrawSubmission, kTogglePerDrawSubmission },
+		{ enableOcclusionCulling, kToggleOcclusionCulling },
+		{ enableGpuDriven, kToggleGpuDriven },
+		{ gpuOcclusionCulling, kToggleGpuOcclusionCulling },
+		{ autoExposureEnabled, kToggleAutoExposure },
+		{ useComputeTonemap, kToggleComputeTonemap },
+		{ dynamicResolutionSettings.enabled, kToggleDynamicResolution },
+		{ jobsSingleThreaded, kToggleJobsSingleThreaded },
+	};
+	for (const auto& [enabled, toggle] : toggles)
+	{
+		inputs.toggles |= enabled ? toggle : 0u;
+	}
+	return inputs;
+}
+
+// Restore the settings of a logged frame, overriding the UI and animation
+static void applyFrameInputs(const FrameInputs& inputs, float* cameraPos, bool& wireframeMode, bool& use3DCLUT)
+{
+	if (inputs.windowWidth != windowWidth || inputs.windowHeight != windowHeight)
+	{
+		framebufferSizeCallback(inputs.windowWidth, inputs.windowHeight);
+	}
+	std::copy(inputs.cameraPos, inputs.cameraPos + 3, cameraPos);
+	std::copy(inputs.modelRotation, inputs.modelRotation + 3, modelRotation);
+	std::copy(inputs.lightPos, inputs.lightPos + 3, lightPos);
+	std::copy(inputs.lightColor, inputs.lightColor + 3, lightColor);
+	lightIntensity = inputs.lightIntensity;
+	ambientStrength = inputs.ambientStrength;
+	sceneType = inputs.sceneType;
+
+	exposure = inputs.exposure;
+	clutStrength = inputs.clutStrength;
+	tonemapOperator = inputs.tonemapOperator;
+	splitPosition = inputs.splitPosition;
+
+	lodPixelThreshold = inputs.lodPixelThreshold;
+	instanceLayout.placement = static_cast<InstancePlacement>(inputs.instancePlacement);
+	instanceLayout.count = inputs.instanceCount;
+	instanceLayout.spacing = inputs.instanceSpacing;
+	instanceLayout.scale = inputs.instanceScale;
+	instanceLayout.seed = inputs.instanceSeed;
+	submitThreads = inputs.submitThreads;
+	maxOccluders = inputs.maxOccluders;
+	depthPrepass.setMode(static_cast<DepthPrepassMode>(inputs.depthPrepassMode));
+	stressLightPreset = inputs.stressLightPreset;
+	stressLightRadius = inputs.stressLightRadius;
+	hdrTarget.setTier(static_cast<HdrFormatTier>(inputs.hdrTier));
+	dynamicResolutionSettings.targetMs = inputs.resolutionTargetMs;
+
+	applyClut = (inputs.toggles & kToggleApplyClut) != 0;
+	use3DCLUT = (inputs.toggles & kToggleUse3DClut) != 0;
+	splitScreen = (inputs.toggles & kToggleSplitScreen) != 0;
+	wireframeMode = (inputs.toggles & kToggleWireframe) != 0;
+	enableLod = (inputs.toggles & kToggleLod) != 0;
+	enableMeshlets = (inputs.toggles & kToggleMeshlets) != 0;
+	enableInstancing = (inputs.toggles & kToggleInstancing) != 0;
+	perDrawSubmission = (inputs.toggles & kTogglePerDrawSubmission) != 0;
+	enableOcclusionCulling = (inputs.toggles & kToggleOcclusionCulling) != 0;
+	enableGpuDriven = (inputs.toggles & kToggleGpuDriven) != 0;
+	gpuOcclusionCulling = (inputs.toggles & kToggleGpuOcclusionCulling) != 0;
+	autoExposureEnabled = (inputs.toggles & kToggleAutoExposure) != 0;
+	useComputeTonemap = (inputs.toggles & kToggleComputeTonemap) != 0;
+	dynamicResolutionSettings.enabled = (inputs.toggles & kToggleDynamicResolution) != 0;
+	jobsSingleThreaded = (inputs.toggles & kToggleJobsSingleThreaded) != 0;
+}
 
+// Create the scene and run the frame loop on the application thread until the window closes
+static void runScene()
+{
 	// Create shader programs
 	std::cout << "Creating shader programs..." << std::endl;
 	std::cout << "Scene shader compiling" << std::endl;
 	Shader sceneShader("shaders/scene.vert.sc", "shaders/scene.frag.sc");
+	Shader instancedSceneShader("shaders/scene_instanced.vert.sc", "shaders/scene.frag.sc");
+	Shader depthShader("shaders/depth.vert.sc", "shaders/depth.frag.sc");
+	Shader depthInstancedShader("shaders/depth_instanced.vert.sc", "shaders/depth.frag.sc");
 	std::cout << "Tonemap shader compiling" << std::endl;
 	Shader tonemapShader("shaders/tonemap.vert.sc", "shaders/tonemap.frag.sc");
+	Shader presentShader("shaders/tonemap.vert.sc", "shaders/present.frag.sc");
+	bgfx::UniformHandle presentSampler = bgfx::createUniform("s_ldrBuffer", bgfx::UniformType::Sampler);
 
-	// Create CLUT library with presets
+	// Create CLUT library with presets, generating the 1D and 3D sets as separate jobs
 	std::map<std::string, CLUT> clutLibrary;
-	CLUT::createPreset1DCLUTs(clutLibrary);
-	CLUT::createPreset3DCLUTs(clutLibrary);
+	std::map<std::string, CLUT> preset3DLibrary;
+	JobCounter presetJobs;
+	JobSystem::run([&clutLibrary]() { CLUT::createPreset1DCLUTs(clutLibrary); }, &presetJobs);
+	JobSystem::run([&preset3DLibrary]() { CLUT::createPreset3DCLUTs(preset3DLibrary); }, &presetJobs);
+	JobSystem::wait(presetJobs);
+	clutLibrary.merge(preset3DLibrary);
+
+	// Queue a thumbnail per preset, they are graded together on the first frame
+	clutThumbnails.create();
+	for (const auto& preset : clutLibrary)
+	{
+		clutThumbnails.update(preset.first, preset.second);
+	}
+
+	clutCompare.create(clutAtlas);
+
+	// Upload every 3D preset once
+	clutAtlas.setBudget(uint64_t(clutAtlasBudgetMB) << 20);
+	for (const auto& preset : clutLibrary)
+	{
+		if (preset.second.is3DCLUT())
+		{
+			clutAtlas.update(preset.first, preset.second);
+		}
+	}
+	activeClut3D = clutAtlas.find("Neutral (3D)");
 
 	// Set initial CLUT to Neutral 1D
 	CLUT currentClut = clutLibrary["Neutral (1D)"];
@@ -143,22 +774,6 @@ int main()
 	const bgfx::Memory* mem1D = bgfx::copy(clutDataWithAlpha.data(), clutDataWithAlpha.size() * sizeof(float));
 	clut1DTexture = bgfx::createTexture2D(currentClut.getSize(), 1, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem1D);
 
-	// Create an initial 3D CLUT texture too
-	CLUT neutral3D = clutLibrary["Neutral (3D)"];
-	neutral3D.setIs3DCLUT(true);
-	bgfx::TextureHandle clut3DTexture = BGFX_INVALID_HANDLE;
-
-	// For 3D CLUT (Creating the bgfx texture)
-	std::vector<float> clutDataWithAlpha3D(neutral3D.getSize() * neutral3D.getSize() * neutral3D.getSize() * 4);
-	for (int i = 0; i < neutral3D.getSize() * neutral3D.getSize() * neutral3D.getSize(); ++i) {
-		clutDataWithAlpha3D[i * 4 + 0] = neutral3D.getData()[i * 3 + 0];
-		clutDataWithAlpha3D[i * 4 + 1] = neutral3D.getData()[i * 3 + 1];
-		clutDataWithAlpha3D[i * 4 + 2] = neutral3D.getData()[i * 3 + 2];
-		clutDataWithAlpha3D[i * 4 + 3] = 1.0f; // Set alpha to 1.0
-	}
-	const bgfx::Memory* mem3D = bgfx::copy(clutDataWithAlpha3D.data(), clutDataWithAlpha3D.size() * sizeof(float));
-	clut3DTexture = bgfx::createTexture3D(neutral3D.getSize(), neutral3D.getSize(), neutral3D.getSize(), false, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem3D);
-
 	// Track which type of CLUT is active
 	bool use3DCLUT = false;
 
@@ -167,7 +782,7 @@ int main()
 	cube.createCube();
 
 	Geometry sphere;
-	sphere.createSphere();
+	sphere.createSphere(64);
 
 	Geometry plane;
 	plane.createPlane();
@@ -175,9 +790,55 @@ int main()
 	Geometry screenQuad;
 	screenQuad.createScreenQuad();
 
-	// Create framebuffer for HDR rendering
+	// Build LOD chains as jobs, they are picked up by updateLods() once ready
+	cube.buildLods();
+	sphere.buildLods();
+	plane.buildLods();
+
+	// GPU driven scene with one batch per geometry
+	GpuDrivenScene gpuScene;
+	gpuDrivenSupported = gpuScene.create(kMaxGpuInstances);
+	gpuScopes.create();
+	autoExposure.create();
+	const uint32_t cubeBatch = gpuScene.addBatch(&cube);
+	const uint32_t sphereBatch = gpuScene.addBatch(&sphere);
+
+	// Lights shaded through the cluster grid, regenerated when the stress preset changes
+	ClusteredLights clusteredLights;
+	clusteredLights.create();
+	std::vector<PointLight> stressLights;
+	int builtStressPreset = -1;
+	float builtStressRadius = 0.0f;
+
+	// Instances for the instanced and GPU driven paths, regenerated when the layout changes
+	std::vector<InstanceData> sceneInstances;
+	InstanceLayout builtInstanceLayout;
+	builtInstanceLayout.count = -1;
+
+	// Instance bounds for frustum culling, rebuilt with the instances or when the geometry changes, and the
+	// instances inside the frustum
+	FrustumCuller instanceCuller;
+	const Geometry* instanceCullerGeometry = nullptr;
+	std::vector<uint32_t> frustumVisible;
+	std::vector<InstanceData> frustumInstances;
+
+	// Software depth buffer for occlusion culling of the instanced path, and the instances that survive it
+	OcclusionCuller occlusionCuller;
+	std::vector<InstanceData> unoccludedInstances;
+
+	// Create framebuffer for HDR rendering, and the tone mapped result that is presented every frame
 	Framebuffer hdrFramebuffer;
-	hdrFramebuffer.create(windowWidth, windowHeight, true);
+	hdrFramebuffer.create(windowWidth, windowHeight, hdrTarget.beginFrame());
+	Framebuffer ldrFramebuffer;
+	ldrFramebuffer.create(windowWidth, windowHeight, false);
+	computeTonemap.create(windowWidth, windowHeight);
+
+	// Fingerprints of what the cached targets hold; the first frame always renders
+	uint64_t renderedSceneHash = 0;
+	uint64_t renderedPostHash = 0;
+	uint64_t renderedScopeHash = 0;
+	bool targetsValid = false;
+	int graceFrames = kIdleGraceFrames;
 
 	// Camera settings
 	float cameraPos[3] = { 0.0f, 0.0f, 3.0f };
@@ -195,17 +856,17 @@ int main()
 	// Wireframe mode
 	bool wireframeMode = false;
 
-	// Main render loop
-	while (true)
-	{
-		// Process input
-		processInput(window);
+	// CLUT name of the replayed frame, kept so long names are not allocated again every frame
+	std::string replayClutName;
 
+	// Main render loop, runs until the window asks to close; while idle it sleeps until input arrives
+	while (processInput(applicationIdle))
+	{
 		// Calculate delta time for smooth animation
 		stats = bgfx::getStats();
 		const double toMsCpu = 1000.0 / stats->cpuTimerFreq;
 		const double toMsGpu = 1000.0 / stats->gpuTimerFreq;
-		const double frameMs = double(stats->cpuTimeFrame) * toMsCpu;
+		const double frameMs = frameReplay.isOpen() ? kReplayStepMs : double(stats->cpuTimeFrame) * toMsCpu;
 		int64_t deltaTime = stats->cpuTimeFrame;
 		lastFrameTime = frameMs;
 
@@ -233,206 +894,814 @@ int main()
 			lightPos[2] = lightRotationRadius * sin(lightRotationAngle);
 		}
 
+		// A replay sets everything the UI and animation would, at the point where recording snapshots it
+		if (frameReplay.isOpen())
+		{
+			FrameInputs inputs;
+			if (frameReplay.next(inputs, replayClutName))
+			{
+				const auto preset = clutLibrary.find(replayClutName);
+				if (replayClutName != currentPreset && preset != clutLibrary.end())
+				{
+					selectClutPreset(*preset, currentClut, currentPreset, clut1DTexture, use3DCLUT, editingMode);
+				}
+				applyFrameInputs(inputs, cameraPos, wireframeMode, use3DCLUT);
+			}
+			else
+			{
+				frameReplay.close();
+				frameTimingLog.close();
+				if (exitAfterReplay)
+					break;
+			}
+		}
+		else if (frameRecorder.isRecording())
+		{
+			frameRecorder.record(captureFrameInputs(cameraPos, wireframeMode, use3DCLUT), currentPreset);
+		}
+
+		// Run continuations queued by jobs, e.g. texture creation for a CLUT that finished loading
+		JobSystem::setSingleThreaded(jobsSingleThreaded);
+		JobSystem::pumpMainThread();
+
+		// Upload LOD chains that finished building since the last frame
+		bool lodsUpdated = cube.updateLods();
+		lodsUpdated |= sphere.updateLods();
+		lodsUpdated |= plane.updateLods();
+
 		// Check if framebuffer needs to be resized
 		if (framebufferResized)
 		{
-			hdrFramebuffer.resize(windowWidth, windowHeight);
+			ldrFramebuffer.resize(windowWidth, windowHeight);
+			if (computeTonemap.isValid())
+			{
+				computeTonemap.resize(windowWidth, windowHeight);
+			}
 			BgfxUtils::resize(windowWidth, windowHeight);
+			dynamicResolution.reset();
 			framebufferResized = false;
+			targetsValid = false;
 		}
 
-		// Begin bgfx frame
-		BgfxUtils::beginFrame();
-
-		// Set wireframe mode if needed
-		uint64_t state = BGFX_STATE_DEFAULT;
-		if (wireframeMode)
+		// The scene target follows the dynamic resolution scale and the selected HDR tier, or the one being
+		// benchmarked; the LDR target and everything drawn into it stay at native resolution
+		dynamicResolution.getRenderSize(windowWidth, windowHeight, sceneWidth, sceneHeight);
+		const bgfx::TextureFormat::Enum hdrFormat = hdrTarget.beginFrame();
+		if (hdrFramebuffer.getColorFormat() != hdrFormat || hdrFramebuffer.getWidth() != sceneWidth || hdrFramebuffer.getHeight() != sceneHeight)
 		{
-			state = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LESS | BGFX_STATE_MSAA | BGFX_STATE_PT_LINES;
+			hdrFramebuffer.create(sceneWidth, sceneHeight, hdrFormat);
+			targetsValid = false;
 		}
 
-		// First pass: Render scene to HDR framebuffer
-		hdrFramebuffer.bind();
-
-		// Clear framebuffer
-		bgfx::setViewClear(kSceneView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x0c0c0cff, 1.0f, 0);
-		bgfx::setViewRect(kSceneView, 0, 0, windowWidth, windowHeight);
-
-		// View matrix (camera)
-		float view[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -cameraPos[0], -cameraPos[1], -cameraPos[2], 1.0f };
-
-		// Projection matrix
-		float aspectRatio = static_cast<float>(windowWidth) / windowHeight;
-		float fov = 45.0f * 3.14159f / 180.0f;
-		float nearplane = 0.1f;
-		float farplane = 100.0f;
-		float tanHalfFov = tan(fov / 2.0f);
-
-		float proj[16] = { 1.0f / (aspectRatio * tanHalfFov), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f / tanHalfFov, 0.0f, 0.0f, 0.0f, 0.0f, -(farplane + nearplane) / (farplane - nearplane), -1.0f, 0.0f, 0.0f, -(2.0f * farplane * nearplane) / (farplane - nearplane), 0.0f };
-
-		bgfx::setViewTransform(kSceneView, view, proj);
-
-		// Model matrix with rotation
-		float cosY = cos(modelRotation[1]);
-		float sinY = sin(modelRotation[1]);
-		float cosX = cos(modelRotation[0]);
-		float sinX = sin(modelRotation[0]);
-		float cosZ = cos(modelRotation[2]);
-		float sinZ = sin(modelRotation[2]);
-
-		float model[16] = { 0 };
-		model[0] = cosY * cosZ;
-		model[1] = cosY * sinZ;
-		model[2] = -sinY;
-		model[4] = sinX * sinY * cosZ - cosX * sinZ;
-		model[5] = sinX * sinY * sinZ + cosX * cosZ;
-		model[6] = sinX * cosY;
-		model[8] = cosX * sinY * cosZ + sinX * sinZ;
-		model[9] = cosX * sinY * sinZ - sinX * cosZ;
-		model[10] = cosX * cosY;
-		model[15] = 1.0f;
-
-		// Set uniforms for scene shader
-		sceneShader.setUniform("lightPos", lightPos);
-		sceneShader.setUniform("lightColor", lightColor);
-		sceneShader.setUniform("lightIntensity", &lightIntensity);
-		sceneShader.setUniform("ambientStrength", &ambientStrength);
-		sceneShader.setUniform("sceneType", &sceneType, 1);
-
-		// Set transform for the model
-		bgfx::setTransform(model);
-
-		// Draw the appropriate geometry based on scene type
-		if (sceneType == 0)
+		// Frames that recreate targets or upload new data allocate legitimately
+		const bool targetsReused = targetsValid && !lodsUpdated;
+
+		// Everything the scene pass reads; animation shows up here through the rotation and light position
+		uint64_t sceneHash = 0xcbf29ce484222325ull;
+		sceneHash = hashValue(sceneHash, sceneType);
+		sceneHash = hashBytes(sceneHash, lightPos, sizeof(lightPos));
+		sceneHash = hashBytes(sceneHash, lightColor, sizeof(lightColor));
+		sceneHash = hashValue(sceneHash, lightIntensity);
+		sceneHash = hashValue(sceneHash, ambientStrength);
+		sceneHash = hashBytes(sceneHash, modelRotation, sizeof(modelRotation));
+		sceneHash = hashBytes(sceneHash, cameraPos, sizeof(cameraPos));
+		sceneHash = hashValue(sceneHash, wireframeMode);
+		sceneHash = hashValue(sceneHash, enableLod);
+		sceneHash = hashValue(sceneHash, lodPixelThreshold);
+		sceneHash = hashValue(sceneHash, enableMeshlets);
+		sceneHash = hashValue(sceneHash, enableInstancing);
+		sceneHash = hashValue(sceneHash, instanceLayout);
+		sceneHash = hashValue(sceneHash, perDrawSubmission);
+		sceneHash = hashValue(sceneHash, submitThreads);
+		sceneHash = hashValue(sceneHash, enableOcclusionCulling);
+		sceneHash = hashValue(sceneHash, maxOccluders);
+		sceneHash = hashValue(sceneHash, depthPrepass.getMode());
+		sceneHash = hashValue(sceneHash, enableGpuDriven);
+		sceneHash = hashValue(sceneHash, gpuOcclusionCulling);
+		sceneHash = hashValue(sceneHash, stressLightPreset);
+		sceneHash = hashValue(sceneHash, stressLightRadius);
+		sceneHash = hashValue(sceneHash, dynamicResolutionSettings.enabled);
+
+		// Everything the tonemap pass reads besides the HDR image
+		uint64_t postHash = 0xcbf29ce484222325ull;
+		postHash = hashValue(postHash, exposure);
+		postHash = hashValue(postHash, clutStrength);
+		postHash = hashValue(postHash, tonemapOperator);
+		postHash = hashValue(postHash, applyClut);
+		postHash = hashValue(postHash, splitScreen);
+		postHash = hashValue(postHash, splitPosition);
+		postHash = hashValue(postHash, use3DCLUT);
+		postHash = hashValue(postHash, clutRevision);
+		postHash = hashValue(postHash, compareMode);
+		postHash = hashValue(postHash, clutCompare.getRevision());
+		postHash = hashValue(postHash, autoExposureEnabled);
+		postHash = hashValue(postHash, autoExposureSettings);
+		postHash = hashValue(postHash, dynamicResolutionSettings.sharpness);
+		postHash = hashValue(postHash, useComputeTonemap);
+
+		// Auto prepass timing needs a stream of scene frames to finish its measurement
+		const bool sceneDirty = !renderOnDemand || !targetsValid || lodsUpdated || sceneHash != renderedSceneHash || depthPrepass.isMeasuring() || hdrTarget.isBenchmarking() || frameReplay.isOpen();
+		// Auto exposure keeps tonemapping every frame until it settles on a new image
+		const double now = glfwGetTime();
+		if (sceneDirty || postHash != renderedPostHash)
 		{
-			cube.draw(sceneShader);
+			autoExposure.markChanged(now);
 		}
-		else if (sceneType == 1)
+		const bool exposureActive = autoExposureEnabled && autoExposure.isValid();
+		const bool exposureAdapting = exposureActive && autoExposure.isAdapting(now, autoExposureSettings);
+		const bool postDirty = sceneDirty || postHash != renderedPostHash || exposureAdapting;
+
+		// Scopes are measured again whenever the image they read or their settings change
+		uint64_t scopeHash = hashValue(0xcbf29ce484222325ull, scopeSource);
+		scopeHash = hashValue(scopeHash, gpuScopes.getDensity());
+		const bool scopesDirty = showScopesWindow && gpuScopes.isValid() && (postDirty || scopeHash != renderedScopeHash);
+
+		// Same inputs as the last rendered frame, whether or not this one renders again, e.g. with render on
+		// demand off or while the exposure adapts
+		const bool inputsUnchanged = sceneHash == renderedSceneHash && postHash == renderedPostHash && (!showScopesWindow || scopeHash == renderedScopeHash);
+		const bool thumbnailsPending = clutThumbnails.isDirty();
+
+		// Keep presenting while the user interacts or a load is in flight, then for a few frames more
+		if (sceneDirty || postDirty || scopesDirty || inputChanged || frameExporter.isBusy() || batchGrader.isBusy() || clutLoadPending || clutThumbnails.isDirty())
 		{
-			sphere.draw(sceneShader);
+			graceFrames = kIdleGraceFrames;
 		}
-		else
+		else if (graceFrames > 0)
 		{
-			plane.draw(sceneShader);
+			--graceFrames;
 		}
 
-		// Second pass: Apply tone mapping and CLUT to the HDR image
-		hdrFramebuffer.unbind();
+		if (graceFrames == 0)
+		{
+			// Nothing to show: skip the frame and wake the render thread so it presents the last one right away
+			if (!applicationIdle)
+			{
+				applicationIdle = true;
+				glfwPostEmptyEvent();
+			}
 
-		// Clear the backbuffer
-		bgfx::setViewClear(kPostProcessView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x000000ff, 1.0f, 0);
-		bgfx::setViewRect(kPostProcessView, 0, 0, windowWidth, windowHeight);
+			// Idle iterations are steady by definition, so the zero allocation check settles while nothing is drawn
+			AllocationTracker::endFrame(targetsReused && !frameRecorder.isRecording());
+			continue;
+		}
 
-		// Set the orthographic projection for post-processing
-		float orthoProj[16] = { 2.0f / windowWidth, 0.0f, 0.0f, 0.0f, 0.0f, -2.0f / windowHeight, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f, 1.0f };
+		// The timings bgfx reports lag a frame, so the first frame after idle reads ones from before it
+		const bool resumedFromIdle = applicationIdle;
+		if (applicationIdle)
+		{
+			applicationIdle = false;
+			dynamicResolution.reset();
+			glfwPostEmptyEvent();
+		}
 
-		float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+		// Begin bgfx frame; only the present view is touched, the scene view would clear the cached HDR image
+		AllocationTracker::setSubsystem(AllocationSubsystem::Scene);
+		BgfxUtils::beginFrame(kPostProcessView);
+		bool prepassSupported = false;
 
-		bgfx::setViewTransform(kPostProcessView, identity, orthoProj);
+		if (sceneDirty)
+		{
+			// Set wireframe mode if needed
+			uint64_t state = BGFX_STATE_DEFAULT;
+			if (wireframeMode)
+			{
+				state = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LESS | BGFX_STATE_MSAA | BGFX_STATE_PT_LINES;
+			}
 
-		// Set HDR framebuffer texture
-		tonemapShader.setTexture("hdrBuffer", hdrFramebuffer.getColorTexture(), 0);
+			// First pass: Render scene to HDR framebuffer
+			hdrFramebuffer.bind(kSceneView);
 
-		// Set CLUT textures
-		tonemapShader.setTexture("colorLUT1D", clut1DTexture, 1);
-		tonemapShader.setTexture("colorLUT3D", clut3DTexture, 2);
+			// Clear framebuffer
+			bgfx::setViewClear(kSceneView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x0c0c0cff, 1.0f, 0);
+			bgfx::setViewRect(kSceneView, 0, 0, sceneWidth, sceneHeight);
 
-		// Set tone mapping parameters
-		tonemapShader.setUniform("exposure", &exposure);
-		tonemapShader.setUniform("clutStrength", &clutStrength);
+			// View matrix (camera)
+			float view[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -cameraPos[0], -cameraPos[1], -cameraPos[2], 1.0f };
 
-		int tonemapOp = tonemapOperator;
-		tonemapShader.setUniform("tonemapOperator", &tonemapOp, 1);
+			// Projection matrix
+			float aspectRatio = static_cast<float>(windowWidth) / windowHeight;
+			float fov = 45.0f * 3.14159f / 180.0f;
+			float nearplane = 0.1f;
+			float farplane = 100.0f;
+			float tanHalfFov = tan(fov / 2.0f);
 
-		int splitScreenInt = splitScreen ? 1 : 0;
-		tonemapShader.setUniform("splitScreen", &splitScreenInt, 1);
+			float proj[16] = { 1.0f / (aspectRatio * tanHalfFov), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f / tanHalfFov, 0.0f, 0.0f, 0.0f, 0.0f, -(farplane + nearplane) / (farplane - nearplane), -1.0f, 0.0f, 0.0f, -(2.0f * farplane * nearplane) / (farplane - nearplane), 0.0f };
 
-		tonemapShader.setUniform("splitPosition", &splitPosition);
+			bgfx::setViewTransform(kSceneView, view, proj);
 
-		int showClutInt = showClut ? 1 : 0;
-		tonemapShader.setUniform("showClut", &showClutInt, 1);
+			// Assign the stress lights to clusters for this camera
+			if (stressLightPreset != builtStressPreset || stressLightRadius != builtStressRadius)
+			{
+				ClusteredLights::generateStressLights(kStressLightCounts[stressLightPreset], stressLightRadius, stressLights);
+				clusteredLights.setLights(stressLights);
+				builtStressPreset = stressLightPreset;
+				builtStressRadius = stressLightRadius;
+			}
+			clusteredLights.update(view, proj, nearplane, farplane);
+			clusteredLightCount = clusteredLights.getLightCount();
+			clusteredIndexCount = clusteredLights.getIndexCount();
+			clusteredMaxPerCluster = clusteredLights.getMaxClusterLights();
+			clusterAssignMs = clusteredLights.getAssignTime();
+
+			// Model matrix with rotation
+			float cosY = cos(modelRotation[1]);
+			float sinY = sin(modelRotation[1]);
+			float cosX = cos(modelRotation[0]);
+			float sinX = sin(modelRotation[0]);
+			float cosZ = cos(modelRotation[2]);
+			float sinZ = sin(modelRotation[2]);
+
+			float model[16] = { 0 };
+			model[0] = cosY * cosZ;
+			model[1] = cosY * sinZ;
+			model[2] = -sinY;
+			model[4] = sinX * sinY * cosZ - cosX * sinZ;
+			model[5] = sinX * sinY * sinZ + cosX * cosZ;
+			model[6] = sinX * cosY;
+			model[8] = cosX * sinY * cosZ + sinX * sinZ;
+			model[9] = cosX * sinY * sinZ - sinX * cosZ;
+			model[10] = cosX * cosY;
+			model[15] = 1.0f;
+
+			// Set uniforms for scene shader
+			sceneShader.setUniform("lightPos", lightPos);
+			sceneShader.setUniform("lightColor", lightColor);
+			sceneShader.setUniform("lightIntensity", &lightIntensity);
+			sceneShader.setUniform("ambientStrength", &ambientStrength);
+			sceneShader.setUniform("sceneType", &sceneType, 1);
+
+			// Set transform for the model
+			bgfx::setTransform(model);
+
+			// Draw the appropriate geometry based on scene type
+			Geometry* sceneGeometry = &plane;
+			if (sceneType == 0)
+			{
+				sceneGeometry = &cube;
+			}
+			else if (sceneType == 1)
+			{
+				sceneGeometry = &sphere;
+			}
 
-		int applyClutInt = applyClut ? 1 : 0;
-		tonemapShader.setUniform("applyClut", &applyClutInt, 1);
+			// Pick the level of detail from the projected screen space error
+			LodSelection lodSelection = { { cameraPos[0], cameraPos[1], cameraPos[2] }, MeshLod::projectionScale(fov, windowHeight), lodPixelThreshold };
+			activeLod = enableLod ? sceneGeometry->selectLod(model, lodSelection) : 0;
+			activeLodCount = sceneGeometry->getLodCount();
+			activeTriangles = sceneGeometry->getTriangleCount(activeLod);
 
-		int use3DCLUTInt = use3DCLUT ? 1 : 0;
-		tonemapShader.setUniform("use3DCLUT", &use3DCLUTInt, 1);
+			const bool useGpuDriven = enableGpuDriven && gpuDrivenSupported;
+			if ((useGpuDriven || enableInstancing) && instanceLayout != builtInstanceLayout)
+			{
+				SceneInstances::generate(instanceLayout, sceneInstances);
+				if (gpuDrivenSupported)
+				{
+					fillGpuScene(gpuScene, cubeBatch, sphereBatch, sceneInstances);
+				}
+				builtInstanceLayout = instanceLayout;
+				instanceCullerGeometry = nullptr;
+			}
 
-		int clutSize = currentClut.getSize();
-		tonemapShader.setUniform("clutSize", &clutSize, 1);
+			// Depth prepass: lay down depth from the position-only stream, then shade only the visible surface
+			// with an EQUAL depth test. Wireframe lines would not match the filled depth, so it is skipped there.
+			const bool perDrawPath = !useGpuDriven && enableInstancing && perDrawSubmission;
+			prepassSupported = !useGpuDriven && (enableInstancing || !enableMeshlets) && !wireframeMode && !perDrawPath;
+			const uint64_t sceneKey = uint64_t(sceneType) | (uint64_t(enableInstancing) << 4) | (uint64_t(instanceLayout.placement) << 5) | (uint64_t(instanceLayout.count) << 8);
+			const bool usePrepass = prepassSupported && depthPrepass.beginFrame(sceneKey);
 
-		// Draw screen quad with tonemap shader
-		screenQuad.draw(tonemapShader);
+			const uint64_t depthState = BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LESS | BGFX_STATE_MSAA | (state & BGFX_STATE_CULL_MASK);
+			// Per-draw submission sorts by draw index so the result does not depend on the thread split
+			bgfx::setViewMode(kSceneView, perDrawPath ? bgfx::ViewMode::DepthAscending : bgfx::ViewMode::Default);
 
-		// Start ImGui frame
-		ImGui_ImplBgfx_NewFrame();
-		ImGui::NewFrame();
+			uint64_t colorState = state;
+			if (usePrepass)
+			{
+				// The prepass view renders to the same target as the scene view and runs right before it
+				hdrFramebuffer.bind(kDepthPrepassView);
+				bgfx::setViewClear(kDepthPrepassView, BGFX_CLEAR_DEPTH, 0, 1.0f, 0);
+				bgfx::setViewRect(kDepthPrepassView, 0, 0, sceneWidth, sceneHeight);
+				bgfx::setViewTransform(kDepthPrepassView, view, proj);
+				bgfx::setViewClear(kSceneView, BGFX_CLEAR_COLOR, 0x0c0c0cff, 1.0f, 0);
+				colorState = (state & ~(BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_MASK)) | BGFX_STATE_DEPTH_TEST_EQUAL;
+			}
 
-		// Render the modern ImGui interface with dockspace
-		renderImGuiInterface(clutLibrary, currentClut, currentPreset, clut1DTexture, clut3DTexture, use3DCLUT, customLutName, editingMode, cameraPos);
+			if (useGpuDriven)
+			{
+				float viewProj[16];
+				bx::mtxMul(viewProj, view, proj);
+
+				// Cull on the GPU, draw one indirect call per batch, then keep this frame's depth for next frame
+				gpuScene.setOcclusionEnabled(gpuOcclusionCulling);
+				gpuScene.cull(kCullView, viewProj);
+				clusteredLights.bind();
+				gpuScene.draw(kSceneView, instancedSceneShader.m_program, state);
+				gpuScene.buildHiZ(kHiZView, hdrFramebuffer.getDepthTexture(), sceneWidth, sceneHeight);
+				gpuDrawCalls = gpuScene.getBatchCount();
+			}
+			else if (enableInstancing)
+			{
+				// Drop the instances outside the view with the SIMD sphere test, then draw the rest in one submit
+				const auto cullStart = std::chrono::high_resolution_clock::now();
+				if (instanceCullerGeometry != sceneGeometry)
+				{
+					buildInstanceBounds(instanceCuller, *sceneGeometry, sceneInstances);
+					instanceCullerGeometry = sceneGeometry;
+				}
 
-		// Render ImGui
-		ImGui::Render();
-		ImGui_ImplBgfx_RenderDrawData(ImGui::GetDrawData());
+				const float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+				frustumTestedInstances = instanceCuller.getCount();
+				frustumVisibleInstances = instanceCuller.cull(Frustum::fromMatrices(view, proj), identity, frustumVisible);
+				frustumInstances.resize(frustumVisibleInstances);
+				for (uint32_t i = 0; i < frustumVisibleInstances; ++i)
+				{
+					frustumInstances[i] = sceneInstances[frustumVisible[i]];
+				}
+				frustumCullMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - cullStart).count();
 
-		// End bgfx frame
-		BgfxUtils::endFrame();
+				uint32_t count = static_cast<uint32_t>(std::min<size_t>(frustumInstances.size(), SceneInstances::kMaxTransientInstances));
+				const InstanceData* instances = frustumInstances.data();
 
-		// Poll events
-		// Replace glfwPollEvents() with a custom event polling mechanism if needed
-	}
+				if (enableOcclusionCulling)
+				{
+					float viewProj[16];
+					bx::mtxMul(viewProj, view, proj);
 
-	// Cleanup
-	ImGui_ImplBgfx_Shutdown();
-	ImGui::DestroyContext();
+					cullOccludedInstances(occlusionCuller, *sceneGeometry, viewProj, cameraPos, instances, count, unoccludedInstances);
+					occludedInstances = occlusionCuller.getCulledCount();
+					occlusionOccluders = occlusionCuller.getOccluderCount();
+					occlusionRasterizeMs = occlusionCuller.getRasterizeTime();
 
-	// Delete CLUT textures
-	if (bgfx::isValid(clut1DTexture))
-	{
-		bgfx::destroy(clut1DTexture);
-	}
+					instances = unoccludedInstances.data();
+					count = static_cast<uint32_t>(unoccludedInstances.size());
+				}
 
-	if (bgfx::isValid(clut3DTexture))
-	{
-		bgfx::destroy(clut3DTexture);
-	}
+				activeLod = 0;
+				if (perDrawPath)
+				{
+					// One draw per instance recorded on worker threads
+					submitStats = ParallelSubmit::submit(*sceneGeometry, instancedSceneShader.m_program, colorState, instances, count, 0, &clusteredLights, submitThreads);
+					instancesDrawn = submitStats.draws;
+				}
+				else
+				{
+					if (usePrepass)
+					{
+						sceneGeometry->drawDepthInstanced(kDepthPrepassView, depthInstancedShader.m_program, depthState, instances, count);
+					}
+					clusteredLights.bind();
+					instancesDrawn = count > 0 ? sceneGeometry->drawInstanced(instancedSceneShader.m_program, colorState, instances, count) : 0;
+				}
+				activeTriangles = sceneGeometry->getTriangleCount(0) * instancesDrawn;
+			}
+			else if (enableMeshlets)
+			{
+				// Cull meshlets of the full detail mesh and draw the survivors in one submit
+				Frustum frustum = Frustum::fromMatrices(view, proj);
+				activeLod = 0;
+				clusteredLights.bind();
+				activeTriangles = sceneGeometry->drawMeshlets(sceneShader.m_program, state, model, frustum, cameraPos);
+				visibleMeshlets = sceneGeometry->getVisibleMeshletCount();
+				totalMeshlets = sceneGeometry->getMeshletCount();
+			}
+			else
+			{
+				if (usePrepass)
+				{
+					// The prepass submit consumes the transform, set it again for the colour pass
+					sceneGeometry->drawDepth(kDepthPrepassView, depthShader.m_program, depthState, activeLod);
+					bgfx::setTransform(model);
+				}
+				clusteredLights.bind();
+				sceneGeometry->draw(sceneShader.m_program, colorState, activeLod);
+			}
+		}
 
-	// Clean up geometry
-	cube.~Geometry();
-	sphere.~Geometry();
-	plane.~Geometry();
-	screenQuad.~Geometry();
+		// Second pass: Apply tone mapping and CLUT to the HDR image, into the LDR target or the compute image
+		AllocationTracker::setSubsystem(AllocationSubsystem::Post);
+		const bool tonemapCompute = useComputeTonemap && computeTonemap.isValid();
+		const bgfx::TextureHandle ldrTexture = tonemapCompute ? computeTonemap.getTexture() : ldrFramebuffer.getColorTexture();
+		if (postDirty)
+		{
+			// Measure and adapt before the tonemap draw reads the exposure texel, a long idle gap counts as one short step
+			if (exposureActive)
+			{
+				const float exposureDelta = static_cast<float>(std::min(frameMs / 1000.0, 0.1));
+				autoExposure.update(kExposureView, hdrFramebuffer.getColorTexture(), sceneWidth, sceneHeight, exposureDelta, autoExposureSettings);
+			}
 
-	// Clean up framebuffer
-	hdrFramebuffer.cleanup();
+			// The compute path writes every pixel of its image, only the raster path needs the target bound and cleared
+			if (!tonemapCompute)
+			{
+				ldrFramebuffer.bind(kTonemapView);
+				bgfx::setViewClear(kTonemapView, BGFX_CLEAR_COLOR, 0x000000ff, 1.0f, 0);
 
-	// Shutdown bgfx
-	BgfxUtils::shutdown();
+				// Set the orthographic projection for post-processing
+				float orthoProj[16] = { 2.0f / windowWidth, 0.0f, 0.0f, 0.0f, 0.0f, -2.0f / windowHeight, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f, 1.0f };
 
-	return 0;
-}
+				float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
 
-void initImGui()
-{
-	// Setup Dear ImGui context
-	IMGUI_CHECKVERSION();
-	ImGui::CreateContext();
-	ImGuiIO& io = ImGui::GetIO();
+				bgfx::setViewTransform(kTonemapView, identity, orthoProj);
+			}
 
-	// Enable docking
-	io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+			// Set HDR framebuffer texture
+			tonemapShader.setTexture("s_hdrBuffer", hdrFramebuffer.getColorTexture(), 0);
 
-	// Enable keyboard navigation
-	io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+			// A scaled scene target is upscaled by the bilinear fetch, then sharpened against its neighbours
+			const bool upscaling = sceneWidth != windowWidth || sceneHeight != windowHeight;
+			const float upscale[4] = { 1.0f / sceneWidth, 1.0f / sceneHeight, upscaling ? dynamicResolutionSettings.sharpness : 0.0f, 0.0f };
+			tonemapShader.setUniform("u_upscale", upscale);
 
-	// Setup custom fonts and styling
-	ImGuiUtils::InitializeImGui(io);
+			// Set CLUT textures, the 3D one is the atlas page holding the active CLUT
+			const bool sample3DCLUT = use3DCLUT && activeClut3D.isValid();
+			tonemapShader.setTexture("s_colorLUT1D", clut1DTexture, 1);
+			tonemapShader.setTexture("s_colorLUT3D", activeClut3D.texture, 2);
 
-	// Apply Gruvbox theme
-	ImGuiUtils::SetGruvboxTheme();
+			// Set tone mapping parameters, packed the way tonemap.frag.sc reads them
+			const float params[4] = { exposure, clutStrength, float(tonemapOperator), splitPosition };
+			tonemapShader.setUniform("u_params", params);
 
-	// Setup Platform/Renderer backends - using bgfx instead of OpenGL
-	ImGui_ImplBgfx_Init(kPostProcessView); // Use bgfx renderer
+			tonemapShader.setTexture("s_autoExposure", autoExposure.getTexture(), 4);
+
+			const float flags[4] = { splitScreen ? 1.0f : 0.0f, exposureActive ? 1.0f : 0.0f, applyClut && (sample3DCLUT || !use3DCLUT) ? 1.0f : 0.0f, sample3DCLUT ? 1.0f : 0.0f };
+			tonemapShader.setUniform("u_flags", flags);
+
+			float clutParams[4] = { float(currentClut.getSize()), 0.0f, 1.0f, 0.0f };
+			if (sample3DCLUT)
+			{
+				activeClut3D.getParams(clutParams);
+			}
+			tonemapShader.setUniform("u_clutParams", clutParams);
+
+			// Comparing N candidates is still this one draw, the region picks the slot per pixel
+			clutCompare.bind(3, 6, compareMode && clutCompare.getCount() > 0);
+
+			// Draw screen quad with tonemap shader, or run the same grading as 8x8 compute tiles
+			if (tonemapCompute)
+			{
+				computeTonemap.dispatch(kTonemapView);
+			}
+			else
+			{
+				screenQuad.drawInView(kTonemapView, tonemapShader.m_program, BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
+			}
+
+			renderedPostHash = postHash;
+			++postPasses;
+		}
+
+		if (sceneDirty)
+		{
+			renderedSceneHash = sceneHash;
+			targetsValid = true;
+			++scenePasses;
+		}
+
+		// Measure the freshly rendered image; the scope images stay valid while nothing changes
+		if (scopesDirty)
+		{
+			if (scopeSource == 0)
+			{
+				gpuScopes.update(kScopeView, ldrTexture, windowWidth, windowHeight, false, 1.0f);
+			}
+			else
+			{
+				gpuScopes.update(kScopeView, hdrFramebuffer.getColorTexture(), sceneWidth, sceneHeight, true, exposure);
+			}
+			renderedScopeHash = scopeHash;
+		}
+		else if (!showScopesWindow)
+		{
+			renderedScopeHash = 0;
+		}
+
+		// Copy the frame into the export ring; the read back lands a few frames later without waiting on it
+		if (frameExporter.isRecording())
+		{
+			if (frameExportSettings.source == FrameExporter::Source::SceneHdr)
+			{
+				frameExporter.capture(kExportView, hdrFramebuffer.getColorTexture(), sceneWidth, sceneHeight, hdrFramebuffer.getColorFormat());
+			}
+			else
+			{
+				frameExporter.capture(kExportView, ldrTexture, windowWidth, windowHeight, bgfx::TextureFormat::RGBA8);
+			}
+		}
+
+		// Present the cached LDR target to the backbuffer, the UI draws on top in the same view
+		bgfx::setViewClear(kPostProcessView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x000000ff, 1.0f, 0);
+		bgfx::setViewRect(kPostProcessView, 0, 0, windowWidth, windowHeight);
+		bgfx::setTexture(0, presentSampler, ldrTexture);
+		screenQuad.drawInView(kPostProcessView, presentShader.m_program, BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
+		++presentedFrames;
+
+		// Regrade the browser thumbnails when a CLUT was added or changed
+		clutThumbnails.render(kThumbnailView, screenQuad);
+
+		// Headless replays time the renderer alone
+		if (!replayHeadless)
+		{
+			AllocationScope allocationScope(AllocationSubsystem::Ui);
+
+			// Start ImGui frame
+			ImGui_ImplBgfx_NewFrame();
+			ImGui::NewFrame();
+
+			// Render the modern ImGui interface with dockspace
+			renderImGuiInterface(clutLibrary, currentClut, currentPreset, clut1DTexture, use3DCLUT, customLutName, editingMode, cameraPos);
+
+			// Render ImGui
+			ImGui::Render();
+			ImGui_ImplBgfx_RenderDrawData(ImGui::GetDrawData());
+		}
+
+		// End bgfx frame, then pass the export read backs that have landed to the encoder
+		AllocationTracker::setSubsystem(AllocationSubsystem::App);
+		const uint32_t frameNumber = BgfxUtils::endFrame();
+		frameExporter.update(frameNumber);
+
+		// A frame with the inputs of the last one repeats it and should not allocate, also when it renders the scene
+		// and post chain again; input, loads, exports, recordings, measurements and new targets are not held to that
+		const bool steadyFrame = targetsReused && inputsUnchanged && !inputChanged && !clutLoadPending && !thumbnailsPending && !batchGrader.isBusy() && !frameExporter.isBusy() && !frameRecorder.isRecording() && !frameReplay.isOpen() && !hdrTarget.isBenchmarking() && !depthPrepass.isMeasuring();
+		AllocationTracker::endFrame(steadyFrame);
+
+		// Time the prepass and scene views, for the light stress test and the Auto prepass mode; frames that
+		// reuse the cached scene keep the last timing
+		stats = bgfx::getStats();
+		gpuFrameMs = static_cast<float>(double(stats->gpuTimeEnd - stats->gpuTimeBegin) * toMsGpu);
+		apiWaitRenderMs = static_cast<float>(double(stats->waitRender) * toMsCpu);
+		renderWaitSubmitMs = static_cast<float>(double(stats->waitSubmit) * toMsCpu);
+		for (uint16_t i = 0; i < stats->numViews; ++i)
+		{
+			const bgfx::ViewStats& viewStats = stats->viewStats[i];
+			const float viewGpuMs = static_cast<float>(double(viewStats.gpuTimeEnd - viewStats.gpuTimeBegin) * toMsGpu);
+			if (scopesDirty && viewStats.view == kScopeView)
+			{
+				scopeGpuMs = viewGpuMs;
+			}
+			else if (postDirty && exposureActive && viewStats.view == kExposureView)
+			{
+				autoExposureGpuMs = viewGpuMs;
+			}
+			else if (postDirty && viewStats.view == kTonemapView)
+			{
+				tonemapGpuMs[tonemapCompute ? 1 : 0] = viewGpuMs;
+			}
+		}
+
+		if (postDirty)
+		{
+			postGpuMs = 0.0f;
+			for (uint16_t i = 0; i < stats->numViews; ++i)
+			{
+				const bgfx::ViewStats& viewStats = stats->viewStats[i];
+				if (viewStats.view == kExposureView || viewStats.view == kTonemapView)
+				{
+					postGpuMs += static_cast<float>(double(viewStats.gpuTimeEnd - viewStats.gpuTimeBegin) * toMsGpu);
+				}
+			}
+		}
+
+		if (sceneDirty)
+		{
+			sceneGpuMs = 0.0f;
+			for (uint16_t i = 0; i < stats->numViews; ++i)
+			{
+				const bgfx::ViewStats& viewStats = stats->viewStats[i];
+				if (viewStats.view == kSceneView || viewStats.view == kDepthPrepassView)
+				{
+					sceneGpuMs += static_cast<float>(double(viewStats.gpuTimeEnd - viewStats.gpuTimeBegin) * toMsGpu);
+				}
+			}
+		}
+
+		if (prepassSupported)
+		{
+			depthPrepass.endFrame(sceneGpuMs);
+		}
+		hdrColorBytes = hdrFramebuffer.getColorMemory();
+		hdrTarget.endFrame(sceneGpuMs, postGpuMs, hdrColorBytes);
+
+		// Frames that reuse the cached scene say nothing about its cost, and neither do timings read right after
+		// idle or of a frame that skipped the scene views
+		if (sceneDirty && !resumedFromIdle && sceneGpuMs > 0.0f)
+		{
+			dynamicResolution.update(dynamicResolutionSettings, gpuFrameMs, sceneGpuMs);
+		}
+
+		if (frameTimingLog.isOpen())
+		{
+			const float cpuMs = static_cast<float>(double(stats->cpuTimeEnd - stats->cpuTimeBegin) * toMsCpu);
+			frameTimingLog.write(frameReplay.getFrameIndex(), cpuMs, gpuFrameMs, sceneGpuMs, postGpuMs, apiWaitRenderMs);
+		}
+
+		if (glfwGetTime() - jobStatsTime >= 0.5)
+		{
+			JobSystem::sampleStats(jobWorkerStats);
+			jobStatsTime = glfwGetTime();
+		}
+	}
+
+	// Delete CLUT textures
+	if (bgfx::isValid(clut1DTexture))
+	{
+		bgfx::destroy(clut1DTexture);
+	}
+
+	if (bgfx::isValid(clutPreviewTexture))
+	{
+		bgfx::destroy(clutPreviewTexture);
+	}
+
+	clutThumbnails.destroy();
+	clutAtlas.destroy();
+	clutCompare.destroy();
+
+	// Clean up GPU driven scene
+	gpuScene.destroy();
+	gpuScopes.destroy();
+	autoExposure.destroy();
+	computeTonemap.destroy();
+	frameExporter.destroy();
+	batchGrader.wait();
+	frameRecorder.stop();
+	frameTimingLog.close();
+	clusteredLights.destroy();
+
+	// Clean up framebuffers
+	hdrFramebuffer.cleanup();
+	ldrFramebuffer.cleanup();
+	bgfx::destroy(presentSampler);
+
+	// Geometry and shaders are released by their destructors on return, while bgfx is still running
+}
+
+// Application thread: the bgfx API thread, running input handling, simulation, UI and submission.
+// It only exchanges window state with the render thread through frame packets, so it never blocks on it.
+static int runApplication(void* nativeWindowHandle)
+{
+	// Initialize bgfx
+	if (!BgfxUtils::init(windowWidth, windowHeight, nativeWindowHandle))
+	{
+		std::cerr << "Failed to initialize bgfx" << std::endl;
+		return -1;
+	}
+
+	// Start the job system, this thread joins in as worker 0 whenever it waits on jobs
+	JobSystem::init(0, jobsSingleThreaded);
+
+	// Compute culling runs before the scene, the depth pyramid is built from it afterwards, exposure is
+	// measured before tonemapping, and the scopes measure the tonemapped image before the UI draws them
+	bgfx::ViewId viewOrder[] = { kCullView, kDepthPrepassView, kSceneView, kHiZView, kExposureView, kTonemapView, kScopeView, kExportView, kThumbnailView, kPostProcessView };
+	bgfx::setViewOrder(0, BX_COUNTOF(viewOrder), viewOrder);
+
+	// Initialize ImGui
+	initImGui();
+
+	runScene();
+
+	// Cleanup; finish outstanding jobs first, pending main thread continuations are dropped
+	JobSystem::shutdown();
+	ImGui_ImplBgfx_Shutdown();
+	ImGui::DestroyContext();
+
+	// Shutdown bgfx
+	BgfxUtils::shutdown();
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	AllocationTracker::install();
+
+	// --replay <log> plays a recorded session back and exits, writing per frame timings to --timings <csv>
+	// (the log path with .csv appended by default); --headless hides the window and skips the UI
+	std::string replayPath;
+	std::string timingsPath;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--replay" && i + 1 < argc)
+		{
+			replayPath = argv[++i];
+		}
+		else if (arg == "--timings" && i + 1 < argc)
+		{
+			timingsPath = argv[++i];
+		}
+		else if (arg == "--headless")
+		{
+			replayHeadless = true;
+		}
+		else
+		{
+			std::cerr << "Unknown argument " << arg << std::endl;
+		}
+	}
+
+	if (!replayPath.empty())
+	{
+		if (!frameReplay.open(replayPath) || !frameTimingLog.open(timingsPath.empty() ? replayPath + ".csv" : timingsPath))
+		{
+			return -1;
+		}
+		exitAfterReplay = true;
+	}
+	else
+	{
+		replayHeadless = false;
+	}
+
+	// Create a native window for bgfx using glfw
+	if (!glfwInit())
+	{
+		std::cerr << "Failed to initialize GLFW" << std::endl;
+		return -1;
+	}
+
+	// Set OpenGL version to 4.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, replayHeadless ? GLFW_FALSE : GLFW_TRUE);
+
+	// Create a windowed mode window and its OpenGL context
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "RenderAlchemy", NULL, NULL);
+	if (!window)
+	{
+		std::cerr << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// Make the window's context current
+	glfwMakeContextCurrent(window);
+
+	glfwSetScrollCallback(window, [](GLFWwindow*, double, double yOffset) { scrollTotal += static_cast<float>(yOffset); });
+
+	// Calling renderFrame before init keeps bgfx from creating a render thread of its own: this thread becomes
+	// the render thread, pumping window events and executing frames while the application runs on another one
+	bgfx::renderFrame();
+
+	publishFramePacket(window);
+	void* nativeWindowHandle = glfwNativeWindowHandle(window);
+	int exitCode = 0;
+	std::thread applicationThread([nativeWindowHandle, &exitCode]()
+	{
+		exitCode = runApplication(nativeWindowHandle);
+		applicationRunning = false;
+	});
+
+	while (applicationRunning)
+	{
+		// An idle application submits no frames, so sleep until the user does something
+		if (applicationIdle)
+		{
+			glfwWaitEventsTimeout(kIdleWaitSeconds);
+		}
+		else
+		{
+			glfwPollEvents();
+		}
+		publishFramePacket(window);
+
+		// Returns once a frame is rendered, or after the timeout so window events keep flowing during long frames
+		bgfx::renderFrame(kRenderFrameTimeoutMs);
+	}
+
+	// Finish bgfx's shutdown handshake before the window goes away
+	while (bgfx::RenderFrame::NoContext != bgfx::renderFrame())
+	{
+	}
+	applicationThread.join();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return exitCode;
+}
+
+void initImGui()
+{
+	// Setup Dear ImGui context
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+
+	// Enable docking
+	io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+
+	// Enable keyboard navigation
+	io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+
+	// Setup custom fonts and styling
+	ImGuiUtils::InitializeImGui(io);
+
+	// Apply Gruvbox theme
+	ImGuiUtils::SetGruvboxTheme();
+
+	// Setup Platform/Renderer backends - using bgfx instead of OpenGL
+	ImGui_ImplBgfx_Init(kPostProcessView); // Use bgfx renderer
 }
 
 void framebufferSizeCallback(int width, int height)
@@ -443,26 +1712,84 @@ void framebufferSizeCallback(int width, int height)
 	framebufferResized = true;
 }
 
-void processInput(GLFWwindow* window)
+void publishFramePacket(GLFWwindow* window)
 {
-	glfwPollEvents();
-
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
 		glfwSetWindowShouldClose(window, true);
 	}
 
-	// If the user wants to close the window
-	if (glfwWindowShouldClose(window))
+	FramePacket& packet = framePackets.write();
+	glfwGetFramebufferSize(window, &packet.framebufferWidth, &packet.framebufferHeight);
+
+	double mouseX, mouseY;
+	glfwGetCursorPos(window, &mouseX, &mouseY);
+	packet.mouseX = static_cast<float>(mouseX);
+	packet.mouseY = static_cast<float>(mouseY);
+	for (int button = 0; button < 3; ++button)
 	{
-		glfwTerminate();
-		exit(EXIT_SUCCESS);
+		packet.mouseDown[button] = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_1 + button) == GLFW_PRESS;
+	}
+
+	packet.scrollTotal = scrollTotal;
+	packet.closeRequested = glfwWindowShouldClose(window);
+	framePackets.publish();
+
+	{
+		std::lock_guard<std::mutex> lock(framePacketMutex);
+		++framePacketCount;
 	}
+	framePacketCondition.notify_one();
+}
+
+bool processInput(bool waitForInput)
+{
+	// An idle loop waits for the next packet, or wakes up after a while to pick up finished jobs
+	if (waitForInput)
+	{
+		std::unique_lock<std::mutex> lock(framePacketMutex);
+		framePacketCondition.wait_for(lock, std::chrono::duration<double>(kIdleWaitSeconds), []() { return framePacketCount != framePacketsRead; });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(framePacketMutex);
+		framePacketsRead = framePacketCount;
+	}
+
+	// Keep the previous packet when the render thread has not published a newer one
+	framePackets.acquire();
+	const FramePacket& packet = framePackets.read();
+	inputChanged = packet != lastFramePacket;
+	lastFramePacket = packet;
+
+	// Minimized windows report a zero size, keep rendering at the last one; a replay renders at the recorded size
+	if (!frameReplay.isOpen() && (packet.framebufferWidth != windowWidth || packet.framebufferHeight != windowHeight) && packet.framebufferWidth > 0 && packet.framebufferHeight > 0)
+	{
+		framebufferSizeCallback(packet.framebufferWidth, packet.framebufferHeight);
+	}
+
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = ImVec2(static_cast<float>(windowWidth), static_cast<float>(windowHeight));
+	io.AddMousePosEvent(packet.mouseX, packet.mouseY);
+	for (int button = 0; button < 3; ++button)
+	{
+		io.AddMouseButtonEvent(button, packet.mouseDown[button]);
+	}
+	if (packet.scrollTotal != lastScrollTotal)
+	{
+		io.AddMouseWheelEvent(0.0f, packet.scrollTotal - lastScrollTotal);
+		lastScrollTotal = packet.scrollTotal;
+	}
+
+	return !packet.closeRequested;
 }
 
 // Render the modern ImGui interface - updated parameter types for bgfx
-void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& currentClut, const char*& currentPreset, bgfx::TextureHandle& clut1DTexture, bgfx::TextureHandle& clut3DTexture, bool& use3DCLUT, char* customLutName, bool& editingMode, float* cameraPos)
+void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& currentClut, const char*& currentPreset, bgfx::TextureHandle& clut1DTexture, bool& use3DCLUT, char* customLutName, bool& editingMode, float* cameraPos)
 {
+	drawCompareOverlay();
+	renderScopesWindow();
+
 	// Tools panel (control panel)
 	if (showToolsWindow)
 	{
@@ -520,19 +1847,526 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 
 					ImGui::Checkbox("Auto-Rotate Model", &autoRotateModel);
 
-					if (autoRotateModel)
+					if (autoRotateModel)
+					{
+						ImGui::Text("Rotation Speed"); // Add separate label
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::SliderFloat("##ModelSpeed", &modelRotationSpeed, 0.1f, 2.0f, "%.2f");
+					}
+					else
+					{
+						ImGui::BeginDisabled(autoRotateModel);
+						ImGui::Text("Rotation Axes"); // Add separate label
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::SliderFloat3("##ModelRotation", modelRotation, -3.14159f, 3.14159f, "%.2f");
+						ImGui::EndDisabled();
+					}
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Light controls - with proper spacing
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_SUN);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.98f, 0.75f, 0.18f, 1.00f), "Lighting");
+
+					ImGui::Checkbox("Auto-Rotate Light", &autoRotateLight);
+
+					if (autoRotateLight)
+					{
+						// Better layout for light rotation controls with separate labels
+						ImGui::BeginGroup();
+						ImGui::Text("Speed");
+						ImGui::SetNextItemWidth(halfControlWidth);
+						ImGui::SliderFloat("##LightSpeed", &lightRotationSpeed, 0.1f, 2.0f, "%.2f");
+						ImGui::EndGroup();
+
+						ImGui::SameLine(halfControlWidth + 20.0f);
+
+						ImGui::BeginGroup();
+						ImGui::Text("Radius");
+						ImGui::SetNextItemWidth(halfControlWidth);
+						ImGui::SliderFloat("##LightRadius", &lightRotationRadius, 1.0f, 10.0f, "%.1f");
+						ImGui::EndGroup();
+					}
+					else
+					{
+						ImGui::BeginDisabled(autoRotateLight);
+						ImGui::Text("Position"); // Add separate label
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::SliderFloat3("##LightPosition", lightPos, -5.0f, 5.0f, "%.1f");
+						ImGui::EndDisabled();
+					}
+
+					// Light color controls with separate label
+					ImGui::Text("Light Color");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::ColorEdit3("##LightColor", lightColor);
+
+					ImGui::Spacing();
+
+					// Fixed layout for intensity and ambient with separate labels
+					ImGui::BeginGroup();
+					ImGui::Text("Intensity");
+					ImGui::SetNextItemWidth(halfControlWidth);
+					ImGui::SliderFloat("##LightIntensity", &lightIntensity, 0.0f, 5.0f, "%.2f");
+					ImGui::EndGroup();
+
+					ImGui::SameLine(halfControlWidth + 20.0f);
+
+					ImGui::BeginGroup();
+					ImGui::Text("Ambient");
+					ImGui::SetNextItemWidth(halfControlWidth);
+					ImGui::SliderFloat("##AmbientStrength", &ambientStrength, 0.0f, 1.0f, "%.2f");
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+
+					// Clustered light stress test
+					const char* stressItems[] = { "None", "1 Light", "100 Lights", "1000 Lights" };
+					ImGui::Text("Stress Lights");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::Combo("##StressLights", &stressLightPreset, stressItems, IM_ARRAYSIZE(stressItems));
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Scatter point lights over the scene; each pixel only shades the lights of its cluster");
+
+					ImGui::BeginDisabled(stressLightPreset == 0);
+					ImGui::Text("Light Range");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::SliderFloat("##StressLightRadius", &stressLightRadius, 0.5f, 8.0f, "%.1f");
+					ImGui::EndDisabled();
+
+					ImGui::Text("%u lights, %u cluster entries (max %u)", clusteredLightCount, clusteredIndexCount, clusteredMaxPerCluster);
+					ImGui::Text("Assign %.2f ms CPU, scene %.2f ms GPU", clusterAssignMs, sceneGpuMs);
+
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Level of detail controls
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_LAYERS);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Level of Detail");
+
+					ImGui::Checkbox("Automatic LOD", &enableLod);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Pick a simplified mesh based on its projected screen space error");
+
+					ImGui::BeginDisabled(!enableLod);
+					ImGui::Text("Max Error (pixels)");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::SliderFloat("##LodThreshold", &lodPixelThreshold, 0.1f, 16.0f, "%.1f");
+					ImGui::EndDisabled();
+
+					ImGui::Text("Level %d / %d, %u triangles", activeLod, activeLodCount - 1, activeTriangles);
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+
+					// Meshlet culling controls
+					ImGui::BeginGroup();
+					ImGui::Checkbox("Meshlet Culling", &enableMeshlets);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Split the mesh into small clusters and skip those outside the view or facing away");
+
+					if (enableMeshlets)
+						ImGui::Text("Meshlets %u / %u visible", visibleMeshlets, totalMeshlets);
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Depth prepass controls
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_LAYERS_2);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Depth Prepass");
+
+					const char* prepassItems[] = { "Off", "On", "Auto" };
+					int prepassMode = static_cast<int>(depthPrepass.getMode());
+					ImGui::SetNextItemWidth(fullControlWidth);
+					if (ImGui::Combo("##DepthPrepass", &prepassMode, prepassItems, IM_ARRAYSIZE(prepassItems)))
+						depthPrepass.setMode(static_cast<DepthPrepassMode>(prepassMode));
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Draw depth first from a position-only stream, then shade each pixel once.\nAuto times both on the GPU and keeps the faster one for the current scene.");
+
+					if (depthPrepass.getMode() == DepthPrepassMode::Auto)
+					{
+						const float withoutMs = depthPrepass.getAverageMs(false);
+						const float withMs = depthPrepass.getAverageMs(true);
+						if (withoutMs >= 0.0f)
+							ImGui::Text("Direct %.3f ms", withoutMs);
+						if (withMs >= 0.0f)
+							ImGui::Text("Prepass %.3f ms", withMs);
+						if (depthPrepass.isMeasuring())
+							ImGui::TextDisabled("Measuring...");
+						else
+							ImGui::Text("Using %s", depthPrepass.isActive() ? "prepass" : "direct");
+					}
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Instancing controls
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_BOXES);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Instancing");
+
+					ImGui::Checkbox("Instanced Drawing", &enableInstancing);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Draw many copies of the selected object with one draw call");
+
+					ImGui::BeginDisabled(!enableInstancing && !enableGpuDriven);
+					const char* placementItems[] = { "Grid", "Random" };
+					int placement = static_cast<int>(instanceLayout.placement);
+					ImGui::Text("Placement");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					if (ImGui::Combo("##InstancePlacement", &placement, placementItems, IM_ARRAYSIZE(placementItems)))
+						instanceLayout.placement = static_cast<InstancePlacement>(placement);
+
+					// The GPU driven path has its own buffers and can hold more instances than a transient buffer
+					const int maxInstances = enableGpuDriven ? kMaxGpuInstances : SceneInstances::kMaxTransientInstances;
+					ImGui::Text("Count");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::SliderInt("##InstanceCount", &instanceLayout.count, 1, maxInstances, "%d", ImGuiSliderFlags_Logarithmic);
+
+					ImGui::BeginGroup();
+					ImGui::Text("Spacing");
+					ImGui::SetNextItemWidth(halfControlWidth);
+					ImGui::SliderFloat("##InstanceSpacing", &instanceLayout.spacing, 0.5f, 5.0f, "%.1f");
+					ImGui::EndGroup();
+
+					ImGui::SameLine(halfControlWidth + 20.0f);
+
+					ImGui::BeginGroup();
+					ImGui::Text("Scale");
+					ImGui::SetNextItemWidth(halfControlWidth);
+					ImGui::SliderFloat("##InstanceScale", &instanceLayout.scale, 0.1f, 2.0f, "%.2f");
+					ImGui::EndGroup();
+
+					if (instanceLayout.placement == InstancePlacement::Random)
+					{
+						int seed = static_cast<int>(instanceLayout.seed);
+						ImGui::Text("Seed");
+						ImGui::SetNextItemWidth(fullControlWidth);
+						if (ImGui::InputInt("##InstanceSeed", &seed))
+							instanceLayout.seed = static_cast<uint32_t>(std::max(seed, 0));
+					}
+					ImGui::EndDisabled();
+
+					ImGui::BeginDisabled(!enableInstancing || enableGpuDriven);
+					ImGui::Checkbox("Occlusion Culling (CPU)", &enableOcclusionCulling);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Rasterize the largest instances into a small software depth buffer and skip instances hidden behind them");
+
+					if (enableOcclusionCulling)
+					{
+						ImGui::Text("Occluders");
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::SliderInt("##MaxOccluders", &maxOccluders, 1, 256);
+					}
+					ImGui::EndDisabled();
+
+					ImGui::BeginDisabled(!enableInstancing || enableGpuDriven);
+					ImGui::Checkbox("Per-Draw Submission", &perDrawSubmission);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Submit every instance as its own draw call, recorded in parallel with one bgfx encoder per thread");
+
+					if (perDrawSubmission)
+					{
+						ImGui::Text("Submit Threads");
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::SliderInt("##SubmitThreads", &submitThreads, 1, ParallelSubmit::kMaxThreads);
+					}
+					ImGui::EndDisabled();
+
+					if (enableInstancing && !enableGpuDriven)
+					{
+						if (perDrawSubmission)
+							ImGui::Text("%u draw calls, %u encoders, %.2f ms submit", submitStats.draws, submitStats.encoders, submitStats.cpuMs);
+						else
+							ImGui::Text("%u instances, 1 draw call", instancesDrawn);
+						ImGui::Text("Frustum: %u of %u visible, %.3f ms", frustumVisibleInstances, frustumTestedInstances, frustumCullMs);
+						if (enableOcclusionCulling)
+							ImGui::Text("Occlusion: %u culled, %u occluders, %.2f ms", occludedInstances, occlusionOccluders, occlusionRasterizeMs);
+					}
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// GPU driven rendering controls
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_CPU);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "GPU Driven Rendering");
+
+					ImGui::BeginDisabled(!gpuDrivenSupported);
+					ImGui::Checkbox("Compute Culling + Indirect Draw", &enableGpuDriven);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Cull the instance layout in a compute shader and draw it with one indirect call per mesh");
+
+					ImGui::BeginDisabled(!enableGpuDriven);
+					ImGui::Checkbox("Occlusion Culling (Hi-Z)", &gpuOcclusionCulling);
+					ImGui::EndDisabled();
+					ImGui::EndDisabled();
+
+					if (!gpuDrivenSupported)
+						ImGui::TextDisabled("Requires compute and indirect draw support");
+					else if (enableGpuDriven)
+						ImGui::Text("%d instances, %u draw calls", instanceLayout.count, gpuDrawCalls);
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Job system controls
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_WORKFLOW);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Job System");
+
+					ImGui::Checkbox("Single-Threaded", &jobsSingleThreaded);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Run every job inline on the main thread in submission order, for deterministic results and timings");
+
+					ImGui::Text("Render thread: API waited %.2f ms, render waited %.2f ms", apiWaitRenderMs, renderWaitSubmitMs);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("bgfx renders on the window thread; time this thread blocked in bgfx::frame and the render thread idled for a frame");
+
+					for (size_t i = 0; i < jobWorkerStats.size(); ++i)
+					{
+						const JobWorkerStats& worker = jobWorkerStats[i];
+						char label[64];
+						snprintf(label, sizeof(label), "%s %zu: %u jobs, %u stolen", i == 0 ? "Main" : "Worker", i, worker.jobs, worker.steals);
+						ImGui::ProgressBar(worker.utilization, ImVec2(fullControlWidth, 0.0f), label);
+					}
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Heap allocations per frame and subsystem
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_MEMORY_STICK);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Allocations");
+
+					bool zeroAllocationMode = AllocationTracker::isZeroAllocationMode();
+					if (ImGui::Checkbox("Zero Allocation Mode", &zeroAllocationMode))
+					{
+						AllocationTracker::setZeroAllocationMode(zeroAllocationMode);
+					}
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Report every steady frame that allocates, with its subsystems, and assert in debug builds");
+
+					const AllocationStats& allocations = AllocationTracker::getLastFrame();
+					ImGui::Text("Last frame: %u allocations, %.1f KB, %u frees", allocations.getTotalCount(), allocations.getTotalBytes() / 1024.0, allocations.frees);
+					ImGui::Text("%u clean steady frames, %u that allocated", AllocationTracker::getCleanFrameCount(), AllocationTracker::getViolationCount());
+
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::PlotHistogram("##AllocationHistory", AllocationTracker::getHistory(), AllocationTracker::kHistoryFrames, AllocationTracker::getHistoryOffset(), "Allocations per frame", 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+
+					if (ImGui::BeginTable("Allocations", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+					{
+						ImGui::TableSetupColumn("Subsystem");
+						ImGui::TableSetupColumn("Count");
+						ImGui::TableSetupColumn("Bytes");
+						ImGui::TableHeadersRow();
+						for (size_t i = 0; i < static_cast<size_t>(AllocationSubsystem::Count); ++i)
+						{
+							ImGui::TableNextRow();
+							ImGui::TableNextColumn();
+							ImGui::Text("%s", AllocationTracker::getSubsystemName(static_cast<AllocationSubsystem>(i)));
+							ImGui::TableNextColumn();
+							ImGui::Text("%u", allocations.count[i]);
+							ImGui::TableNextColumn();
+							ImGui::Text("%llu", static_cast<unsigned long long>(allocations.bytes[i]));
+						}
+						ImGui::EndTable();
+					}
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Render on demand controls
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_MOON);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Render On Demand");
+
+					ImGui::Checkbox("Reuse Unchanged Passes", &renderOnDemand);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Redraw the scene and tone mapping only when their settings change, and stop submitting frames when idle");
+
+					ImGui::Text("%u frames, %u scene passes, %u post passes", presentedFrames, scenePasses, postPasses);
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// HDR target format tier and its A/B benchmark
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_MEMORY_STICK);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "HDR Target");
+
+					const bool compactSupported = HdrTarget::isCompactSupported();
+					int tier = static_cast<int>(hdrTarget.getTier());
+					ImGui::BeginDisabled(hdrTarget.isBenchmarking());
+					ImGui::RadioButton("RGBA16F", &tier, static_cast<int>(HdrFormatTier::Full));
+					ImGui::SameLine();
+					ImGui::BeginDisabled(!compactSupported);
+					ImGui::RadioButton("RG11B10F (Compact)", &tier, static_cast<int>(HdrFormatTier::Compact));
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Half the memory and bandwidth of RGBA16F, without alpha or negative values");
+					ImGui::EndDisabled();
+					hdrTarget.setTier(static_cast<HdrFormatTier>(tier));
+
+					if (ImGui::Button("Benchmark Formats", ImVec2(fullControlWidth, 0)))
+					{
+						hdrTarget.startBenchmark();
+					}
+					ImGui::EndDisabled();
+
+					if (!compactSupported)
+						ImGui::TextDisabled("RG11B10F render targets are not supported, using RGBA16F");
+					ImGui::Text("Color target: %.1f MB", hdrColorBytes / (1024.0f * 1024.0f));
+					if (hdrTarget.isBenchmarking())
+					{
+						ImGui::TextDisabled("Measuring...");
+					}
+					else if (hdrTarget.getResult(HdrFormatTier::Full).sceneMs >= 0.0f && ImGui::BeginTable("HdrBenchmark", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+					{
+						ImGui::TableSetupColumn("Format");
+						ImGui::TableSetupColumn("Scene ms");
+						ImGui::TableSetupColumn("Post ms");
+						ImGui::TableSetupColumn("MB");
+						ImGui::TableHeadersRow();
+						for (HdrFormatTier resultTier : { HdrFormatTier::Full, HdrFormatTier::Compact })
+						{
+							const HdrTarget::Result& result = hdrTarget.getResult(resultTier);
+							if (result.sceneMs < 0.0f)
+								continue;
+
+							ImGui::TableNextRow();
+							ImGui::TableNextColumn();
+							ImGui::Text("%s", HdrTarget::getName(resultTier));
+							ImGui::TableNextColumn();
+							ImGui::Text("%.3f", result.sceneMs);
+							ImGui::TableNextColumn();
+							ImGui::Text("%.3f", result.postMs);
+							ImGui::TableNextColumn();
+							ImGui::Text("%.1f", result.colorBytes / (1024.0f * 1024.0f));
+						}
+						ImGui::EndTable();
+					}
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Dynamic resolution of the scene pass
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_SCALING);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Dynamic Resolution");
+
+					ImGui::Checkbox("Scale Scene Resolution", &dynamicResolutionSettings.enabled);
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Render the scene at a lower resolution while the GPU frame is over the target time; the CLUT and UI stay native");
+
+					ImGui::BeginDisabled(!dynamicResolutionSettings.enabled);
+					ImGui::Text("Target GPU Frame (ms)");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::SliderFloat("##ResolutionTarget", &dynamicResolutionSettings.targetMs, 2.0f, 50.0f, "%.1f");
+					ImGui::Text("Scale Range");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::DragFloatRange2("##ResolutionRange", &dynamicResolutionSettings.minScale, &dynamicResolutionSettings.maxScale, 0.01f, 0.25f, 1.0f, "Min %.2f", "Max %.2f", ImGuiSliderFlags_AlwaysClamp);
+					ImGui::Text("Upscale Sharpness");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::SliderFloat("##ResolutionSharpness", &dynamicResolutionSettings.sharpness, 0.0f, 1.0f, "%.2f");
+					ImGui::EndDisabled();
+
+					ImGui::Text("%s, scale %.2f, %d x %d", DynamicResolution::getStateName(dynamicResolution.getState()), dynamicResolution.getScale(), sceneWidth, sceneHeight);
+					ImGui::Text("GPU frame %.2f ms, scene %.2f ms", gpuFrameMs, sceneGpuMs);
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+					ImGui::Separator();
+					ImGui::Spacing();
+
+					// Image sequence export
+					ImGui::BeginGroup();
+					ImGuiUtils::Icon(ICON_LC_FILM);
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Frame Export");
+
+					const bool exportSupported = FrameExporter::isSupported();
+					ImGui::BeginDisabled(!exportSupported || frameExporter.isRecording());
+					static char exportDirectory[256] = "export";
+					ImGui::Text("Directory");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::InputText("##ExportDirectory", exportDirectory, IM_ARRAYSIZE(exportDirectory));
+
+					int exportSource = static_cast<int>(frameExportSettings.source);
+					ImGui::RadioButton("Graded (PNG)", &exportSource, static_cast<int>(FrameExporter::Source::Graded));
+					ImGui::SameLine();
+					ImGui::RadioButton("Scene HDR (EXR)", &exportSource, static_cast<int>(FrameExporter::Source::SceneHdr));
+					frameExportSettings.source = static_cast<FrameExporter::Source>(exportSource);
+
+					ImGui::Text("Frames (0 until stopped)");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::SliderInt("##ExportFrames", &frameExportSettings.frameCount, 0, 1800);
+					ImGui::EndDisabled();
+
+					if (frameExporter.isRecording())
+					{
+						if (ImGui::Button("Stop Export", ImVec2(fullControlWidth, 0)))
+						{
+							frameExporter.stop();
+						}
+					}
+					else
+					{
+						// The last sequence must reach disk before a new one, numbered from 0 again, can start
+						ImGui::BeginDisabled(!exportSupported || frameExporter.isBusy());
+						if (ImGui::Button(frameExporter.isBusy() ? "Writing..." : "Start Export", ImVec2(fullControlWidth, 0)))
+						{
+							frameExportSettings.directory = exportDirectory;
+							frameExporter.start(frameExportSettings);
+						}
+						ImGui::EndDisabled();
+					}
+
+					if (!exportSupported)
 					{
-						ImGui::Text("Rotation Speed"); // Add separate label
-						ImGui::SetNextItemWidth(fullControlWidth);
-						ImGui::SliderFloat("##ModelSpeed", &modelRotationSpeed, 0.1f, 2.0f, "%.2f");
+						ImGui::TextDisabled("Requires texture blit and read back support");
 					}
 					else
 					{
-						ImGui::BeginDisabled(autoRotateModel);
-						ImGui::Text("Rotation Axes"); // Add separate label
-						ImGui::SetNextItemWidth(fullControlWidth);
-						ImGui::SliderFloat3("##ModelRotation", modelRotation, -3.14159f, 3.14159f, "%.2f");
-						ImGui::EndDisabled();
+						const FrameExporter::Stats exportStats = frameExporter.getStats();
+						ImGui::Text("%u captured, %u written, %u dropped", exportStats.captured, exportStats.written, exportStats.dropped);
+						ImGui::Text("%d in flight, %d encoding", exportStats.inFlight, exportStats.queued);
+						if (exportStats.failed > 0)
+							ImGui::TextColored(ImVec4(0.90f, 0.35f, 0.35f, 1.00f), "%u files could not be written", exportStats.failed);
 					}
 					ImGui::EndGroup();
 
@@ -540,62 +2374,60 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 					ImGui::Separator();
 					ImGui::Spacing();
 
-					// Light controls - with proper spacing
+					// Input recording and replay
 					ImGui::BeginGroup();
-					ImGuiUtils::Icon(ICON_LC_SUN);
+					ImGuiUtils::Icon(ICON_LC_CLAPPERBOARD);
 					ImGui::SameLine();
-					ImGui::TextColored(ImVec4(0.98f, 0.75f, 0.18f, 1.00f), "Lighting");
+					ImGui::TextColored(ImVec4(0.55f, 0.75f, 0.49f, 1.00f), "Record / Replay");
 
-					ImGui::Checkbox("Auto-Rotate Light", &autoRotateLight);
+					static char sessionPath[256] = "session.ralog";
+					ImGui::BeginDisabled(frameRecorder.isRecording() || frameReplay.isOpen());
+					ImGui::Text("Log");
+					ImGui::SetNextItemWidth(fullControlWidth);
+					ImGui::InputText("##SessionLog", sessionPath, IM_ARRAYSIZE(sessionPath));
+					ImGui::EndDisabled();
 
-					if (autoRotateLight)
+					if (frameRecorder.isRecording())
 					{
-						// Better layout for light rotation controls with separate labels
-						ImGui::BeginGroup();
-						ImGui::Text("Speed");
-						ImGui::SetNextItemWidth(halfControlWidth);
-						ImGui::SliderFloat("##LightSpeed", &lightRotationSpeed, 0.1f, 2.0f, "%.2f");
-						ImGui::EndGroup();
-
-						ImGui::SameLine(halfControlWidth + 20.0f);
-
-						ImGui::BeginGroup();
-						ImGui::Text("Radius");
-						ImGui::SetNextItemWidth(halfControlWidth);
-						ImGui::SliderFloat("##LightRadius", &lightRotationRadius, 1.0f, 10.0f, "%.1f");
-						ImGui::EndGroup();
+						if (ImGui::Button("Stop Recording", ImVec2(fullControlWidth, 0)))
+						{
+							frameRecorder.stop();
+						}
+					}
+					else if (frameReplay.isOpen())
+					{
+						if (ImGui::Button("Stop Replay", ImVec2(fullControlWidth, 0)))
+						{
+							frameReplay.close();
+							frameTimingLog.close();
+						}
 					}
 					else
 					{
-						ImGui::BeginDisabled(autoRotateLight);
-						ImGui::Text("Position"); // Add separate label
-						ImGui::SetNextItemWidth(fullControlWidth);
-						ImGui::SliderFloat3("##LightPosition", lightPos, -5.0f, 5.0f, "%.1f");
-						ImGui::EndDisabled();
+						if (ImGui::Button("Start Recording", ImVec2(halfControlWidth, 0)))
+						{
+							frameRecorder.start(sessionPath);
+						}
+						ImGui::SameLine();
+						if (ImGui::Button("Replay", ImVec2(halfControlWidth, 0)))
+						{
+							if (frameReplay.open(sessionPath) && !frameTimingLog.open(std::string(sessionPath) + ".csv"))
+							{
+								frameReplay.close();
+							}
+						}
+						if (ImGui::IsItemHovered())
+							ImGui::SetTooltip("Play the log back in fixed 60 Hz steps, writing per frame timings next to it as CSV");
 					}
 
-					// Light color controls with separate label
-					ImGui::Text("Light Color");
-					ImGui::SetNextItemWidth(fullControlWidth);
-					ImGui::ColorEdit3("##LightColor", lightColor);
-
-					ImGui::Spacing();
-
-					// Fixed layout for intensity and ambient with separate labels
-					ImGui::BeginGroup();
-					ImGui::Text("Intensity");
-					ImGui::SetNextItemWidth(halfControlWidth);
-					ImGui::SliderFloat("##LightIntensity", &lightIntensity, 0.0f, 5.0f, "%.2f");
-					ImGui::EndGroup();
-
-					ImGui::SameLine(halfControlWidth + 20.0f);
-
-					ImGui::BeginGroup();
-					ImGui::Text("Ambient");
-					ImGui::SetNextItemWidth(halfControlWidth);
-					ImGui::SliderFloat("##AmbientStrength", &ambientStrength, 0.0f, 1.0f, "%.2f");
-					ImGui::EndGroup();
-
+					if (frameRecorder.isRecording() || frameRecorder.getFrameCount() > 0)
+					{
+						ImGui::Text("%u frames recorded, %.1f KB", frameRecorder.getFrameCount(), frameRecorder.getByteCount() / 1024.0);
+					}
+					if (frameReplay.isOpen())
+					{
+						ImGui::Text("Replaying frame %u", frameReplay.getFrameIndex());
+					}
 					ImGui::EndGroup();
 				}
 
@@ -620,10 +2452,38 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 
 				// Tone mapping section with proper spacing
 				{
-					ImGui::Text("Exposure");
+					ImGui::BeginDisabled(!autoExposure.isValid());
+					if (ImGui::Checkbox("Auto Exposure", &autoExposureEnabled) && autoExposureEnabled)
+					{
+						autoExposure.reset();
+					}
+					ImGui::EndDisabled();
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip(autoExposure.isValid() ? "Adapt exposure to the average scene luminance on the GPU" : "Requires compute shader support");
+
+					ImGui::Text(autoExposureEnabled ? "Exposure Compensation" : "Exposure");
 					ImGui::SetNextItemWidth(fullControlWidth);
 					ImGui::SliderFloat("##Exposure", &exposure, 0.1f, 5.0f, "%.2f");
 
+					if (autoExposureEnabled)
+					{
+						AutoExposure::Settings& settings = autoExposureSettings;
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::DragFloatRange2("##Percentiles", &settings.lowPercentile, &settings.highPercentile, 0.005f, 0.0f, 1.0f, "Low %.2f", "High %.2f");
+						if (ImGui::IsItemHovered())
+							ImGui::SetTooltip("Only samples between these luminance percentiles are averaged");
+
+						ImGui::SetNextItemWidth(halfControlWidth);
+						ImGui::SliderFloat("##SpeedUp", &settings.speedUp, 0.1f, 10.0f, "Brighten %.1f/s");
+						ImGui::SameLine(halfControlWidth + 20.0f);
+						ImGui::SetNextItemWidth(halfControlWidth);
+						ImGui::SliderFloat("##SpeedDown", &settings.speedDown, 0.1f, 10.0f, "Darken %.1f/s");
+
+						ImGui::SetNextItemWidth(fullControlWidth);
+						ImGui::DragFloatRange2("##ExposureLimits", &settings.minExposure, &settings.maxExposure, 0.01f, 0.001f, 256.0f, "Min %.3f", "Max %.1f");
+						ImGui::Text("Measure + adapt %.3f ms GPU", autoExposureGpuMs);
+					}
+
 					ImGui::Spacing();
 
 					ImGui::Text("Tone Mapping Operator");
@@ -633,6 +2493,21 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 					if (ImGui::IsItemHovered())
 						ImGui::SetTooltip("Different algorithms for compressing HDR to LDR");
 
+					ImGui::BeginDisabled(!computeTonemap.isValid());
+					ImGui::Checkbox("Compute Tonemap", &useComputeTonemap);
+					ImGui::EndDisabled();
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip(computeTonemap.isValid() ? "Tonemap and grade in 8x8 compute tiles instead of drawing a screen quad" : "Requires compute support and RGBA8 image writes");
+
+					// Each path keeps its last timing, toggle to compare them on this GPU
+					char rasterTiming[32] = "-";
+					char computeTiming[32] = "-";
+					if (tonemapGpuMs[0] >= 0.0f)
+						snprintf(rasterTiming, sizeof(rasterTiming), "%.3f ms", tonemapGpuMs[0]);
+					if (tonemapGpuMs[1] >= 0.0f)
+						snprintf(computeTiming, sizeof(computeTiming), "%.3f ms", tonemapGpuMs[1]);
+					ImGui::Text("Raster %s, compute %s GPU", rasterTiming, computeTiming);
+
 					ImGui::Spacing();
 					ImGui::Separator();
 					ImGui::Spacing();
@@ -653,6 +2528,7 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 
 					// Split screen controls with proper layout
 					ImGui::BeginGroup();
+					ImGui::BeginDisabled(compareMode);
 					ImGui::Checkbox("Split Screen Comparison", &splitScreen);
 
 					if (splitScreen)
@@ -661,10 +2537,99 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 						ImGui::SetNextItemWidth(fullControlWidth);
 						ImGui::SliderFloat("##SplitPosition", &splitPosition, 0.0f, 1.0f, "%.2f");
 					}
+					ImGui::EndDisabled();
+					ImGui::EndGroup();
+
+					ImGui::Spacing();
+
+					// Up to nine candidate grades side by side, all applied in the one tonemap pass
+					ImGui::BeginGroup();
+					ImGui::Checkbox("Multi-Grade Comparison", &compareMode);
+					if (ImGui::IsItemHovered())
+					{
+						ImGui::SetTooltip("Grade each region of the viewport with a different CLUT");
+					}
+
+					if (compareMode)
+					{
+						int layout = static_cast<int>(clutCompare.getLayout());
+						ImGui::RadioButton("Grid", &layout, static_cast<int>(ClutCompare::Layout::Grid));
+						ImGui::SameLine();
+						ImGui::RadioButton("Wipe", &layout, static_cast<int>(ClutCompare::Layout::Wipe));
+						clutCompare.setLayout(static_cast<ClutCompare::Layout>(layout));
+
+						int removed = -1;
+						for (int i = 0; i < clutCompare.getCount(); ++i)
+						{
+							ImGui::PushID(i);
+							if (ImGui::SmallButton(ICON_LC_X))
+							{
+								removed = i;
+							}
+							ImGui::SameLine();
+							ImGui::Text("%d. %s", i + 1, clutCompare.getName(i).c_str());
+							ImGui::PopID();
+						}
+						clutCompare.remove(removed);
+						if (clutCompare.getCount() > 0)
+						{
+							ImGui::TextDisabled("%d from the atlas, %d resampled", clutCompare.getResidentCount(), clutCompare.getCount() - clutCompare.getResidentCount());
+						}
+
+						ImGui::BeginDisabled(clutCompare.getCount() >= ClutCompare::kMaxCandidates);
+						ImGui::SetNextItemWidth(fullControlWidth);
+						if (ImGui::BeginCombo("##AddCandidate", "Add candidate..."))
+						{
+							for (const auto& preset : clutLibrary)
+							{
+								if (!clutCompare.contains(preset.first) && ImGui::Selectable(preset.first.c_str()))
+								{
+									clutCompare.add(preset.first, preset.second);
+								}
+							}
+							ImGui::EndCombo();
+						}
+						if (ImGui::Button("Add Current", ImVec2(halfControlWidth, 0)))
+						{
+							clutCompare.add(currentPreset, currentClut);
+						}
+						ImGui::EndDisabled();
+
+						ImGui::SameLine(halfControlWidth + 20.0f);
+						if (ImGui::Button("Clear", ImVec2(halfControlWidth, 0)))
+						{
+							clutCompare.clear();
+						}
+
+						if (clutCompare.getLayout() == ClutCompare::Layout::Wipe && clutCompare.getCount() > 1)
+						{
+							if (ImGui::Button("Reset Wipes", ImVec2(fullControlWidth, 0)))
+							{
+								clutCompare.resetWipes();
+							}
+							ImGui::TextDisabled("Drag the wipe lines in the viewport");
+						}
+					}
 					ImGui::EndGroup();
 
 					ImGui::Spacing();
 					ImGui::Checkbox("Show CLUT Preview", &showClut);
+					ImGui::SameLine();
+					ImGui::Checkbox("Scopes", &showScopesWindow);
+
+					// The 1D CLUT is a strip texture already; a 3D CLUT shows its middle blue slice
+					if (showClut)
+					{
+						if (use3DCLUT)
+						{
+							updateClutPreview(currentClut);
+							ImGui::Image(ImGui_ImplBgfx_GetTextureId(clutPreviewTexture), ImVec2(halfControlWidth, halfControlWidth));
+						}
+						else
+						{
+							ImGui::Image(ImGui_ImplBgfx_GetTextureId(clut1DTexture), ImVec2(fullControlWidth, 20.0f));
+						}
+					}
 				}
 
 				ImGui::EndTabItem();
@@ -686,6 +2651,12 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 				ImGui::Separator();
 				ImGui::Spacing();
 
+				// Make a library entry the current CLUT, from the combo or the thumbnail browser
+				auto selectPreset = [&](const std::pair<const std::string, CLUT>& preset)
+				{
+					selectClutPreset(preset, currentClut, currentPreset, clut1DTexture, use3DCLUT, editingMode);
+				};
+
 				// CLUT preset selection with proper width and label
 				ImGui::Text("Select CLUT Preset");
 				ImGui::SetNextItemWidth(fullControlWidth);
@@ -696,67 +2667,103 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 						bool isSelected = (currentPreset == preset.first.c_str());
 
 						// Add indicator for 1D vs 3D CLUTs
-						std::string displayName = preset.first;
-						if (preset.second.is3DCLUT())
+						char displayName[128];
+						snprintf(displayName, sizeof(displayName), "%s %s", preset.first.c_str(), preset.second.is3DCLUT() ? "[3D]" : "[1D]");
+
+						if (ImGui::Selectable(displayName, isSelected))
 						{
-							displayName += " [3D]";
+							selectPreset(preset);
 						}
-						else
+						if (isSelected)
 						{
-							displayName += " [1D]";
+							ImGui::SetItemDefaultFocus();
 						}
+					}
+					ImGui::EndCombo();
+				}
 
-						if (ImGui::Selectable(displayName.c_str(), isSelected))
-						{
-							currentPreset = preset.first.c_str();
-							currentClut = preset.second;
+				ImGui::Spacing();
 
-							// Update use3DCLUT flag based on the selected preset
-							use3DCLUT = preset.second.is3DCLUT();
+				// Thumbnail browser; only visible rows are submitted, and every thumbnail samples the one atlas
+				ImGui::Text("Preset Browser");
+				static std::vector<const std::pair<const std::string, CLUT>*> browserEntries;
+				if (browserEntries.size() != clutLibrary.size())
+				{
+					// Library entries are only ever added, and map nodes never move
+					browserEntries.clear();
+					for (const auto& preset : clutLibrary)
+					{
+						browserEntries.push_back(&preset);
+					}
+				}
 
-							// Update appropriate texture based on CLUT type
-							if (use3DCLUT)
+				ImGui::BeginChild("PresetBrowser", ImVec2(fullControlWidth, 220), true);
+				{
+					const float thumbnailSize = 56.0f;
+					const ImGuiStyle& style = ImGui::GetStyle();
+					const ImVec2 buttonSize(thumbnailSize + style.FramePadding.x * 2.0f, thumbnailSize + style.FramePadding.y * 2.0f);
+					const int columns = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + style.ItemSpacing.x) / (buttonSize.x + style.ItemSpacing.x)));
+					const int rows = (static_cast<int>(browserEntries.size()) + columns - 1) / columns;
+					const ImTextureID atlas = ImGui_ImplBgfx_GetTextureId(clutThumbnails.getTexture());
+
+					ImGuiListClipper clipper;
+					clipper.Begin(rows, buttonSize.y + style.ItemSpacing.y);
+					while (clipper.Step())
+					{
+						for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+						{
+							for (int column = 0; column < columns; ++column)
 							{
-								bgfx::destroy(clut3DTexture);
-								std::vector<float> clutDataWithAlpha3D(currentClut.getSize() * currentClut.getSize() * currentClut.getSize() * 4);
-								for (int i = 0; i < currentClut.getSize() * currentClut.getSize() * currentClut.getSize(); ++i)
+								const size_t index = size_t(row) * columns + column;
+								if (index >= browserEntries.size())
+									break;
+
+								const auto& preset = *browserEntries[index];
+								const bool isSelected = (currentPreset == preset.first.c_str());
+								if (column > 0)
 								{
-									clutDataWithAlpha3D[i * 4 + 0] = currentClut.getData()[i * 3 + 0];
-									clutDataWithAlpha3D[i * 4 + 1] = currentClut.getData()[i * 3 + 1];
-									clutDataWithAlpha3D[i * 4 + 2] = currentClut.getData()[i * 3 + 2];
-									clutDataWithAlpha3D[i * 4 + 3] = 1.0f; // Set alpha to 1.0
+									ImGui::SameLine();
 								}
-								const bgfx::Memory* mem3D = bgfx::copy(clutDataWithAlpha3D.data(), clutDataWithAlpha3D.size() * sizeof(float));
-								clut3DTexture = bgfx::createTexture3D(currentClut.getSize(), currentClut.getSize(), currentClut.getSize(), false, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem3D);
-							}
-							else
-							{
-								bgfx::destroy(clut1DTexture);
-								std::vector<float> clutDataWithAlpha(currentClut.getSize() * 4);
-								for (int i = 0; i < currentClut.getSize(); ++i) {
-									clutDataWithAlpha[i * 4 + 0] = currentClut.getData()[i * 3 + 0];
-									clutDataWithAlpha[i * 4 + 1] = currentClut.getData()[i * 3 + 1];
-									clutDataWithAlpha[i * 4 + 2] = currentClut.getData()[i * 3 + 2];
-									clutDataWithAlpha[i * 4 + 3] = 1.0f; // Set alpha to 1.0
+
+								ImGui::PushID(static_cast<int>(index));
+								if (isSelected)
+								{
+									ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.83f, 0.46f, 0.78f, 1.00f));
 								}
-								const bgfx::Memory* mem1D = bgfx::copy(clutDataWithAlpha.data(), clutDataWithAlpha.size() * sizeof(float));
-								clut1DTexture = bgfx::createTexture2D(currentClut.getSize(), 1, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem1D);
-							}
 
-							// Reset CLUT editing parameters when selecting a preset
-							clutContrast = 1.0f;
-							clutSaturation = 1.0f;
-							clutTemperature = 0.0f;
-							clutTint = 0.0f;
-							editingMode = false;
-						}
-						if (isSelected)
-						{
-							ImGui::SetItemDefaultFocus();
+								// CLUTs past the atlas capacity fall back to a plain button
+								bool clicked = false;
+								const int slot = clutThumbnails.getSlot(preset.first);
+								if (slot >= 0)
+								{
+									float uv0[2], uv1[2];
+									clutThumbnails.getUv(slot, uv0, uv1);
+									clicked = ImGui::ImageButton("##Thumbnail", atlas, ImVec2(thumbnailSize, thumbnailSize), ImVec2(uv0[0], uv0[1]), ImVec2(uv1[0], uv1[1]));
+								}
+								else
+								{
+									clicked = ImGui::Button("?", buttonSize);
+								}
+
+								if (isSelected)
+								{
+									ImGui::PopStyleColor();
+								}
+								if (ImGui::IsItemHovered())
+								{
+									ImGui::SetTooltip("%s [%s]", preset.first.c_str(), preset.second.is3DCLUT() ? "3D" : "1D");
+								}
+								ImGui::PopID();
+
+								if (clicked)
+								{
+									selectPreset(preset);
+								}
+							}
 						}
 					}
-					ImGui::EndCombo();
 				}
+				ImGui::EndChild();
 
 				ImGui::Spacing();
 
@@ -768,6 +2775,26 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 				ImGui::TextColored(ImVec4(0.9f, 0.9f, 0.9f, 1.0f), "Size: %d", currentClut.getSize());
 				ImGui::EndChild();
 
+				// Residency of the 3D CLUTs, switching between resident ones never uploads
+				ImGui::Spacing();
+				ImGui::Text("3D CLUT Atlas");
+				ImGui::Text("Resident: %u CLUTs in %u pages", clutAtlas.getClutCount(), clutAtlas.getPageCount());
+				ImGui::Text("Memory: %.1f / %.1f MB used", clutAtlas.getUsedBytes() / (1024.0f * 1024.0f), clutAtlas.getAllocatedBytes() / (1024.0f * 1024.0f));
+				ImGui::Text("Uploads: %u", clutAtlas.getUploadCount());
+				ImGui::SetNextItemWidth(fullControlWidth);
+				if (ImGui::SliderInt("##AtlasBudget", &clutAtlasBudgetMB, 16, 1024, "Budget: %d MB"))
+				{
+					clutAtlas.setBudget(uint64_t(clutAtlasBudgetMB) << 20);
+				}
+				if (ImGui::IsItemHovered())
+				{
+					ImGui::SetTooltip("Limits the pages allocated for new CLUTs, resident ones are kept");
+				}
+				if (use3DCLUT && !activeClut3D.isValid())
+				{
+					ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "Current CLUT is not resident, raise the budget");
+				}
+
 				ImGui::Spacing();
 				ImGui::Separator();
 				ImGui::Spacing();
@@ -791,78 +2818,114 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 
 				ImGui::SameLine(halfControlWidth + 20.0f);
 
-				if (ImGui::Button("Load CLUT", ImVec2(halfControlWidth, 25)))
+				ImGui::BeginDisabled(clutLoadPending);
+				if (ImGui::Button(clutLoadPending ? "Loading..." : "Load CLUT", ImVec2(halfControlWidth, 25)))
 				{
 					ImGuiUtils::Icon(ICON_LC_IMPORT);
-					try
+					clutLoadPending = true;
+
+					// Parse the file and expand 1D CLUTs to RGBA texels as a job, then upload on the main thread
+					JobSystem::run([path = std::string(loadPath), &clutLibrary, &currentClut, &currentPreset, &clut1DTexture, &use3DCLUT]()
 					{
-						CLUT loadedClut = loadedClut.loadFromFile(loadPath);
-						currentClut = loadedClut;
-						clutLibrary[loadedClut.getName()] = loadedClut;
-						currentPreset = loadedClut.getName().c_str();
+						CLUT loadedClut;
+						bool loaded = true;
+						try
+						{
+							loadedClut = CLUT::loadFromFile(path);
+						}
+						catch (const std::exception& e)
+						{
+							std::cerr << e.what() << std::endl;
+							loaded = false;
+						}
 
-						// Update CLUT texture based on type
-						if (loadedClut.is3DCLUT())
+						// 3D CLUTs are converted by the atlas when they are uploaded
+						const std::vector<float>& data = loadedClut.getData();
+						std::vector<float> texels(loadedClut.is3DCLUT() ? 0 : data.size() / 3 * 4);
+						for (size_t i = 0; i < texels.size() / 4; ++i)
 						{
-							use3DCLUT = true;
-							bgfx::destroy(clut3DTexture);
-							std::vector<float> clutDataWithAlpha3D(currentClut.getSize() * currentClut.getSize() * currentClut.getSize() * 4);
-							for (int i = 0; i < currentClut.getSize() * currentClut.getSize() * currentClut.getSize(); ++i)
-							{
-								clutDataWithAlpha3D[i * 4 + 0] = currentClut.getData()[i * 3 + 0];
-								clutDataWithAlpha3D[i * 4 + 1] = currentClut.getData()[i * 3 + 1];
-								clutDataWithAlpha3D[i * 4 + 2] = currentClut.getData()[i * 3 + 2];
-								clutDataWithAlpha3D[i * 4 + 3] = 1.0f; // Set alpha to 1.0
-							}
-							const bgfx::Memory* mem3D = bgfx::copy(clutDataWithAlpha3D.data(), clutDataWithAlpha3D.size() * sizeof(float));
-							clut3DTexture = bgfx::createTexture3D(currentClut.getSize(), currentClut.getSize(), currentClut.getSize(), false, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem3D);
+							texels[i * 4 + 0] = data[i * 3 + 0];
+							texels[i * 4 + 1] = data[i * 3 + 1];
+							texels[i * 4 + 2] = data[i * 3 + 2];
+							texels[i * 4 + 3] = 1.0f; // Set alpha to 1.0
 						}
-						else
+
+						JobSystem::runOnMainThread([loadedClut, texels, loaded, &clutLibrary, &currentClut, &currentPreset, &clut1DTexture, &use3DCLUT]()
 						{
-							use3DCLUT = false;
-							bgfx::destroy(clut1DTexture);
-							std::vector<float> clutDataWithAlpha(currentClut.getSize() * 4);
-							for (int i = 0; i < currentClut.getSize(); ++i) {
-								clutDataWithAlpha[i * 4 + 0] = currentClut.getData()[i * 3 + 0];
-								clutDataWithAlpha[i * 4 + 1] = currentClut.getData()[i * 3 + 1];
-								clutDataWithAlpha[i * 4 + 2] = currentClut.getData()[i * 3 + 2];
-								clutDataWithAlpha[i * 4 + 3] = 1.0f; // Set alpha to 1.0
+							clutLoadPending = false;
+							if (!loaded)
+							{
+								clutLoadResult = ClutLoadResult::Failed;
+								return;
 							}
-							const bgfx::Memory* mem1D = bgfx::copy(clutDataWithAlpha.data(), clutDataWithAlpha.size() * sizeof(float));
-							clut1DTexture = bgfx::createTexture2D(currentClut.getSize(), 1, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem1D);
-						}
 
-						ImGui::OpenPopup("CLUT Loaded");
-					}
-					catch (const std::exception& e)
-					{
-						ImGui::OpenPopup("Load Error");
-					}
+							currentClut = loadedClut;
+							clutLibrary[loadedClut.getName()] = loadedClut;
+							clutThumbnails.update(loadedClut.getName(), loadedClut);
+							currentPreset = clutLibrary[loadedClut.getName()].getName().c_str();
+
+							// Update CLUT texture based on type
+							const int size = loadedClut.getSize();
+							if (loadedClut.is3DCLUT())
+							{
+								use3DCLUT = true;
+								activeClut3D = clutAtlas.update(loadedClut.getName(), loadedClut);
+							}
+							else
+							{
+								use3DCLUT = false;
+								bgfx::destroy(clut1DTexture);
+								const bgfx::Memory* mem = bgfx::copy(texels.data(), texels.size() * sizeof(float));
+								clut1DTexture = bgfx::createTexture2D(size, 1, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem);
+							}
+
+							// A 3D candidate reads the slot the atlas was just updated in
+							clutCompare.refresh(loadedClut.getName(), loadedClut);
+							++clutRevision;
+
+							clutLoadResult = ClutLoadResult::Loaded;
+						});
+					});
 				}
+				ImGui::EndDisabled();
+
+				ImGui::Spacing();
+				ImGui::Separator();
+				ImGui::Spacing();
+
+				// Grade a folder of images with the current CLUT on the CPU, without touching the viewport
+				ImGui::TextColored(ImVec4(0.54f, 0.76f, 0.49f, 1.00f), "Batch Grade Images");
+
+				static char gradeInput[256] = "grade_input";
+				static char gradeOutput[256] = "grade_output";
+				ImGui::BeginDisabled(batchGrader.isBusy());
+				ImGui::Text("Input Folder");
+				ImGui::SetNextItemWidth(fullControlWidth);
+				ImGui::InputText("##GradeInput", gradeInput, IM_ARRAYSIZE(gradeInput));
+				ImGui::Text("Output Folder");
+				ImGui::SetNextItemWidth(fullControlWidth);
+				ImGui::InputText("##GradeOutput", gradeOutput, IM_ARRAYSIZE(gradeOutput));
 
-				// Popup modals - keep as is
-				if (ImGui::BeginPopupModal("CLUT Loaded", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+				if (ImGui::Button(batchGrader.isBusy() ? "Grading..." : "Grade Images", ImVec2(fullControlWidth, 25)))
 				{
-					ImGui::Text("CLUT loaded successfully!");
-					ImGui::Text("Type: %s", currentClut.is3DCLUT() ? "3D CLUT" : "1D CLUT");
-					ImGui::Text("Size: %d", currentClut.getSize());
-					ImGui::Spacing();
-					if (ImGui::Button("OK", ImVec2(120, 0)))
-					{
-						ImGui::CloseCurrentPopup();
-					}
-					ImGui::EndPopup();
+					BatchGrader::Settings gradeSettings;
+					gradeSettings.inputDirectory = gradeInput;
+					gradeSettings.outputDirectory = gradeOutput;
+					batchGrader.start(gradeSettings, currentClut);
 				}
+				ImGui::EndDisabled();
 
-				if (ImGui::BeginPopupModal("Load Error", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+				if (batchGrader.getTotal() > 0)
 				{
-					ImGui::Text("Failed to load CLUT file!");
-					ImGui::Spacing();
-					if (ImGui::Button("OK", ImVec2(120, 0)))
+					ImGui::Text("Graded: %u / %u", batchGrader.getGraded(), batchGrader.getTotal());
+					if (batchGrader.getFailed() > 0)
+					{
+						ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "Failed: %u", batchGrader.getFailed());
+					}
+					if (!batchGrader.isBusy())
 					{
-						ImGui::CloseCurrentPopup();
+						ImGui::Text("Last batch: %.1f ms", batchGrader.getLastBatchMs());
 					}
-					ImGui::EndPopup();
 				}
 
 				ImGui::EndTabItem();
@@ -946,17 +3009,7 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 						if (use3DCLUT)
 						{
 							currentClut = clutLibrary["Neutral (3D)"];
-							bgfx::destroy(clut3DTexture);
-							std::vector<float> clutDataWithAlpha3D(currentClut.getSize() * currentClut.getSize() * currentClut.getSize() * 4);
-							for (int i = 0; i < currentClut.getSize() * currentClut.getSize() * currentClut.getSize(); ++i)
-							{
-								clutDataWithAlpha3D[i * 4 + 0] = currentClut.getData()[i * 3 + 0];
-								clutDataWithAlpha3D[i * 4 + 1] = currentClut.getData()[i * 3 + 1];
-								clutDataWithAlpha3D[i * 4 + 2] = currentClut.getData()[i * 3 + 2];
-								clutDataWithAlpha3D[i * 4 + 3] = 1.0f; // Set alpha to 1.0
-							}
-							const bgfx::Memory* mem3D = bgfx::copy(clutDataWithAlpha3D.data(), clutDataWithAlpha3D.size() * sizeof(float));
-							clut3DTexture = bgfx::createTexture3D(currentClut.getSize(), currentClut.getSize(), currentClut.getSize(), false, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem3D);
+							activeClut3D = clutAtlas.find("Neutral (3D)");
 						}
 						else
 						{
@@ -972,6 +3025,7 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 							const bgfx::Memory* mem1D = bgfx::copy(clutDataWithAlpha.data(), clutDataWithAlpha.size() * sizeof(float));
 							clut1DTexture = bgfx::createTexture2D(currentClut.getSize(), 1, false, 1, bgfx::TextureFormat::RGBA32F, BGFX_TEXTURE_NONE, mem1D);
 						}
+						++clutRevision;
 
 						// Update current preset name
 						currentPreset = use3DCLUT ? "Custom 3D" : "Custom 1D";
@@ -984,6 +3038,12 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 						// Save current CLUT to library
 						currentClut.setName(customLutName);
 						clutLibrary[customLutName] = currentClut;
+						clutThumbnails.update(customLutName, currentClut);
+						if (currentClut.is3DCLUT())
+						{
+							activeClut3D = clutAtlas.update(customLutName, currentClut);
+						}
+						clutCompare.refresh(customLutName, currentClut);
 						currentPreset = customLutName;
 
 						// Save to file
@@ -1060,6 +3120,37 @@ void renderImGuiInterface(std::map<std::string, CLUT>& clutLibrary, CLUT& curren
 			ImGui::EndTabBar();
 		}
 
+		if (clutLoadResult != ClutLoadResult::None)
+		{
+			ImGui::OpenPopup(clutLoadResult == ClutLoadResult::Loaded ? "CLUT Loaded" : "Load Error");
+			clutLoadResult = ClutLoadResult::None;
+		}
+
+		// Load result popups; outside the tabs so a load that finishes with its tab closed still reports
+		if (ImGui::BeginPopupModal("CLUT Loaded", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("CLUT loaded successfully!");
+			ImGui::Text("Type: %s", currentClut.is3DCLUT() ? "3D CLUT" : "1D CLUT");
+			ImGui::Text("Size: %d", currentClut.getSize());
+			ImGui::Spacing();
+			if (ImGui::Button("OK", ImVec2(120, 0)))
+			{
+				ImGui::CloseCurrentPopup();
+			}
+			ImGui::EndPopup();
+		}
+
+		if (ImGui::BeginPopupModal("Load Error", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Failed to load CLUT file!");
+			ImGui::Spacing();
+			if (ImGui::Button("OK", ImVec2(120, 0)))
+			{
+				ImGui::CloseCurrentPopup();
+			}
+			ImGui::EndPopup();
+		}
+
 		ImGui::End();
 	}
 }
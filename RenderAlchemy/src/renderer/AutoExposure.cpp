@@ -0,0 +1,131 @@
+#include "AutoExposure.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "Shader.h"
+
+namespace
+{
+	constexpr int kGroupSize = 16;
+
+	// Time constants until the remaining error is below 1%
+	constexpr float kSettleTimeConstants = 4.6f;
+} // namespace
+
+AutoExposure::~AutoExposure()
+{
+	destroy();
+}
+
+bool AutoExposure::isSupported()
+{
+	const bgfx::Caps* caps = bgfx::getCaps();
+	return caps != nullptr && (caps->supported & BGFX_CAPS_COMPUTE) != 0;
+}
+
+bool AutoExposure::create()
+{
+	destroy();
+
+	if (!isSupported())
+	{
+		std::cerr << "Auto exposure requires compute support" << std::endl;
+		return false;
+	}
+
+	histogramProgram = std::make_unique<Shader>("shaders/cs_exposure_histogram.sc");
+	adaptProgram = std::make_unique<Shader>("shaders/cs_exposure_adapt.sc");
+
+	if (!bgfx::isValid(histogramProgram->m_program) || !bgfx::isValid(adaptProgram->m_program))
+	{
+		std::cerr << "Failed to create auto exposure programs" << std::endl;
+		destroy();
+		return false;
+	}
+
+	// Bins start at zero; the adapt pass clears them after reading
+	std::vector<uint32_t> zeroBins(kBins, 0);
+	bins = bgfx::createDynamicIndexBuffer(bgfx::copy(zeroBins.data(), sizeof(uint32_t) * kBins), BGFX_BUFFER_COMPUTE_READ_WRITE | BGFX_BUFFER_INDEX32);
+
+	const float neutral = 1.0f;
+	exposure = bgfx::createTexture2D(1, 1, false, 1, bgfx::TextureFormat::R32F, BGFX_TEXTURE_COMPUTE_WRITE | BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP, bgfx::copy(&neutral, sizeof(neutral)));
+
+	hdrSampler = bgfx::createUniform("s_hdrBuffer", bgfx::UniformType::Sampler);
+	sampleParamsUniform = bgfx::createUniform("u_exposureSamples", bgfx::UniformType::Vec4);
+	rangeUniform = bgfx::createUniform("u_exposureRange", bgfx::UniformType::Vec4);
+	adaptParamsUniform = bgfx::createUniform("u_exposureAdapt", bgfx::UniformType::Vec4);
+	limitsUniform = bgfx::createUniform("u_exposureLimits", bgfx::UniformType::Vec4);
+
+	resetPending = true;
+	return true;
+}
+
+void AutoExposure::destroy()
+{
+	if (bgfx::isValid(bins))
+	{
+		bgfx::destroy(bins);
+		bins = BGFX_INVALID_HANDLE;
+	}
+
+	if (bgfx::isValid(exposure))
+	{
+		bgfx::destroy(exposure);
+		exposure = BGFX_INVALID_HANDLE;
+	}
+
+	bgfx::UniformHandle* uniforms[] = { &hdrSampler, &sampleParamsUniform, &rangeUniform, &adaptParamsUniform, &limitsUniform };
+	for (bgfx::UniformHandle* uniform : uniforms)
+	{
+		if (bgfx::isValid(*uniform))
+		{
+			bgfx::destroy(*uniform);
+			*uniform = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	histogramProgram.reset();
+	adaptProgram.reset();
+}
+
+void AutoExposure::reset()
+{
+	resetPending = true;
+}
+
+bool AutoExposure::isAdapting(double now, const Settings& settings) const
+{
+	const float slowest = std::max(std::min(settings.speedUp, settings.speedDown), 0.01f);
+	return resetPending || now - changedTime < kSettleTimeConstants / slowest;
+}
+
+void AutoExposure::update(bgfx::ViewId view, bgfx::TextureHandle hdr, int width, int height, float deltaTime, const Settings& settings)
+{
+	if (!isValid() || !bgfx::isValid(hdr) || width <= 0 || height <= 0)
+		return;
+
+	const int samplesX = std::min(std::max(width / 2, 1), kMaxSamplesX);
+	const int samplesY = std::min(std::max(height / 2, 1), kMaxSamplesY);
+
+	const float sampleParams[4] = { float(samplesX), float(samplesY), float(width), float(height) };
+	const float range[4] = { settings.minLogLuminance, std::max(settings.maxLogLuminance - settings.minLogLuminance, 0.01f), settings.lowPercentile, std::max(settings.highPercentile, settings.lowPercentile) };
+	const float adapt[4] = { resetPending ? -1.0f : deltaTime, settings.speedUp, settings.speedDown, 0.0f };
+	bgfx::setUniform(sampleParamsUniform, sampleParams);
+	bgfx::setUniform(rangeUniform, range);
+	bgfx::setTexture(0, hdrSampler, hdr, BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP);
+	bgfx::setBuffer(1, bins, bgfx::Access::ReadWrite);
+	bgfx::dispatch(view, histogramProgram->m_program, uint32_t(samplesX + kGroupSize - 1) / kGroupSize, uint32_t(samplesY + kGroupSize - 1) / kGroupSize);
+
+	// The adapt pass reads the range and percentiles too, uniforms are consumed by every dispatch
+	const float limits[4] = { settings.minExposure, settings.maxExposure, 0.0f, 0.0f };
+	bgfx::setUniform(rangeUniform, range);
+	bgfx::setUniform(adaptParamsUniform, adapt);
+	bgfx::setUniform(limitsUniform, limits);
+	bgfx::setBuffer(0, bins, bgfx::Access::ReadWrite);
+	bgfx::setImage(1, exposure, 0, bgfx::Access::ReadWrite, bgfx::TextureFormat::R32F);
+	bgfx::dispatch(view, adaptProgram->m_program, 1);
+
+	resetPending = false;
+}
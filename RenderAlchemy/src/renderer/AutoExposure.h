@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <memory>
+
+class Shader;
+
+// Automatic exposure from the HDR image, computed and applied without leaving the GPU.
+// A compute pass builds a log luminance histogram over a half resolution sample grid, then a single group
+// averages the bins between two percentiles, so a few very dark or bright pixels do not pull the result,
+// and eases the exposure stored in a 1x1 texture towards the one mapping that average to middle grey.
+// The tonemap pass multiplies by that texel, so the CPU never waits for the result.
+class AutoExposure
+{
+public:
+	static constexpr int kBins = 256;
+
+	// Largest sample grid; the HDR image is sampled every second pixel up to this
+	static constexpr int kMaxSamplesX = 960;
+	static constexpr int kMaxSamplesY = 540;
+
+	struct Settings
+	{
+		float minLogLuminance = -10.0f; // Histogram range in stops
+		float maxLogLuminance = 6.0f;
+		float lowPercentile = 0.5f;     // Fraction of the darkest samples ignored
+		float highPercentile = 0.95f;   // Fraction of samples below the brightest ones ignored
+		float speedUp = 3.0f;           // Adaptation rate towards a brighter exposure, per second
+		float speedDown = 1.0f;         // Adaptation rate towards a darker exposure, per second
+		float minExposure = 0.03f;
+		float maxExposure = 32.0f;
+	};
+
+	AutoExposure() = default;
+	~AutoExposure();
+
+	// True when the renderer supports compute
+	static bool isSupported();
+
+	// Create the programs, histogram buffer and exposure texture; returns false when unsupported
+	bool create();
+
+	// Release all GPU resources
+	void destroy();
+
+	// Measure the HDR image, width by height pixels, and adapt the exposure over deltaTime seconds
+	void update(bgfx::ViewId view, bgfx::TextureHandle hdr, int width, int height, float deltaTime, const Settings& settings);
+
+	// Jump straight to the measured exposure on the next update instead of adapting
+	void reset();
+
+	// Keep updating for a while after the image or settings change, until the adaptation has settled.
+	// now is in seconds on any steady clock.
+	void markChanged(double now) { changedTime = now; }
+	bool isAdapting(double now, const Settings& settings) const;
+
+	bool isValid() const { return bgfx::isValid(exposure); }
+
+	// 1x1 R32F exposure multiplier for the tonemap pass
+	bgfx::TextureHandle getTexture() const { return exposure; }
+
+private:
+	bool resetPending = true;
+	double changedTime = 0.0;
+
+	std::unique_ptr<Shader> histogramProgram;
+	std::unique_ptr<Shader> adaptProgram;
+
+	bgfx::DynamicIndexBufferHandle bins = BGFX_INVALID_HANDLE;
+	bgfx::TextureHandle exposure = BGFX_INVALID_HANDLE;
+
+	bgfx::UniformHandle hdrSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle sampleParamsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle rangeUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle adaptParamsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle limitsUniform = BGFX_INVALID_HANDLE;
+};
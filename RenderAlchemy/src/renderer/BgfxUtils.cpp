@@ -7,6 +7,8 @@
 #include <bx/bx.h>
 #include <bx/file.h>
 
+#include "../core/AllocationTracker.h"
+
 bool BgfxUtils::init(int width, int height, void* nativeWindowHandle) {
     if (nativeWindowHandle == nullptr) {
         std::cerr << "Error: nativeWindowHandle is null!" << std::endl;
@@ -31,6 +33,8 @@ bool BgfxUtils::init(int width, int height, void* nativeWindowHandle) {
     init.resolution.width = width;
     init.resolution.height = height;
     init.resolution.reset = BGFX_RESET_VSYNC;
+    init.limits.maxEncoders = 16; // One per submission thread, see ParallelSubmit::kMaxThreads
+    init.allocator = AllocationTracker::getBgfxAllocator(); // Counts bgfx allocations per frame
 	init.platformData = pd;
 
     if (!bgfx::init(init)) {
@@ -38,8 +42,8 @@ bool BgfxUtils::init(int width, int height, void* nativeWindowHandle) {
         return false;
     }
 
-    // Enable debug text
-    bgfx::setDebug(BGFX_DEBUG_TEXT | BGFX_DEBUG_STATS);
+    // Enable debug text, and per-view GPU timings used to pick the depth prepass mode
+    bgfx::setDebug(BGFX_DEBUG_TEXT | BGFX_DEBUG_STATS | BGFX_DEBUG_PROFILER);
 
     // Set view clear state
     bgfx::setViewClear(0, 
@@ -63,12 +67,12 @@ void BgfxUtils::resize(int width, int height) {
     bgfx::setViewRect(0, 0, 0, width, height);
 }
 
-void BgfxUtils::beginFrame() {
-    bgfx::touch(0);
+void BgfxUtils::beginFrame(bgfx::ViewId view) {
+    bgfx::touch(view);
 }
 
-void BgfxUtils::endFrame() {
-    bgfx::frame();
+uint32_t BgfxUtils::endFrame() {
+    return bgfx::frame();
 }
 
 bgfx::ShaderHandle BgfxUtils::loadShader(const std::string& filePath) {
@@ -16,11 +16,11 @@ public:
     // Resize the viewport
     static void resize(int width, int height);
     
-    // Begin frame
-    static void beginFrame();
+    // Begin frame; the given view is touched so it is submitted even without draws
+    static void beginFrame(bgfx::ViewId view = 0);
     
-    // End frame and present
-    static void endFrame();
+    // End frame and present; returns the number of the frame just submitted
+    static uint32_t endFrame();
     
     // Load shader from file
     static bgfx::ShaderHandle loadShader(const std::string& filePath);
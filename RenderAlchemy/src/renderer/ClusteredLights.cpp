@@ -0,0 +1,366 @@
+#include "ClusteredLights.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "../core/JobSystem.h"
+
+namespace
+{
+	// Light data texture: row 0 holds position and radius, row 1 colour premultiplied by intensity
+	constexpr int kLightRows = 2;
+
+	int clampCell(float value, int count)
+	{
+		return std::clamp(static_cast<int>(std::floor(value)), 0, count - 1);
+	}
+} // namespace
+
+ClusteredLights::ClusteredLights()
+	: clusterCounts(kClusterCount, 0)
+	, clusterLights(size_t(kClusterCount) * kMaxLightsPerCluster, 0)
+	, clusterParams{ float(kClustersX), float(kClustersY), float(kClustersZ), 0.0f }
+	, clusterDepth{ 0.1f, 1.0f, float(kIndexWidth), 0.0f }
+{
+	for (Staging& buffers : staging)
+	{
+		buffers.grid.resize(size_t(kClusterCount) * 2, 0.0f);
+		buffers.indices.resize(size_t(kIndexWidth) * kIndexHeight, 0.0f);
+	}
+	fallback.grid.resize(size_t(kClusterCount) * 2, 0.0f);
+	fallback.indices.resize(size_t(kIndexWidth) * kIndexHeight, 0.0f);
+}
+
+ClusteredLights::~ClusteredLights()
+{
+	destroy();
+}
+
+void ClusteredLights::create()
+{
+	destroy();
+
+	const uint64_t flags = BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP;
+	lightTexture = bgfx::createTexture2D(uint16_t(kMaxLights), uint16_t(kLightRows), false, 1, bgfx::TextureFormat::RGBA32F, flags);
+	gridTexture = bgfx::createTexture2D(uint16_t(kClustersX * kClustersY), uint16_t(kClustersZ), false, 1, bgfx::TextureFormat::RG32F, flags);
+	indexTexture = bgfx::createTexture2D(uint16_t(kIndexWidth), uint16_t(kIndexHeight), false, 1, bgfx::TextureFormat::R32F, flags);
+
+	lightSampler = bgfx::createUniform("s_lights", bgfx::UniformType::Sampler);
+	gridSampler = bgfx::createUniform("s_lightGrid", bgfx::UniformType::Sampler);
+	indexSampler = bgfx::createUniform("s_lightIndices", bgfx::UniformType::Sampler);
+	clusterParamsUniform = bgfx::createUniform("u_clusterParams", bgfx::UniformType::Vec4);
+	clusterDepthUniform = bgfx::createUniform("u_clusterDepth", bgfx::UniformType::Vec4);
+	lightsDirty = true;
+	assigned = false;
+}
+
+void ClusteredLights::destroy()
+{
+	bgfx::TextureHandle* textures[] = { &lightTexture, &gridTexture, &indexTexture };
+	for (bgfx::TextureHandle* texture : textures)
+	{
+		if (bgfx::isValid(*texture))
+		{
+			bgfx::destroy(*texture);
+			*texture = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	bgfx::UniformHandle* uniforms[] = { &lightSampler, &gridSampler, &indexSampler, &clusterParamsUniform, &clusterDepthUniform };
+	for (bgfx::UniformHandle* uniform : uniforms)
+	{
+		if (bgfx::isValid(*uniform))
+		{
+			bgfx::destroy(*uniform);
+			*uniform = BGFX_INVALID_HANDLE;
+		}
+	}
+}
+
+void ClusteredLights::setLights(const std::vector<PointLight>& newLights)
+{
+	lights.assign(newLights.begin(), newLights.begin() + std::min<size_t>(newLights.size(), kMaxLights));
+	lightsDirty = true;
+}
+
+void ClusteredLights::generateStressLights(uint32_t count, float radius, std::vector<PointLight>& result)
+{
+	// Fixed seed so every run measures the same distribution
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> x(-12.0f, 12.0f);
+	std::uniform_real_distribution<float> y(-0.9f, 2.5f);
+	std::uniform_real_distribution<float> z(-25.0f, 4.0f);
+	std::uniform_real_distribution<float> hue(0.0f, 1.0f);
+
+	const float tau = 6.28318530718f;
+
+	result.resize(std::min(count, kMaxLights));
+	for (PointLight& light : result)
+	{
+		light.position[0] = x(rng);
+		light.position[1] = y(rng);
+		light.position[2] = z(rng);
+		light.radius = radius;
+
+		const float h = hue(rng);
+		light.color[0] = 0.5f + 0.5f * std::cos(tau * h);
+		light.color[1] = 0.5f + 0.5f * std::cos(tau * (h - 1.0f / 3.0f));
+		light.color[2] = 0.5f + 0.5f * std::cos(tau * (h - 2.0f / 3.0f));
+		light.intensity = 2.0f;
+	}
+}
+
+void ClusteredLights::update(const float* view, const float* proj, float nearPlane, float farPlane)
+{
+	// The textures still hold the assignment for this camera
+	if (assigned && !lightsDirty && nearPlane == assignedNear && farPlane == assignedFar &&
+	    std::memcmp(view, assignedView, sizeof(assignedView)) == 0 && std::memcmp(proj, assignedProj, sizeof(assignedProj)) == 0)
+	{
+		return;
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	// Exponential depth slices: slice = log(depth / near) * sliceScale
+	const float sliceScale = kClustersZ / std::log(farPlane / nearPlane);
+	auto sliceOf = [&](float depth) {
+		return clampCell(std::log(std::max(depth, nearPlane) / nearPlane) * sliceScale, kClustersZ);
+	};
+
+	for (int z = 0; z <= kClustersZ; ++z)
+	{
+		sliceDepth[z] = nearPlane * std::exp(z / sliceScale);
+	}
+	sliceDepth[kClustersZ] = farPlane;
+
+	projScale[0] = proj[0];
+	projScale[1] = proj[5];
+	projOffset[0] = proj[8];
+	projOffset[1] = proj[9];
+
+	// View space sphere of every light and the slices it reaches
+	ranges.resize(lights.size());
+	for (size_t i = 0; i < lights.size(); ++i)
+	{
+		const PointLight& light = lights[i];
+		const float* p = light.position;
+
+		LightRange& range = ranges[i];
+		range.x = view[0] * p[0] + view[4] * p[1] + view[8] * p[2] + view[12];
+		range.y = view[1] * p[0] + view[5] * p[1] + view[9] * p[2] + view[13];
+		range.depth = -(view[2] * p[0] + view[6] * p[1] + view[10] * p[2] + view[14]);
+		range.radius = light.radius;
+
+		if (range.depth + range.radius < nearPlane || range.depth - range.radius > farPlane)
+		{
+			range.minZ = 1;
+			range.maxZ = 0;
+			continue;
+		}
+
+		range.minZ = sliceOf(range.depth - range.radius);
+		range.maxZ = sliceOf(range.depth + range.radius);
+	}
+
+	// Depth slices never share clusters, so jobs fill their own bands; near slices hold more lights, the
+	// automatic grain leaves enough bands for idle workers to steal from the busy ones
+	std::atomic<uint32_t> overflow{ 0 };
+	JobSystem::parallelFor(0, kClustersZ, [this, &overflow](uint32_t sliceBegin, uint32_t sliceEnd) {
+		overflow.fetch_add(assignSlices(static_cast<int>(sliceBegin), static_cast<int>(sliceEnd)), std::memory_order_relaxed);
+	});
+	overflowCount = overflow.load();
+
+	// Build the upload in the next staging buffer bgfx has released
+	Staging* target = &fallback;
+	for (int i = 0; i < kStagingCount; ++i)
+	{
+		Staging& candidate = staging[(nextStaging + i) % kStagingCount];
+		if (candidate.references.load(std::memory_order_acquire) == 0)
+		{
+			target = &candidate;
+			nextStaging = (nextStaging + i + 1) % kStagingCount;
+			break;
+		}
+	}
+	float* gridTexels = target->grid.data();
+	float* indexTexels = target->indices.data();
+
+	// Flatten the per-cluster lists into one index list with an offset and count per cluster
+	const uint32_t indexCapacity = uint32_t(kIndexWidth) * kIndexHeight;
+	indexCount = 0;
+	maxClusterLights = 0;
+	for (int cluster = 0; cluster < kClusterCount; ++cluster)
+	{
+		uint32_t count = clusterCounts[cluster];
+		if (indexCount + count > indexCapacity)
+		{
+			overflowCount += indexCount + count - indexCapacity;
+			count = indexCapacity - indexCount;
+		}
+
+		gridTexels[cluster * 2 + 0] = static_cast<float>(indexCount);
+		gridTexels[cluster * 2 + 1] = static_cast<float>(count);
+
+		const uint16_t* source = &clusterLights[size_t(cluster) * kMaxLightsPerCluster];
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			indexTexels[indexCount++] = static_cast<float>(source[i]);
+		}
+		maxClusterLights = std::max(maxClusterLights, count);
+	}
+
+	// Pack light data row by row for the used width only
+	const uint32_t lightCount = static_cast<uint32_t>(lights.size());
+	lightTexels.resize(size_t(std::max(lightCount, 1u)) * kLightRows * 4);
+	for (uint32_t i = 0; lightsDirty && i < lightCount; ++i)
+	{
+		const PointLight& light = lights[i];
+		float* position = &lightTexels[i * 4];
+		float* color = &lightTexels[(lightCount + i) * 4];
+		position[0] = light.position[0];
+		position[1] = light.position[1];
+		position[2] = light.position[2];
+		position[3] = light.radius;
+		color[0] = light.color[0] * light.intensity;
+		color[1] = light.color[1] * light.intensity;
+		color[2] = light.color[2] * light.intensity;
+		color[3] = 0.0f;
+	}
+
+	clusterParams[3] = static_cast<float>(lightCount);
+	clusterDepth[0] = nearPlane;
+	clusterDepth[1] = sliceScale;
+
+	if (bgfx::isValid(gridTexture))
+	{
+		// Staging memory is referenced until bgfx releases it, the fallback is copied as it is reused right away
+		const uint32_t rows = (indexCount + kIndexWidth - 1) / kIndexWidth;
+		const uint32_t gridBytes = uint32_t(target->grid.size() * sizeof(float));
+		const uint32_t indexBytes = uint32_t(rows * kIndexWidth * sizeof(float));
+		auto reference = [target, this](const float* data, uint32_t size) {
+			if (target == &fallback)
+				return bgfx::copy(data, size);
+
+			target->references.fetch_add(1, std::memory_order_relaxed);
+			return bgfx::makeRef(data, size, &ClusteredLights::releaseStaging, target);
+		};
+
+		bgfx::updateTexture2D(gridTexture, 0, 0, 0, 0, uint16_t(kClustersX * kClustersY), uint16_t(kClustersZ), reference(gridTexels, gridBytes));
+
+		if (lightsDirty && lightCount > 0)
+		{
+			bgfx::updateTexture2D(lightTexture, 0, 0, 0, 0, uint16_t(lightCount), uint16_t(kLightRows), bgfx::copy(lightTexels.data(), uint32_t(size_t(lightCount) * kLightRows * 4 * sizeof(float))));
+		}
+
+		// Only the rows holding indices this frame
+		if (rows > 0)
+		{
+			bgfx::updateTexture2D(indexTexture, 0, 0, 0, 0, uint16_t(kIndexWidth), uint16_t(rows), reference(indexTexels, indexBytes));
+		}
+		lightsDirty = false;
+
+		assigned = true;
+		std::memcpy(assignedView, view, sizeof(assignedView));
+		std::memcpy(assignedProj, proj, sizeof(assignedProj));
+		assignedNear = nearPlane;
+		assignedFar = farPlane;
+	}
+
+	assignMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ClusteredLights::releaseStaging(void* /*data*/, void* userData)
+{
+	static_cast<Staging*>(userData)->references.fetch_sub(1, std::memory_order_release);
+}
+
+uint32_t ClusteredLights::assignSlices(int sliceBegin, int sliceEnd)
+{
+	uint32_t overflow = 0;
+
+	for (int z = sliceBegin; z < sliceEnd; ++z)
+	{
+		std::fill(clusterCounts.begin() + z * kClustersX * kClustersY, clusterCounts.begin() + (z + 1) * kClustersX * kClustersY, uint16_t(0));
+
+		for (size_t i = 0; i < ranges.size(); ++i)
+		{
+			const LightRange& range = ranges[i];
+			if (z < range.minZ || z > range.maxZ)
+				continue;
+
+			// Part of the sphere inside this slice, and its largest half extent there. The slice bounds are
+			// widened slightly so rounding in the shader's slice lookup cannot miss a light.
+			const float nearDepth = std::max(range.depth - range.radius, sliceDepth[z] * 0.999f);
+			const float farDepth = std::min(range.depth + range.radius, sliceDepth[z + 1] * 1.001f);
+			const float closest = std::clamp(range.depth, nearDepth, farDepth);
+			const float offset = closest - range.depth;
+			const float extent = std::sqrt(std::max(range.radius * range.radius - offset * offset, 0.0f));
+
+			// Projection is monotonic in each coordinate, so the corners of the slab bound it on screen
+			int cells[2][2];
+			const float center[2] = { range.x, range.y };
+			const int counts[2] = { kClustersX, kClustersY };
+			for (int axis = 0; axis < 2; ++axis)
+			{
+				float minNdc = 1.0f;
+				float maxNdc = -1.0f;
+				for (float depth : { nearDepth, farDepth })
+				{
+					for (float sign : { -1.0f, 1.0f })
+					{
+						const float ndc = projScale[axis] * (center[axis] + sign * extent) / depth - projOffset[axis];
+						minNdc = std::min(minNdc, ndc);
+						maxNdc = std::max(maxNdc, ndc);
+					}
+				}
+				cells[axis][0] = minNdc > 1.0f ? counts[axis] : clampCell((minNdc * 0.5f + 0.5f) * counts[axis], counts[axis]);
+				cells[axis][1] = maxNdc < -1.0f ? -1 : clampCell((maxNdc * 0.5f + 0.5f) * counts[axis], counts[axis]);
+			}
+
+			for (int y = cells[1][0]; y <= cells[1][1]; ++y)
+			{
+				for (int x = cells[0][0]; x <= cells[0][1]; ++x)
+				{
+					const int cluster = (z * kClustersY + y) * kClustersX + x;
+					uint16_t& count = clusterCounts[cluster];
+					if (count == kMaxLightsPerCluster)
+					{
+						++overflow;
+						continue;
+					}
+					clusterLights[size_t(cluster) * kMaxLightsPerCluster + count++] = static_cast<uint16_t>(i);
+				}
+			}
+		}
+	}
+
+	return overflow;
+}
+
+void ClusteredLights::bind() const
+{
+	if (!bgfx::isValid(gridTexture))
+		return;
+
+	bgfx::setTexture(0, lightSampler, lightTexture);
+	bgfx::setTexture(1, gridSampler, gridTexture);
+	bgfx::setTexture(2, indexSampler, indexTexture);
+	bgfx::setUniform(clusterParamsUniform, clusterParams);
+	bgfx::setUniform(clusterDepthUniform, clusterDepth);
+}
+
+void ClusteredLights::bind(bgfx::Encoder* encoder) const
+{
+	if (!bgfx::isValid(gridTexture))
+		return;
+
+	encoder->setTexture(0, lightSampler, lightTexture);
+	encoder->setTexture(1, gridSampler, gridTexture);
+	encoder->setTexture(2, indexSampler, indexTexture);
+	encoder->setUniform(clusterParamsUniform, clusterParams);
+	encoder->setUniform(clusterDepthUniform, clusterDepth);
+}
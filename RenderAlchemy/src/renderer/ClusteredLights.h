@@ -0,0 +1,145 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Point light with a finite range, contributions fade to zero at the radius
+struct PointLight
+{
+	float position[3];
+	float radius;
+	float color[3];
+	float intensity;
+};
+
+// Clustered forward lighting.
+// The view frustum is split into a grid of clusters, uniform in screen space and exponential in depth.
+// Whenever the camera or the lights change the lights are assigned to the clusters they touch as parallel
+// jobs, and the result is uploaded as three float textures: light data, per-cluster offset and count, and
+// the flat light index list. The scene shader finds its cluster from the fragment position and only loops
+// over those lights. The grid and index list are built in a ring of persistent staging buffers that bgfx
+// reads by reference instead of copying, and frames with the same camera and lights upload nothing.
+class ClusteredLights
+{
+public:
+	static constexpr int kClustersX = 16;
+	static constexpr int kClustersY = 9;
+	static constexpr int kClustersZ = 24;
+	static constexpr int kClusterCount = kClustersX * kClustersY * kClustersZ;
+
+	static constexpr uint32_t kMaxLights = 1024;
+	static constexpr uint32_t kMaxLightsPerCluster = 128;
+
+	// Light index texture dimensions, bounding the total number of cluster entries
+	static constexpr int kIndexWidth = 1024;
+	static constexpr int kIndexHeight = 256;
+
+	ClusteredLights();
+	~ClusteredLights();
+
+	// Create textures and uniforms
+	void create();
+
+	// Release all GPU resources
+	void destroy();
+
+	// Replace the light list; anything past kMaxLights is ignored
+	void setLights(const std::vector<PointLight>& newLights);
+
+	// Fill with a deterministic stress test: count lights of the given radius scattered over the scene
+	static void generateStressLights(uint32_t count, float radius, std::vector<PointLight>& result);
+
+	// Assign lights to clusters for this frame's camera and upload the result; does nothing when neither the
+	// camera nor the lights changed since the last call. view and proj are column-major, near and far must
+	// match the projection.
+	void update(const float* view, const float* proj, float nearPlane, float farPlane);
+
+	// Bind the cluster textures and uniforms for the next submit
+	void bind() const;
+
+	// Same as bind() on an encoder owned by a worker thread
+	void bind(bgfx::Encoder* encoder) const;
+
+	// Statistics from the last assignment
+	uint32_t getLightCount() const { return static_cast<uint32_t>(lights.size()); }
+	uint32_t getIndexCount() const { return indexCount; }
+	uint32_t getMaxClusterLights() const { return maxClusterLights; }
+	uint32_t getOverflowCount() const { return overflowCount; }
+	float getAssignTime() const { return assignMs; }
+
+private:
+	// View space bounding sphere of a light and the depth slices it covers, inclusive; minZ > maxZ when culled
+	struct LightRange
+	{
+		float x, y, depth, radius;
+		int minZ, maxZ;
+	};
+
+	// Grid and index texels of one upload, owned by bgfx until it releases both references
+	struct Staging
+	{
+		std::vector<float> grid;
+		std::vector<float> indices;
+		std::atomic<int> references{ 0 };
+	};
+
+	// Enough for the frame being recorded and the ones bgfx may still be rendering
+	static constexpr int kStagingCount = 3;
+
+	// Add every light overlapping depth slices [sliceBegin, sliceEnd) to its clusters; returns dropped entries
+	uint32_t assignSlices(int sliceBegin, int sliceEnd);
+
+	// bgfx::ReleaseFn for staging memory, called once the renderer has consumed it
+	static void releaseStaging(void* data, void* userData);
+
+	std::vector<PointLight> lights;
+	std::vector<LightRange> ranges;
+
+	// Projection terms and the view depth at the start of every slice, plus the far plane
+	float projScale[2];
+	float projOffset[2];
+	float sliceDepth[kClustersZ + 1];
+
+	// Fixed capacity per cluster so slices can be filled in parallel without synchronisation
+	std::vector<uint16_t> clusterCounts;
+	std::vector<uint16_t> clusterLights;
+
+	// Upload staging: light texels, then cluster offset/count pairs and the flat index list per upload in flight.
+	// A frame that finds every staging buffer still referenced builds into the fallback one and copies it.
+	std::vector<float> lightTexels;
+	Staging staging[kStagingCount];
+	Staging fallback;
+	int nextStaging = 0;
+
+	// The light texels don't depend on the camera, they are packed and uploaded again only after setLights
+	bool lightsDirty = true;
+
+	// Camera of the last assignment, which stays valid until it or the lights change
+	bool assigned = false;
+	float assignedView[16];
+	float assignedProj[16];
+	float assignedNear = 0.0f;
+	float assignedFar = 0.0f;
+
+	uint32_t indexCount = 0;
+	uint32_t maxClusterLights = 0;
+	uint32_t overflowCount = 0;
+	float assignMs = 0.0f;
+
+	// x, y, z = cluster counts, w = light count
+	float clusterParams[4];
+	// x = near plane, y = depth slices per log unit, z = index texture width
+	float clusterDepth[4];
+
+	bgfx::TextureHandle lightTexture = BGFX_INVALID_HANDLE;
+	bgfx::TextureHandle gridTexture = BGFX_INVALID_HANDLE;
+	bgfx::TextureHandle indexTexture = BGFX_INVALID_HANDLE;
+
+	bgfx::UniformHandle lightSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle gridSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle indexSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle clusterParamsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle clusterDepthUniform = BGFX_INVALID_HANDLE;
+};
@@ -0,0 +1,87 @@
+#include "ComputeTonemap.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Shader.h"
+
+namespace
+{
+	// Stage of the output image, after the samplers of the tonemap pass
+	constexpr uint8_t kImageStage = 5;
+} // namespace
+
+ComputeTonemap::~ComputeTonemap()
+{
+	destroy();
+}
+
+bool ComputeTonemap::isSupported()
+{
+	const bgfx::Caps* caps = bgfx::getCaps();
+	return caps != nullptr && (caps->supported & BGFX_CAPS_COMPUTE) != 0 && (caps->formats[bgfx::TextureFormat::RGBA8] & BGFX_CAPS_FORMAT_TEXTURE_IMAGE_WRITE) != 0;
+}
+
+bool ComputeTonemap::create(int width, int height)
+{
+	destroy();
+
+	if (!isSupported())
+	{
+		std::cerr << "Compute tonemapping requires compute support and RGBA8 image writes" << std::endl;
+		return false;
+	}
+
+	program = std::make_unique<Shader>("shaders/cs_tonemap.sc");
+	if (!bgfx::isValid(program->m_program))
+	{
+		std::cerr << "Failed to create compute tonemap program" << std::endl;
+		destroy();
+		return false;
+	}
+
+	imageUniform = bgfx::createUniform("u_tonemapImage", bgfx::UniformType::Vec4);
+	resize(width, height);
+	return true;
+}
+
+void ComputeTonemap::resize(int width, int height)
+{
+	if (bgfx::isValid(image))
+	{
+		bgfx::destroy(image);
+	}
+
+	this->width = std::max(width, 1);
+	this->height = std::max(height, 1);
+	image = bgfx::createTexture2D(uint16_t(this->width), uint16_t(this->height), false, 1, bgfx::TextureFormat::RGBA8, BGFX_TEXTURE_COMPUTE_WRITE | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+}
+
+void ComputeTonemap::destroy()
+{
+	if (bgfx::isValid(image))
+	{
+		bgfx::destroy(image);
+		image = BGFX_INVALID_HANDLE;
+	}
+
+	if (bgfx::isValid(imageUniform))
+	{
+		bgfx::destroy(imageUniform);
+		imageUniform = BGFX_INVALID_HANDLE;
+	}
+
+	program.reset();
+}
+
+void ComputeTonemap::dispatch(bgfx::ViewId view)
+{
+	if (!isValid() || !program)
+		return;
+
+	const bgfx::Caps* caps = bgfx::getCaps();
+	const float imageParams[4] = { float(width), float(height), caps->originBottomLeft ? 0.0f : 1.0f, 0.0f };
+	bgfx::setUniform(imageUniform, imageParams);
+	bgfx::setImage(kImageStage, image, 0, bgfx::Access::Write, bgfx::TextureFormat::RGBA8);
+	bgfx::dispatch(view, program->m_program, uint32_t(width + kGroupSize - 1) / kGroupSize, uint32_t(height + kGroupSize - 1) / kGroupSize);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <memory>
+
+class Shader;
+
+// Compute implementation of the tonemap pass, an alternative to drawing the screen quad through the raster
+// pipeline. Each 8x8 group reads the exposure and a 1D CLUT once into shared memory and writes its tile of
+// the graded image straight into an RGBA8 image, which the present pass and the scopes read in place of the
+// LDR framebuffer. The tone mapping and grading code is shared with the raster pass (shaders/tonemap.sh),
+// and the tonemap uniforms and textures are bound by the caller the same way for both paths.
+class ComputeTonemap
+{
+public:
+	static constexpr int kGroupSize = 8;
+
+	ComputeTonemap() = default;
+	~ComputeTonemap();
+
+	// True when the renderer supports compute and writing RGBA8 images
+	static bool isSupported();
+
+	// Create the program and a width by height output image; returns false when unsupported
+	bool create(int width, int height);
+
+	// Recreate the output image at a new size
+	void resize(int width, int height);
+
+	// Release all GPU resources
+	void destroy();
+
+	// Tonemap into the output image; bind the tonemap uniforms and textures first
+	void dispatch(bgfx::ViewId view);
+
+	bool isValid() const { return bgfx::isValid(image); }
+
+	// Graded image, sampled like the LDR framebuffer colour texture
+	bgfx::TextureHandle getTexture() const { return image; }
+
+private:
+	int width = 0;
+	int height = 0;
+
+	std::unique_ptr<Shader> program;
+	bgfx::TextureHandle image = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle imageUniform = BGFX_INVALID_HANDLE;
+};
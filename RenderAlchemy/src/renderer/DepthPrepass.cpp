@@ -0,0 +1,82 @@
+#include "DepthPrepass.h"
+
+void DepthPrepass::setMode(DepthPrepassMode newMode)
+{
+	if (newMode == mode)
+		return;
+
+	mode = newMode;
+	if (mode == DepthPrepassMode::Auto)
+	{
+		restart();
+	}
+}
+
+void DepthPrepass::restart()
+{
+	phase = Phase::MeasureWithout;
+	frames = 0;
+	samples = 0;
+	sum = 0.0f;
+	averageMs[0] = -1.0f;
+	averageMs[1] = -1.0f;
+}
+
+bool DepthPrepass::beginFrame(uint64_t sceneKey)
+{
+	if (mode == DepthPrepassMode::Auto && sceneKey != key)
+	{
+		restart();
+	}
+	key = sceneKey;
+
+	switch (mode)
+	{
+	case DepthPrepassMode::Off:
+		active = false;
+		break;
+	case DepthPrepassMode::On:
+		active = true;
+		break;
+	case DepthPrepassMode::Auto:
+		active = phase == Phase::Decided ? preferPrepass : phase == Phase::MeasureWith;
+		break;
+	}
+
+	return active;
+}
+
+void DepthPrepass::endFrame(float sceneGpuMs)
+{
+	if (!isMeasuring())
+		return;
+
+	if (++frames <= kWarmupFrames)
+		return;
+
+	sum += sceneGpuMs;
+	if (++samples < kSampleFrames)
+		return;
+
+	// Finished timing one path, move on to the other or settle on the faster one
+	const int path = phase == Phase::MeasureWith ? 1 : 0;
+	averageMs[path] = sum / samples;
+	frames = 0;
+	samples = 0;
+	sum = 0.0f;
+
+	if (phase == Phase::MeasureWithout)
+	{
+		phase = Phase::MeasureWith;
+	}
+	else
+	{
+		phase = Phase::Decided;
+		preferPrepass = averageMs[1] < averageMs[0];
+	}
+}
+
+float DepthPrepass::getAverageMs(bool prepass) const
+{
+	return averageMs[prepass ? 1 : 0];
+}
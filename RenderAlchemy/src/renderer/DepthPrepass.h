@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+enum class DepthPrepassMode
+{
+	Off,
+	On,
+	Auto
+};
+
+// Decides each frame whether the scene is drawn with a depth-only prepass followed by an EQUAL depth
+// colour pass. In Auto mode both paths are timed with GPU timers and the faster one is kept until the
+// scene changes.
+class DepthPrepass
+{
+public:
+	// GPU timings lag a few frames behind submission, so samples right after a switch are dropped
+	static constexpr int kWarmupFrames = 4;
+	static constexpr int kSampleFrames = 32;
+
+	void setMode(DepthPrepassMode newMode);
+	DepthPrepassMode getMode() const { return mode; }
+
+	// Start a frame; sceneKey identifies what is being drawn and restarts the measurement when it changes.
+	// Returns true when this frame should use the prepass.
+	bool beginFrame(uint64_t sceneKey);
+
+	// Report the GPU time of the prepass and colour views for the frame started with beginFrame
+	void endFrame(float sceneGpuMs);
+
+	// True while Auto mode is still timing either path
+	bool isMeasuring() const { return mode == DepthPrepassMode::Auto && phase != Phase::Decided; }
+
+	// Average scene GPU time with and without the prepass from the last measurement, negative when unknown
+	float getAverageMs(bool prepass) const;
+
+	// Whether the prepass is used in the current frame
+	bool isActive() const { return active; }
+
+private:
+	enum class Phase
+	{
+		MeasureWithout,
+		MeasureWith,
+		Decided
+	};
+
+	void restart();
+
+	DepthPrepassMode mode = DepthPrepassMode::Off;
+	Phase phase = Phase::MeasureWithout;
+	uint64_t key = 0;
+	bool active = false;
+	bool preferPrepass = false;
+
+	int frames = 0;
+	int samples = 0;
+	float sum = 0.0f;
+	float averageMs[2] = { -1.0f, -1.0f }; // Without, with
+};
@@ -0,0 +1,130 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr float kSmoothing = 0.2f;
+
+	// A step up must be predicted to leave this much of the target unused, so the scale does not oscillate
+	constexpr float kRaiseHeadroom = 0.85f;
+
+	float quantize(float scale)
+	{
+		return std::round(scale / DynamicResolution::kScaleStep) * DynamicResolution::kScaleStep;
+	}
+} // namespace
+
+void DynamicResolution::reset()
+{
+	cooldown = 0;
+	samples = 0;
+	frameMs = -1.0f;
+	sceneMs = -1.0f;
+}
+
+void DynamicResolution::update(const Settings& settings, float gpuFrameMs, float sceneGpuMs)
+{
+	if (!settings.enabled)
+	{
+		scale = 1.0f;
+		state = State::Disabled;
+		reset();
+		return;
+	}
+
+	const float minScale = quantize(std::clamp(settings.minScale, kScaleStep, 1.0f));
+	const float maxScale = quantize(std::clamp(settings.maxScale, minScale, 1.0f));
+	if (scale < minScale || scale > maxScale)
+	{
+		scale = std::clamp(scale, minScale, maxScale);
+		state = State::Holding;
+		reset();
+		cooldown = kCooldownFrames;
+		return;
+	}
+
+	// Frames right after a change still report the old size
+	if (cooldown > 0)
+	{
+		--cooldown;
+		return;
+	}
+
+	if (gpuFrameMs <= 0.0f)
+		return;
+
+	const float sceneSample = std::clamp(sceneGpuMs, 0.0f, gpuFrameMs);
+	frameMs = frameMs < 0.0f ? gpuFrameMs : frameMs + (gpuFrameMs - frameMs) * kSmoothing;
+	sceneMs = sceneMs < 0.0f ? sceneSample : sceneMs + (sceneSample - sceneMs) * kSmoothing;
+	if (++samples < kMinSamples)
+		return;
+
+	// Time outside the scene views does not change with the scale, the scene time goes with pixel count
+	const float fixedMs = std::max(frameMs - sceneMs, 0.0f);
+	const float fullSceneMs = sceneMs / (scale * scale);
+
+	float next = scale;
+	if (frameMs > settings.targetMs)
+	{
+		// Largest step predicted to fit, and at least one step down
+		const float sceneBudget = settings.targetMs - fixedMs;
+		const float fit = sceneBudget > 0.0f && fullSceneMs > 0.0f ? std::sqrt(sceneBudget / fullSceneMs) : minScale;
+		next = std::floor(fit / kScaleStep + 1e-3f) * kScaleStep;
+		next = std::max(std::min(next, scale - kScaleStep), minScale);
+	}
+	else if (scale < maxScale)
+	{
+		const float up = std::min(scale + kScaleStep, maxScale);
+		if (fixedMs + fullSceneMs * up * up < settings.targetMs * kRaiseHeadroom)
+		{
+			next = up;
+		}
+	}
+	next = quantize(next);
+
+	if (next < scale)
+	{
+		state = State::Lowering;
+	}
+	else if (next > scale)
+	{
+		state = State::Raising;
+	}
+	else
+	{
+		state = frameMs > settings.targetMs && scale <= minScale ? State::Limited : State::Holding;
+	}
+
+	if (next != scale)
+	{
+		scale = next;
+		reset();
+		cooldown = kCooldownFrames;
+	}
+}
+
+void DynamicResolution::getRenderSize(int width, int height, int& renderWidth, int& renderHeight) const
+{
+	renderWidth = std::max(static_cast<int>(width * scale + 0.5f), 1);
+	renderHeight = std::max(static_cast<int>(height * scale + 0.5f), 1);
+}
+
+const char* DynamicResolution::getStateName(State state)
+{
+	switch (state)
+	{
+	case State::Disabled:
+		return "Disabled";
+	case State::Holding:
+		return "Holding";
+	case State::Lowering:
+		return "Lowering";
+	case State::Raising:
+		return "Raising";
+	case State::Limited:
+		return "At minimum scale";
+	}
+	return "";
+}
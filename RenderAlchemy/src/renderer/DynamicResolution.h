@@ -0,0 +1,60 @@
+#pragma once
+
+// Picks the resolution scale of the HDR scene target so the GPU frame stays within a target time.
+// Only the scene pass is scaled; the tonemap pass upscales the result to the window and everything after it,
+// the CLUT and the UI included, stays at native resolution. The scene share of the frame is assumed to scale
+// with pixel count, so the scale needed to fit the budget follows from the timings of one frame.
+// Scales are quantised and held for a few frames after each change, as the target is reallocated at the
+// new size and GPU timings arrive a few frames late.
+class DynamicResolution
+{
+public:
+	static constexpr float kScaleStep = 0.05f;
+	static constexpr int kCooldownFrames = 8;
+	static constexpr int kMinSamples = 4;
+
+	struct Settings
+	{
+		bool enabled = false;
+		float targetMs = 16.6f; // GPU frame time to hold
+		float minScale = 0.5f;  // Per axis
+		float maxScale = 1.0f;
+		float sharpness = 0.25f; // Sharpening applied by the upscale, 0 to disable
+	};
+
+	enum class State
+	{
+		Disabled,
+		Holding,  // Within budget, or waiting for timings of the last change
+		Lowering, // Over budget
+		Raising,  // Enough headroom for a step up
+		Limited   // Over budget at the minimum scale
+	};
+
+	// Feed the GPU time of a frame that rendered the scene, in total and for the scene views alone
+	void update(const Settings& settings, float gpuFrameMs, float sceneGpuMs);
+
+	// Forget the timings, e.g. after the scene changed completely
+	void reset();
+
+	float getScale() const { return scale; }
+
+	// Size of the scene target for a window of width by height pixels
+	void getRenderSize(int width, int height, int& renderWidth, int& renderHeight) const;
+
+	State getState() const { return state; }
+	static const char* getStateName(State state);
+
+	// Smoothed timings the controller acts on
+	float getFrameMs() const { return frameMs; }
+	float getSceneMs() const { return sceneMs; }
+
+private:
+	float scale = 1.0f;
+	State state = State::Disabled;
+	int cooldown = 0;
+	int samples = 0;
+
+	float frameMs = -1.0f; // Negative until the first sample
+	float sceneMs = -1.0f;
+};
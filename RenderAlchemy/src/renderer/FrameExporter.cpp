@@ -0,0 +1,295 @@
+#include "FrameExporter.h"
+
+#include <bimg/bimg.h>
+#include <bx/allocator.h>
+#include <bx/file.h>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+FrameExporter::~FrameExporter()
+{
+	destroy();
+}
+
+bool FrameExporter::isSupported()
+{
+	const bgfx::Caps* caps = bgfx::getCaps();
+	const uint64_t required = BGFX_CAPS_TEXTURE_BLIT | BGFX_CAPS_TEXTURE_READ_BACK;
+	return caps != nullptr && (caps->supported & required) == required;
+}
+
+bool FrameExporter::start(const Settings& newSettings)
+{
+	// Frames of the last sequence still on their way to disk keep the settings they were captured with,
+	// but a new sequence numbered from 0 would race them for the same names
+	if (isBusy())
+	{
+		std::cerr << "Frame export is still writing the last sequence" << std::endl;
+		return false;
+	}
+
+	if (!isSupported())
+	{
+		std::cerr << "Frame export requires texture blit and read back support" << std::endl;
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(newSettings.directory, error);
+	if (error)
+	{
+		std::cerr << "Failed to create export directory " << newSettings.directory << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	settings = newSettings;
+	recording = true;
+	captured = 0;
+	dropped = 0;
+	written = 0;
+	failed = 0;
+
+	if (!encoder.joinable())
+	{
+		quit = false;
+		encoder = std::thread(&FrameExporter::encodeLoop, this);
+	}
+	return true;
+}
+
+bool FrameExporter::isBusy() const
+{
+	if (recording || getPendingCount() > 0)
+		return true;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return !jobs.empty() || encoding > 0;
+}
+
+int FrameExporter::getPendingCount() const
+{
+	int pending = 0;
+	for (const Slot& slot : ring)
+	{
+		pending += slot.pending ? 1 : 0;
+	}
+	return pending;
+}
+
+void FrameExporter::createRing(int width, int height, bgfx::TextureFormat::Enum format)
+{
+	destroyRing();
+
+	bgfx::TextureInfo info;
+	bgfx::calcTextureSize(info, uint16_t(width), uint16_t(height), 1, false, false, 1, format);
+
+	ringWidth = width;
+	ringHeight = height;
+	ringFormat = format;
+	ringBytes = info.storageSize;
+	for (Slot& slot : ring)
+	{
+		slot.texture = bgfx::createTexture2D(uint16_t(width), uint16_t(height), false, 1, format, BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK | BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP);
+		slot.pixels.resize(ringBytes);
+	}
+
+	// Buffers of the old size are no use any more
+	std::lock_guard<std::mutex> lock(mutex);
+	spareBuffers.clear();
+}
+
+void FrameExporter::destroyRing()
+{
+	for (Slot& slot : ring)
+	{
+		if (bgfx::isValid(slot.texture))
+		{
+			bgfx::destroy(slot.texture);
+			slot.texture = BGFX_INVALID_HANDLE;
+		}
+		slot.pending = false;
+	}
+	nextSlot = 0;
+	ringWidth = 0;
+	ringHeight = 0;
+	ringFormat = bgfx::TextureFormat::Unknown;
+}
+
+void FrameExporter::capture(bgfx::ViewId view, bgfx::TextureHandle source, int width, int height, bgfx::TextureFormat::Enum format)
+{
+	if (!recording || !bgfx::isValid(source) || width <= 0 || height <= 0)
+		return;
+
+	// A new source size needs a new ring, which can only replace the old one once its read backs have landed
+	if (width != ringWidth || height != ringHeight || format != ringFormat)
+	{
+		if (getPendingCount() > 0)
+		{
+			++dropped;
+			return;
+		}
+		createRing(width, height, format);
+	}
+
+	Slot& slot = ring[nextSlot];
+	int queued = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued = static_cast<int>(jobs.size()) + encoding;
+	}
+
+	// Waiting here would stall the frame, dropping keeps the interactive rate and the memory bounded
+	if (slot.pending || queued + getPendingCount() >= kMaxQueuedFrames)
+	{
+		++dropped;
+		return;
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "%s_%05u.%s", settings.prefix.c_str(), captured, settings.source == Source::SceneHdr ? "exr" : "png");
+
+	// Read backs start at the bottom row on bottom-left origin backends. The graded image is also stored
+	// upside down on top-left ones, since the tone mapping quad maps the top of clip space to v = 1, so it
+	// always needs the flip.
+	const bgfx::Caps* caps = bgfx::getCaps();
+	bgfx::blit(view, slot.texture, 0, 0, source, 0, 0, uint16_t(width), uint16_t(height));
+	slot.readyFrame = bgfx::readTexture(slot.texture, slot.pixels.data());
+	slot.path = (std::filesystem::path(settings.directory) / name).string();
+	slot.format = format;
+	slot.yflip = settings.source == Source::Graded || (caps != nullptr && caps->originBottomLeft);
+	slot.pending = true;
+	++captured;
+	nextSlot = (nextSlot + 1) % kRingSize;
+
+	if (settings.frameCount > 0 && captured >= static_cast<uint32_t>(settings.frameCount))
+	{
+		recording = false;
+	}
+}
+
+void FrameExporter::update(uint32_t frame)
+{
+	for (Slot& slot : ring)
+	{
+		// Frame numbers wrap, compare the distance instead of the values
+		if (!slot.pending || int32_t(frame - slot.readyFrame) < 0)
+			continue;
+
+		// The ring is only recreated once no read back is pending, so its size is still the captured one
+		Job job;
+		job.path = std::move(slot.path);
+		job.width = ringWidth;
+		job.height = ringHeight;
+		job.format = slot.format;
+		job.yflip = slot.yflip;
+		job.pixels = std::move(slot.pixels);
+		slot.pending = false;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!spareBuffers.empty())
+		{
+			slot.pixels = std::move(spareBuffers.back());
+			spareBuffers.pop_back();
+		}
+		slot.pixels.resize(ringBytes);
+		jobs.push_back(std::move(job));
+		wake.notify_one();
+	}
+}
+
+void FrameExporter::destroy()
+{
+	recording = false;
+	destroyRing();
+
+	if (encoder.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_one();
+		encoder.join();
+	}
+}
+
+FrameExporter::Stats FrameExporter::getStats() const
+{
+	Stats stats;
+	stats.captured = captured;
+	stats.written = written.load();
+	stats.dropped = dropped;
+	stats.failed = failed.load();
+	stats.inFlight = getPendingCount();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.queued = static_cast<int>(jobs.size()) + encoding;
+	return stats;
+}
+
+void FrameExporter::encodeLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		wake.wait(lock, [this] { return quit || !jobs.empty(); });
+		if (jobs.empty())
+			break;
+
+		Job job = std::move(jobs.front());
+		jobs.pop_front();
+		++encoding;
+		lock.unlock();
+
+		if (encode(job))
+		{
+			++written;
+		}
+		else
+		{
+			std::cerr << "Failed to write " << job.path << std::endl;
+			++failed;
+		}
+
+		lock.lock();
+		--encoding;
+		spareBuffers.push_back(std::move(job.pixels));
+	}
+}
+
+bool FrameExporter::encode(const Job& job)
+{
+	bx::FileWriter writer;
+	bx::Error error;
+	if (!bx::open(&writer, job.path.c_str(), false, &error))
+		return false;
+
+	if (job.format == bgfx::TextureFormat::RGBA8)
+	{
+		bimg::imageWritePng(&writer, job.width, job.height, job.width * 4, job.pixels.data(), bimg::TextureFormat::RGBA8, job.yflip, &error);
+	}
+	else if (job.format == bgfx::TextureFormat::RGBA16F)
+	{
+		bimg::imageWriteExr(&writer, job.width, job.height, job.width * 8, job.pixels.data(), bimg::TextureFormat::RGBA16F, job.yflip, &error);
+	}
+	else
+	{
+		// EXR takes half floats; a compact HDR target is widened first
+		bx::DefaultAllocator allocator;
+		std::vector<uint8_t> half(size_t(job.width) * job.height * 8);
+		if (bimg::imageConvert(&allocator, half.data(), bimg::TextureFormat::RGBA16F, job.pixels.data(), bimg::TextureFormat::Enum(job.format), job.width, job.height, 1))
+		{
+			bimg::imageWriteExr(&writer, job.width, job.height, job.width * 8, half.data(), bimg::TextureFormat::RGBA16F, job.yflip, &error);
+		}
+		else
+		{
+			bx::close(&writer);
+			return false;
+		}
+	}
+
+	bx::close(&writer);
+	return error.isOk();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Exports rendered frames as an image sequence without stalling the renderer.
+// Each captured frame is blitted into the next texture of a small ring of read back textures and read
+// asynchronously; bgfx reports the frame in which the copy lands, and only then is the pixel buffer handed to
+// an encoder thread that writes a PNG for the graded image or an EXR for the scene HDR target. The encoder
+// is a thread of its own rather than a job, so a long encode never lands on the main thread while it helps
+// out with jobs. Memory stays bounded: the ring and the encoder queue have fixed sizes, and a frame that
+// finds them full is dropped and counted instead of waiting.
+class FrameExporter
+{
+public:
+	static constexpr int kRingSize = 3;
+	static constexpr int kMaxQueuedFrames = 6;
+
+	enum class Source
+	{
+		Graded,  // LDR target after tone mapping and grading, written as PNG
+		SceneHdr // HDR scene target, written as half float EXR
+	};
+
+	struct Settings
+	{
+		std::string directory = "export";
+		std::string prefix = "frame";
+		Source source = Source::Graded;
+		int frameCount = 120; // 0 records until stopped
+	};
+
+	struct Stats
+	{
+		uint32_t captured = 0; // Frames copied on the GPU
+		uint32_t written = 0;  // Files written
+		uint32_t dropped = 0;  // Frames skipped because the ring or the queue was full
+		uint32_t failed = 0;   // Files that could not be written
+		int inFlight = 0;      // Read backs not yet landed
+		int queued = 0;        // Frames waiting for or being encoded
+	};
+
+	FrameExporter() = default;
+	~FrameExporter();
+
+	// True when the renderer can blit into and read back textures
+	static bool isSupported();
+
+	// Begin a new sequence numbered from 0; returns false while busy, when unsupported or when the directory
+	// cannot be created
+	bool start(const Settings& newSettings);
+
+	// Stop capturing; frames already captured are still written
+	void stop() { recording = false; }
+
+	bool isRecording() const { return recording; }
+
+	// Recording, or frames of the last sequence still on their way to disk
+	bool isBusy() const;
+
+	// Copy source, width by height pixels in format, in view; call after the source was rendered this frame
+	void capture(bgfx::ViewId view, bgfx::TextureHandle source, int width, int height, bgfx::TextureFormat::Enum format);
+
+	// Hand landed read backs to the encoder; frame is the number bgfx::frame() returned
+	void update(uint32_t frame);
+
+	// Release the ring and finish writing the queued frames
+	void destroy();
+
+	const Settings& getSettings() const { return settings; }
+	Stats getStats() const;
+
+private:
+	// Everything the file needs is taken at capture, so settings changed afterwards never rename a frame
+	struct Slot
+	{
+		bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+		std::vector<uint8_t> pixels;
+		uint32_t readyFrame = 0;
+		std::string path;
+		bgfx::TextureFormat::Enum format = bgfx::TextureFormat::RGBA8;
+		bool yflip = false;
+		bool pending = false;
+	};
+
+	struct Job
+	{
+		std::vector<uint8_t> pixels;
+		std::string path;
+		int width = 0;
+		int height = 0;
+		bgfx::TextureFormat::Enum format = bgfx::TextureFormat::RGBA8;
+		bool yflip = false;
+	};
+
+	void createRing(int width, int height, bgfx::TextureFormat::Enum format);
+	void destroyRing();
+	int getPendingCount() const;
+	void encodeLoop();
+	static bool encode(const Job& job);
+
+	Settings settings;
+	bool recording = false;
+
+	// Read back ring, sized for the source of the current sequence
+	Slot ring[kRingSize];
+	int nextSlot = 0;
+	int ringWidth = 0;
+	int ringHeight = 0;
+	bgfx::TextureFormat::Enum ringFormat = bgfx::TextureFormat::Unknown;
+	uint32_t ringBytes = 0;
+
+	uint32_t captured = 0;
+	uint32_t dropped = 0;
+	std::atomic<uint32_t> written{ 0 };
+	std::atomic<uint32_t> failed{ 0 };
+
+	// Encoder thread and its queue; buffers come back to spareBuffers once written
+	std::thread encoder;
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Job> jobs;
+	std::vector<std::vector<uint8_t>> spareBuffers;
+	int encoding = 0;
+	bool quit = false;
+};
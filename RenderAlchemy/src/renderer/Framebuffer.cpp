@@ -5,16 +5,13 @@
 
 #include "BgfxUtils.h"
 
-uint8_t Framebuffer::nextViewId = 1; // View 0 is reserved for main view
-
 Framebuffer::Framebuffer()
     : framebufferHandle(BGFX_INVALID_HANDLE),
       colorTexture(BGFX_INVALID_HANDLE),
       depthTexture(BGFX_INVALID_HANDLE),
       width(0),
       height(0),
-      useHDR(true),
-      viewId(0)
+      colorFormat(bgfx::TextureFormat::RGBA16F)
 {
 }
 
@@ -37,20 +34,17 @@ void Framebuffer::cleanup()
 }
 
 void Framebuffer::create(int width, int height, bool useHDR)
+{
+    create(width, height, useHDR ? bgfx::TextureFormat::RGBA16F : bgfx::TextureFormat::RGBA8);
+}
+
+void Framebuffer::create(int width, int height, bgfx::TextureFormat::Enum colorFormat)
 {
     cleanup();
 
     this->width = width;
     this->height = height;
-    this->useHDR = useHDR;
-    
-    // Assign a unique view ID for this framebuffer
-    this->viewId = nextViewId++;
-    
-    // Set up texture formats
-    bgfx::TextureFormat::Enum colorFormat = useHDR 
-        ? bgfx::TextureFormat::RGBA16F 
-        : bgfx::TextureFormat::RGBA8;
+    this->colorFormat = colorFormat;
     
     // Create textures with proper flags
     uint64_t textureFlags = BGFX_TEXTURE_RT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP;
@@ -86,29 +80,27 @@ void Framebuffer::create(int width, int height, bool useHDR)
     if (!bgfx::isValid(framebufferHandle)) {
         std::cerr << "ERROR: Failed to create framebuffer!" << std::endl;
     }
-    
-    // Set up the view for this framebuffer
-    bgfx::setViewFrameBuffer(viewId, framebufferHandle);
-    bgfx::setViewRect(viewId, 0, 0, uint16_t(width), uint16_t(height));
-    bgfx::setViewClear(viewId, 
-                      BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 
-                      0x303030ff, // Dark gray
-                      1.0f,
-                      0);
 }
 
 void Framebuffer::resize(int width, int height)
 {
-    create(width, height, useHDR); // Recreate with new dimensions
+    create(width, height, colorFormat); // Recreate with new dimensions
+}
+
+uint32_t Framebuffer::getColorMemory() const
+{
+    bgfx::TextureInfo info;
+    bgfx::calcTextureSize(info, uint16_t(width), uint16_t(height), 1, false, false, 1, colorFormat);
+    return info.storageSize;
 }
 
-void Framebuffer::bind() const
+void Framebuffer::bind(bgfx::ViewId view) const
 {
     // In bgfx, we don't directly bind framebuffers like in OpenGL.
-    // Instead, we set the current view ID and the framebuffer is associated with that view.
-    bgfx::setViewFrameBuffer(viewId, framebufferHandle);
-    bgfx::setViewRect(viewId, 0, 0, uint16_t(width), uint16_t(height));
-    bgfx::touch(viewId); // Make sure the view is processed this frame
+    // Instead, the framebuffer is associated with the view that renders into it.
+    bgfx::setViewFrameBuffer(view, framebufferHandle);
+    bgfx::setViewRect(view, 0, 0, uint16_t(width), uint16_t(height));
+    bgfx::touch(view); // Make sure the view is processed this frame
 }
 
 void Framebuffer::unbind() const
@@ -7,14 +7,17 @@ public:
     Framebuffer();
     ~Framebuffer();
 
-    // Create framebuffer with specified dimensions
+    // Create framebuffer with specified dimensions, RGBA16F colour for HDR and RGBA8 otherwise
     void create(int width, int height, bool useHDR);
+
+    // Create framebuffer with an explicit colour format
+    void create(int width, int height, bgfx::TextureFormat::Enum colorFormat);
     
     // Resize framebuffer
     void resize(int width, int height);
     
-    // Bind framebuffer for rendering
-    void bind() const;
+    // Render a view into this framebuffer; call every frame the view is used, views keep it until rebound
+    void bind(bgfx::ViewId view) const;
     
     // Unbind framebuffer (return to default)
     void unbind() const;
@@ -24,6 +27,9 @@ public:
     
     // Get color texture handle
     bgfx::TextureHandle getColorTexture() const { return colorTexture; }
+
+    // Get depth texture handle
+    bgfx::TextureHandle getDepthTexture() const { return depthTexture; }
     
     // Get framebuffer handle
     bgfx::FrameBufferHandle getHandle() const { return framebufferHandle; }
@@ -32,14 +38,15 @@ public:
     int getWidth() const { return width; }
     int getHeight() const { return height; }
 
+    // Get colour format and the memory used by the colour attachment
+    bgfx::TextureFormat::Enum getColorFormat() const { return colorFormat; }
+    uint32_t getColorMemory() const;
+
 private:
     bgfx::FrameBufferHandle framebufferHandle;
     bgfx::TextureHandle colorTexture;
     bgfx::TextureHandle depthTexture;
     int width;
     int height;
-    bool useHDR;
-    uint8_t viewId;
-
-    static uint8_t nextViewId;
+    bgfx::TextureFormat::Enum colorFormat;
 };
@@ -0,0 +1,239 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX__)
+#	include <immintrin.h>
+#	define RA_CULL_AVX 1
+#	define RA_CULL_SSE 0
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#	include <emmintrin.h>
+#	define RA_CULL_AVX 0
+#	define RA_CULL_SSE 1
+#else
+#	define RA_CULL_AVX 0
+#	define RA_CULL_SSE 0
+#endif
+
+namespace
+{
+	// Spheres are processed in batches of this size; arrays are padded to a multiple of it
+	constexpr uint32_t kBatchSize = 8;
+
+	void normalizePlane(float* plane)
+	{
+		const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length > 0.0f)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				plane[i] /= length;
+			}
+		}
+	}
+
+	// Append the set bits of a batch mask as indices
+	inline void appendVisible(uint32_t mask, uint32_t base, uint32_t* out, uint32_t& written)
+	{
+		while (mask != 0)
+		{
+			uint32_t bit = 0;
+			while ((mask & (1u << bit)) == 0)
+			{
+				++bit;
+			}
+			out[written++] = base + bit;
+			mask &= mask - 1;
+		}
+	}
+} // namespace
+
+Frustum Frustum::fromMatrices(const float* view, const float* proj)
+{
+	float viewProj[16];
+	for (int col = 0; col < 4; ++col)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; ++k)
+			{
+				sum += proj[k * 4 + row] * view[col * 4 + k];
+			}
+			viewProj[col * 4 + row] = sum;
+		}
+	}
+
+	return fromViewProj(viewProj);
+}
+
+Frustum Frustum::fromViewProj(const float* m)
+{
+	// Rows of the column-major matrix
+	float rows[4][4];
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int col = 0; col < 4; ++col)
+		{
+			rows[row][col] = m[col * 4 + row];
+		}
+	}
+
+	// Left, right, bottom, top, near, far. The near plane assumes a [-1, 1] depth range,
+	// which is conservative for APIs with a [0, 1] range.
+	Frustum frustum;
+	for (int i = 0; i < 4; ++i)
+	{
+		frustum.planes[0][i] = rows[3][i] + rows[0][i];
+		frustum.planes[1][i] = rows[3][i] - rows[0][i];
+		frustum.planes[2][i] = rows[3][i] + rows[1][i];
+		frustum.planes[3][i] = rows[3][i] - rows[1][i];
+		frustum.planes[4][i] = rows[3][i] + rows[2][i];
+		frustum.planes[5][i] = rows[3][i] - rows[2][i];
+	}
+
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		normalizePlane(frustum.planes[plane]);
+	}
+
+	return frustum;
+}
+
+Frustum Frustum::transformed(const float* model) const
+{
+	// A plane p transforms into object space as transpose(M) * p. The normals are left
+	// unnormalised so distances stay in world units and can be compared with scaled radii.
+	Frustum result;
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int col = 0; col < 4; ++col)
+		{
+			result.planes[plane][col] = model[col * 4 + 0] * planes[plane][0] + model[col * 4 + 1] * planes[plane][1] + model[col * 4 + 2] * planes[plane][2] + model[col * 4 + 3] * planes[plane][3];
+		}
+	}
+
+	return result;
+}
+
+void FrustumCuller::clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+	count = 0;
+}
+
+uint32_t FrustumCuller::add(const float* center, float sphereRadius)
+{
+	const uint32_t index = count++;
+	pad();
+	set(index, center, sphereRadius);
+	return index;
+}
+
+void FrustumCuller::set(uint32_t index, const float* center, float sphereRadius)
+{
+	centerX[index] = center[0];
+	centerY[index] = center[1];
+	centerZ[index] = center[2];
+	radius[index] = sphereRadius;
+}
+
+void FrustumCuller::pad()
+{
+	const size_t padded = (count + kBatchSize - 1) / kBatchSize * kBatchSize;
+	if (padded == radius.size())
+	{
+		return;
+	}
+
+	// Padding spheres have an infinitely negative radius and are rejected by every plane
+	centerX.resize(padded, 0.0f);
+	centerY.resize(padded, 0.0f);
+	centerZ.resize(padded, 0.0f);
+	radius.resize(padded, -FLT_MAX);
+}
+
+uint32_t FrustumCuller::cull(const Frustum& frustum, const float* model, std::vector<uint32_t>& visible) const
+{
+	const Frustum local = frustum.transformed(model);
+
+	// Radii are in object space, scale them by the largest axis of the model matrix
+	float scale = 0.0f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const float* column = &model[axis * 4];
+		scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+	}
+
+	const uint32_t padded = static_cast<uint32_t>(radius.size());
+	visible.resize(padded);
+	uint32_t* out = visible.data();
+	uint32_t written = 0;
+
+#if RA_CULL_AVX
+	const __m256 scaleV = _mm256_set1_ps(-scale);
+	for (uint32_t base = 0; base < padded; base += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(&centerX[base]);
+		const __m256 y = _mm256_loadu_ps(&centerY[base]);
+		const __m256 z = _mm256_loadu_ps(&centerZ[base]);
+		const __m256 negR = _mm256_mul_ps(_mm256_loadu_ps(&radius[base]), scaleV);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			const float* p = local.planes[plane];
+			__m256 dist = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(p[0])), _mm256_set1_ps(p[3]));
+			dist = _mm256_add_ps(dist, _mm256_mul_ps(y, _mm256_set1_ps(p[1])));
+			dist = _mm256_add_ps(dist, _mm256_mul_ps(z, _mm256_set1_ps(p[2])));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, negR, _CMP_GT_OQ));
+		}
+
+		appendVisible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), base, out, written);
+	}
+#elif RA_CULL_SSE
+	const __m128 scaleV = _mm_set1_ps(-scale);
+	for (uint32_t base = 0; base < padded; base += 4)
+	{
+		const __m128 x = _mm_loadu_ps(&centerX[base]);
+		const __m128 y = _mm_loadu_ps(&centerY[base]);
+		const __m128 z = _mm_loadu_ps(&centerZ[base]);
+		const __m128 negR = _mm_mul_ps(_mm_loadu_ps(&radius[base]), scaleV);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			const float* p = local.planes[plane];
+			__m128 dist = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(p[0])), _mm_set1_ps(p[3]));
+			dist = _mm_add_ps(dist, _mm_mul_ps(y, _mm_set1_ps(p[1])));
+			dist = _mm_add_ps(dist, _mm_mul_ps(z, _mm_set1_ps(p[2])));
+			inside = _mm_and_ps(inside, _mm_cmpgt_ps(dist, negR));
+		}
+
+		appendVisible(static_cast<uint32_t>(_mm_movemask_ps(inside)), base, out, written);
+	}
+#else
+	for (uint32_t i = 0; i < padded; ++i)
+	{
+		bool inside = true;
+		for (int plane = 0; plane < 6 && inside; ++plane)
+		{
+			const float* p = local.planes[plane];
+			inside = p[0] * centerX[i] + p[1] * centerY[i] + p[2] * centerZ[i] + p[3] > -radius[i] * scale;
+		}
+
+		if (inside)
+		{
+			out[written++] = i;
+		}
+	}
+#endif
+
+	visible.resize(written);
+	return written;
+}
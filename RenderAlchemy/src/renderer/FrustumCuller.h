@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// View frustum as six planes (xyz = normal pointing inwards, w = distance)
+struct Frustum
+{
+	float planes[6][4];
+
+	// Extract planes from column-major view and projection matrices
+	static Frustum fromMatrices(const float* view, const float* proj);
+
+	// Extract planes from a combined column-major view-projection matrix
+	static Frustum fromViewProj(const float* viewProj);
+
+	// Move the planes into the object space of the given model matrix
+	Frustum transformed(const float* model) const;
+};
+
+// Tests bounding spheres against a frustum several at a time.
+// Bounds are stored as structure-of-arrays so SSE/AVX can load 4 or 8 of them per instruction.
+class FrustumCuller
+{
+public:
+	// Remove all bounds
+	void clear();
+
+	// Add a bounding sphere, returns its index
+	uint32_t add(const float* center, float radius);
+
+	// Update a bounding sphere that was added before
+	void set(uint32_t index, const float* center, float radius);
+
+	// Number of bounding spheres
+	uint32_t getCount() const { return count; }
+
+	// Test every sphere, transformed by the model matrix, against the frustum.
+	// Indices of the spheres that survive are written to visible in ascending order; returns their number.
+	uint32_t cull(const Frustum& frustum, const float* model, std::vector<uint32_t>& visible) const;
+
+private:
+	// Keep the arrays padded to a full AVX batch with spheres that never pass
+	void pad();
+
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+	uint32_t count = 0;
+};
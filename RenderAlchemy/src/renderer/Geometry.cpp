@@ -1,9 +1,13 @@
 #include "Geometry.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <bgfx/bgfx.h>
 #include "Shader.h"
+#include "../meshoptimizer/meshoptimizer.h"
 
 // Define vertex structure for bgfx
 struct PosColorNormal {
@@ -37,7 +41,9 @@ struct PosTexCoord {
 
 Geometry::Geometry()
     : vbo(BGFX_INVALID_HANDLE), ibo(BGFX_INVALID_HANDLE), 
-      vertexCount(0), indexCount(0), viewId(0)
+      vertexCount(0), indexCount(0), viewId(0),
+      depthVbo(BGFX_INVALID_HANDLE), depthIbo(BGFX_INVALID_HANDLE),
+      boundsCenter{ 0.0f, 0.0f, 0.0f }, boundsRadius(0.0f)
 {
 }
 
@@ -48,6 +54,16 @@ Geometry::~Geometry()
 
 void Geometry::cleanup()
 {
+    // Wait for any LOD build still running as a job
+    if (pendingLods.valid()) {
+        pendingLods.wait();
+        pendingLods = JobFuture<LodChain>();
+    }
+    lods.clear();
+
+    meshlets = MeshletSet();
+    visibleMeshlets.clear();
+
     if (bgfx::isValid(vbo)) {
         bgfx::destroy(vbo);
         vbo = BGFX_INVALID_HANDLE;
@@ -57,6 +73,32 @@ void Geometry::cleanup()
         bgfx::destroy(ibo);
         ibo = BGFX_INVALID_HANDLE;
     }
+
+    if (bgfx::isValid(depthVbo)) {
+        bgfx::destroy(depthVbo);
+        depthVbo = BGFX_INVALID_HANDLE;
+    }
+
+    if (bgfx::isValid(depthIbo)) {
+        bgfx::destroy(depthIbo);
+        depthIbo = BGFX_INVALID_HANDLE;
+    }
+}
+
+void Geometry::createDepthIndexBuffer(const std::vector<uint32_t>& indices)
+{
+    if (bgfx::isValid(depthIbo)) {
+        bgfx::destroy(depthIbo);
+        depthIbo = BGFX_INVALID_HANDLE;
+    }
+
+    // Vertices split only for normals or colors map to one index, so the depth pass transforms each position once
+    std::vector<uint32_t> shadowIndices(indices.size());
+    meshopt_generateShadowIndexBuffer(shadowIndices.data(), indices.data(), indices.size(), positions.data(),
+                                      positions.size() / 3, sizeof(float) * 3, sizeof(float) * 3);
+
+    std::vector<uint16_t> shortIndices(shadowIndices.begin(), shadowIndices.end());
+    depthIbo = bgfx::createIndexBuffer(bgfx::copy(shortIndices.data(), sizeof(uint16_t) * shortIndices.size()));
 }
 
 template<typename T>
@@ -73,6 +115,138 @@ void Geometry::createGeometry(const std::vector<T>& vertices, const std::vector<
     const bgfx::Memory* indexMemory = bgfx::copy(indices.data(), sizeof(uint16_t) * indices.size());
     ibo = bgfx::createIndexBuffer(indexMemory);
     indexCount = static_cast<uint32_t>(indices.size());
+
+    // Keep positions, normals and indices around for LOD generation
+    positions.resize(vertices.size() * 3);
+    normals.resize(vertices.size() * 3);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        positions[i * 3 + 0] = vertices[i].x;
+        positions[i * 3 + 1] = vertices[i].y;
+        positions[i * 3 + 2] = vertices[i].z;
+        normals[i * 3 + 0] = vertices[i].nx;
+        normals[i * 3 + 1] = vertices[i].ny;
+        normals[i * 3 + 2] = vertices[i].nz;
+    }
+    sourceIndices.assign(indices.begin(), indices.end());
+
+    // Depth prepass stream: a third of the vertex size and a deduplicated index buffer
+    bgfx::VertexLayout depthLayout;
+    depthLayout.begin().add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float).end();
+    depthVbo = bgfx::createVertexBuffer(bgfx::copy(positions.data(), sizeof(float) * positions.size()), depthLayout);
+    createDepthIndexBuffer(sourceIndices);
+
+    // Bounding sphere around the centre of the bounding box
+    float minPos[3] = { positions[0], positions[1], positions[2] };
+    float maxPos[3] = { positions[0], positions[1], positions[2] };
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            minPos[axis] = std::min(minPos[axis], positions[i * 3 + axis]);
+            maxPos[axis] = std::max(maxPos[axis], positions[i * 3 + axis]);
+        }
+    }
+
+    boundsRadius = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        boundsCenter[axis] = (minPos[axis] + maxPos[axis]) * 0.5f;
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const float dx = positions[i * 3 + 0] - boundsCenter[0];
+        const float dy = positions[i * 3 + 1] - boundsCenter[1];
+        const float dz = positions[i * 3 + 2] - boundsCenter[2];
+        boundsRadius = std::max(boundsRadius, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+
+    // Split into meshlets up front so the meshlet path can cull clusters every frame
+    meshlets = Meshlets::build(sourceIndices, positions.data(), vertices.size(), sizeof(float) * 3);
+}
+
+void Geometry::buildLods()
+{
+    if (sourceIndices.empty() || pendingLods.valid())
+        return;
+
+    pendingLods = MeshLod::buildChainAsync(sourceIndices, positions, normals, 3);
+}
+
+bool Geometry::updateLods()
+{
+    if (!pendingLods.valid())
+        return false;
+
+    if (!pendingLods.isReady())
+        return false;
+
+    LodChain chain = pendingLods.get();
+    if (chain.levels.size() <= 1)
+        return false;
+
+    // Replace the index buffer with one holding every level; level 0 stays at the front
+    std::vector<uint16_t> indices(chain.indices.begin(), chain.indices.end());
+    const bgfx::Memory* indexMemory = bgfx::copy(indices.data(), sizeof(uint16_t) * indices.size());
+
+    if (bgfx::isValid(ibo)) {
+        bgfx::destroy(ibo);
+    }
+    ibo = bgfx::createIndexBuffer(indexMemory);
+    lods = chain.levels;
+
+    // Keep the depth prepass ranges identical to the colour pass so EQUAL depth tests match
+    createDepthIndexBuffer(chain.indices);
+
+    return true;
+}
+
+int Geometry::selectLod(const float* model, const LodSelection& selection) const
+{
+    return MeshLod::selectLevel(lods, boundsCenter, boundsRadius, model, selection);
+}
+
+uint32_t Geometry::getTriangleCount(int lod) const
+{
+    if (lods.empty())
+        return indexCount / 3;
+
+    lod = std::clamp(lod, 0, static_cast<int>(lods.size()) - 1);
+    return lods[lod].indexCount / 3;
+}
+
+uint32_t Geometry::drawMeshlets(bgfx::ProgramHandle program, uint64_t state, const float* model, const Frustum& frustum, const float* eye)
+{
+    visibleMeshlets.clear();
+
+    if (!bgfx::isValid(vbo) || meshlets.meshlets.empty())
+        return 0;
+
+    const uint32_t triangles = Meshlets::cull(meshlets, frustum, model, eye, visibleMeshlets);
+    if (triangles == 0)
+        return 0;
+
+    // Fall back to the full mesh when the transient pool is exhausted
+    const uint32_t visibleIndices = triangles * 3;
+    if (bgfx::getAvailTransientIndexBuffer(visibleIndices) < visibleIndices) {
+        draw(program, state, 0);
+        return indexCount / 3;
+    }
+
+    bgfx::TransientIndexBuffer tib;
+    bgfx::allocTransientIndexBuffer(&tib, visibleIndices);
+
+    // Pack the surviving clusters back to back so they go out in a single draw
+    uint16_t* out = reinterpret_cast<uint16_t*>(tib.data);
+    for (uint32_t index : visibleMeshlets) {
+        const Meshlet& meshlet = meshlets.meshlets[index];
+        const uint32_t* source = &meshlets.indices[meshlet.indexStart];
+        for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+            *out++ = static_cast<uint16_t>(source[i]);
+        }
+    }
+
+    bgfx::setState(state);
+    bgfx::setVertexBuffer(0, vbo);
+    bgfx::setIndexBuffer(&tib);
+    bgfx::submit(viewId, program);
+
+    return triangles;
 }
 
 void Geometry::createCube()
@@ -255,12 +429,114 @@ void Geometry::draw(const Shader& shader) const
 }
 
 void Geometry::draw(bgfx::ProgramHandle program, uint64_t state) const
+{
+    draw(program, state, 0);
+}
+
+void Geometry::draw(bgfx::ProgramHandle program, uint64_t state, int lod) const
 {
     if (!bgfx::isValid(vbo) || !bgfx::isValid(ibo))
         return;
-        
+
+    bgfx::setState(state);
+    bgfx::setVertexBuffer(0, vbo);
+    setIndexRange(ibo, lod);
+    bgfx::submit(viewId, program);
+}
+
+void Geometry::drawInView(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state) const
+{
+    if (!bgfx::isValid(vbo) || !bgfx::isValid(ibo))
+        return;
+
     bgfx::setState(state);
     bgfx::setVertexBuffer(0, vbo);
     bgfx::setIndexBuffer(ibo);
+    bgfx::submit(view, program);
+}
+
+void Geometry::draw(bgfx::Encoder* encoder, bgfx::ProgramHandle program, uint64_t state, int lod, uint32_t depth) const
+{
+    if (!bgfx::isValid(vbo) || !bgfx::isValid(ibo))
+        return;
+
+    encoder->setState(state);
+    encoder->setVertexBuffer(0, vbo);
+
+    if (lods.empty()) {
+        encoder->setIndexBuffer(ibo);
+    } else {
+        const LodLevel& level = lods[std::clamp(lod, 0, static_cast<int>(lods.size()) - 1)];
+        encoder->setIndexBuffer(ibo, level.indexStart, level.indexCount);
+    }
+
+    encoder->submit(viewId, program, depth);
+}
+
+void Geometry::setIndexRange(bgfx::IndexBufferHandle buffer, int lod) const
+{
+    // Every level lives in the same index buffer, only the range differs
+    if (lods.empty()) {
+        bgfx::setIndexBuffer(buffer);
+    } else {
+        const LodLevel& level = lods[std::clamp(lod, 0, static_cast<int>(lods.size()) - 1)];
+        bgfx::setIndexBuffer(buffer, level.indexStart, level.indexCount);
+    }
+}
+
+void Geometry::drawDepth(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state, int lod) const
+{
+    if (!bgfx::isValid(depthVbo) || !bgfx::isValid(depthIbo))
+        return;
+
+    bgfx::setState(state);
+    bgfx::setVertexBuffer(0, depthVbo);
+    setIndexRange(depthIbo, lod);
+    bgfx::submit(view, program);
+}
+
+uint32_t Geometry::drawDepthInstanced(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state, const InstanceData* instances, uint32_t count, int lod) const
+{
+    if (!bgfx::isValid(depthVbo) || !bgfx::isValid(depthIbo) || count == 0)
+        return 0;
+
+    const uint16_t stride = sizeof(InstanceData);
+    const uint32_t available = bgfx::getAvailInstanceDataBuffer(count, stride);
+    if (available == 0)
+        return 0;
+
+    bgfx::InstanceDataBuffer idb;
+    bgfx::allocInstanceDataBuffer(&idb, available, stride);
+    std::memcpy(idb.data, instances, size_t(available) * stride);
+
+    bgfx::setState(state);
+    bgfx::setVertexBuffer(0, depthVbo);
+    setIndexRange(depthIbo, lod);
+    bgfx::setInstanceDataBuffer(&idb);
+    bgfx::submit(view, program);
+
+    return available;
+}
+
+uint32_t Geometry::drawInstanced(bgfx::ProgramHandle program, uint64_t state, const InstanceData* instances, uint32_t count, int lod) const
+{
+    if (!bgfx::isValid(vbo) || !bgfx::isValid(ibo) || count == 0)
+        return 0;
+
+    const uint16_t stride = sizeof(InstanceData);
+    const uint32_t available = bgfx::getAvailInstanceDataBuffer(count, stride);
+    if (available == 0)
+        return 0;
+
+    bgfx::InstanceDataBuffer idb;
+    bgfx::allocInstanceDataBuffer(&idb, available, stride);
+    std::memcpy(idb.data, instances, size_t(available) * stride);
+
+    bgfx::setState(state);
+    bgfx::setVertexBuffer(0, vbo);
+    setIndexRange(ibo, lod);
+    bgfx::setInstanceDataBuffer(&idb);
     bgfx::submit(viewId, program);
+
+    return available;
 }
@@ -3,6 +3,10 @@
 #include <bgfx/bgfx.h>
 #include <vector>
 
+#include "MeshLod.h"
+#include "Meshlets.h"
+#include "SceneInstances.h"
+
 class Shader; // Forward declaration
 
 class Geometry {
@@ -21,7 +25,60 @@ public:
     
     // Draw geometry with custom state
     void draw(bgfx::ProgramHandle program, uint64_t state = BGFX_STATE_DEFAULT) const;
+
+    // Draw a single level of detail with custom state
+    void draw(bgfx::ProgramHandle program, uint64_t state, int lod) const;
+
+    // Draw into an explicit view, for passes that render to their own target
+    void drawInView(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state = BGFX_STATE_DEFAULT) const;
+
+    // Draw a level of detail through an explicit encoder, for submission from worker threads. The caller sets
+    // the transform or instance data and uniforms on the same encoder; depth orders the draw in depth sorted views.
+    void draw(bgfx::Encoder* encoder, bgfx::ProgramHandle program, uint64_t state, int lod, uint32_t depth) const;
+
+    // Draw many copies in a single submit, with per-instance transform and tint in a transient instance buffer.
+    // Returns the number of instances drawn, fewer than count when the transient pool runs out.
+    uint32_t drawInstanced(bgfx::ProgramHandle program, uint64_t state, const InstanceData* instances, uint32_t count, int lod = 0) const;
+
+    // Draw a level of detail into a depth prepass view from the position-only stream and shadow index buffer
+    void drawDepth(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state, int lod = 0) const;
+
+    // Depth-only counterpart of drawInstanced; returns the number of instances drawn
+    uint32_t drawDepthInstanced(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state, const InstanceData* instances, uint32_t count, int lod = 0) const;
+
+    // Start building the LOD chain on a worker thread
+    void buildLods();
+
+    // Upload a finished LOD chain; call once per frame, returns true when new levels became available
+    bool updateLods();
+
+    // Pick the level of detail for the given model matrix and camera
+    int selectLod(const float* model, const LodSelection& selection) const;
+
+    // Number of available levels of detail (1 until the chain has been built)
+    int getLodCount() const { return lods.empty() ? 1 : static_cast<int>(lods.size()); }
+
+    // Number of triangles drawn at the given level of detail
+    uint32_t getTriangleCount(int lod = 0) const;
+
+    // Cull meshlets against the frustum and by normal cone, then draw the survivors with one submit
+    // from a transient index buffer. Returns the number of triangles submitted.
+    uint32_t drawMeshlets(bgfx::ProgramHandle program, uint64_t state, const float* model, const Frustum& frustum, const float* eye);
+
+    // Number of meshlets the full detail mesh was split into
+    uint32_t getMeshletCount() const { return static_cast<uint32_t>(meshlets.meshlets.size()); }
+
+    // Number of meshlets that survived culling in the last drawMeshlets call
+    uint32_t getVisibleMeshletCount() const { return static_cast<uint32_t>(visibleMeshlets.size()); }
     
+    // Bounding sphere in object space
+    const float* getBoundsCenter() const { return boundsCenter; }
+    float getBoundsRadius() const { return boundsRadius; }
+
+    // CPU copy of the full detail mesh: float3 positions and triangle indices, used for software occlusion
+    const std::vector<float>& getPositions() const { return positions; }
+    const std::vector<uint32_t>& getIndices() const { return sourceIndices; }
+
     // Get handle to vertex buffer
     bgfx::VertexBufferHandle getVBO() const { return vbo; }
     
@@ -36,10 +93,37 @@ private:
     // Clean up resources
     void cleanup();
 
+    // Recreate the depth prepass index buffer from the given index list, welding vertices that share a position
+    void createDepthIndexBuffer(const std::vector<uint32_t>& indices);
+
+    // Bind the index range of a level of detail from either index buffer
+    void setIndexRange(bgfx::IndexBufferHandle buffer, int lod) const;
+
     bgfx::VertexBufferHandle vbo;
     bgfx::IndexBufferHandle ibo;
     bgfx::VertexLayout layout;
     uint32_t vertexCount;
     uint32_t indexCount;
     uint8_t viewId;
+
+    // Position-only vertex stream and shadow index buffer for depth prepasses, with the same LOD ranges as ibo
+    bgfx::VertexBufferHandle depthVbo;
+    bgfx::IndexBufferHandle depthIbo;
+
+    // CPU copies of the source mesh used for LOD generation
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<uint32_t> sourceIndices;
+
+    // Bounding sphere in object space
+    float boundsCenter[3];
+    float boundsRadius;
+
+    // Levels of detail, all stored as ranges of ibo
+    std::vector<LodLevel> lods;
+    JobFuture<LodChain> pendingLods;
+
+    // Meshlets of the full detail mesh and the ones that passed culling this frame
+    MeshletSet meshlets;
+    std::vector<uint32_t> visibleMeshlets;
 };
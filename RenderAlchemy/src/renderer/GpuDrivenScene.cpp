@@ -0,0 +1,370 @@
+#include "GpuDrivenScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "FrustumCuller.h"
+#include "Geometry.h"
+#include "Shader.h"
+
+namespace
+{
+	// vec4s per instance in the input buffer: 4 transform columns, tint, bounding sphere, batch index
+	constexpr uint32_t kInputStride = 7;
+
+	// Must match NUM_THREADS in cs_gpu_cull.sc and cs_hiz.sc
+	constexpr uint32_t kCullGroupSize = 64;
+	constexpr uint32_t kHiZGroupSize = 8;
+
+	bgfx::VertexLayout vec4Layout()
+	{
+		bgfx::VertexLayout layout;
+		layout.begin().add(bgfx::Attrib::TexCoord0, 4, bgfx::AttribType::Float).end();
+		return layout;
+	}
+
+	bgfx::VertexLayout instanceLayout()
+	{
+		// Matches InstanceData, so culled instances feed the same shader as CPU instancing
+		bgfx::VertexLayout layout;
+		layout.begin()
+			.add(bgfx::Attrib::TexCoord0, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord1, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord2, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord3, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord4, 4, bgfx::AttribType::Float)
+			.end();
+		return layout;
+	}
+} // namespace
+
+GpuDrivenScene::GpuDrivenScene()
+{
+	std::fill(std::begin(cullViewProj), std::end(cullViewProj), 0.0f);
+	std::fill(std::begin(hizViewProj), std::end(hizViewProj), 0.0f);
+}
+
+GpuDrivenScene::~GpuDrivenScene()
+{
+	destroy();
+}
+
+bool GpuDrivenScene::isSupported()
+{
+	const bgfx::Caps* caps = bgfx::getCaps();
+	const uint64_t required = BGFX_CAPS_COMPUTE | BGFX_CAPS_DRAW_INDIRECT | BGFX_CAPS_INSTANCING;
+	return caps != nullptr && (caps->supported & required) == required;
+}
+
+bool GpuDrivenScene::create(uint32_t capacity)
+{
+	destroy();
+
+	if (!isSupported())
+	{
+		std::cerr << "GPU driven rendering requires compute, indirect draw and instancing support" << std::endl;
+		return false;
+	}
+
+	cullProgram = std::make_unique<Shader>("shaders/cs_gpu_cull.sc");
+	drawProgram = std::make_unique<Shader>("shaders/cs_gpu_draw.sc");
+	hizProgram = std::make_unique<Shader>("shaders/cs_hiz.sc");
+
+	if (!bgfx::isValid(cullProgram->m_program) || !bgfx::isValid(drawProgram->m_program) || !bgfx::isValid(hizProgram->m_program))
+	{
+		std::cerr << "Failed to create GPU culling programs" << std::endl;
+		destroy();
+		return false;
+	}
+
+	maxInstances = capacity;
+
+	instanceInput = bgfx::createDynamicVertexBuffer(maxInstances * kInputStride, vec4Layout(), BGFX_BUFFER_COMPUTE_READ);
+	instanceOutput = bgfx::createDynamicVertexBuffer(maxInstances, instanceLayout(), BGFX_BUFFER_COMPUTE_WRITE);
+	indirectBuffer = bgfx::createIndirectBuffer(kMaxBatches);
+
+	// Counters start at zero; the draw pass resets them after writing the commands
+	std::vector<uint32_t> zeroCounts(kMaxBatches, 0);
+	drawCounts = bgfx::createDynamicIndexBuffer(bgfx::copy(zeroCounts.data(), sizeof(uint32_t) * kMaxBatches), BGFX_BUFFER_COMPUTE_READ_WRITE | BGFX_BUFFER_INDEX32);
+
+	cullParamsUniform = bgfx::createUniform("u_cullParams", bgfx::UniformType::Vec4);
+	hizParamsUniform = bgfx::createUniform("u_hizParams", bgfx::UniformType::Vec4);
+	planesUniform = bgfx::createUniform("u_planes", bgfx::UniformType::Vec4, 6);
+	batchesUniform = bgfx::createUniform("u_batches", bgfx::UniformType::Vec4, kMaxBatches);
+	prevViewProjUniform = bgfx::createUniform("u_prevViewProj", bgfx::UniformType::Mat4);
+	hizSizeUniform = bgfx::createUniform("u_hizSize", bgfx::UniformType::Vec4);
+	hizSampler = bgfx::createUniform("s_hiz", bgfx::UniformType::Sampler);
+	depthSampler = bgfx::createUniform("s_depth", bgfx::UniformType::Sampler);
+
+	// Bound as the previous level while level 0 reads the depth buffer instead
+	const float farDepth = 1.0f;
+	hizPlaceholder = bgfx::createTexture2D(1, 1, false, 1, bgfx::TextureFormat::R32F, BGFX_TEXTURE_COMPUTE_WRITE | BGFX_SAMPLER_POINT, bgfx::copy(&farDepth, sizeof(farDepth)));
+
+	dirty = true;
+	return true;
+}
+
+void GpuDrivenScene::destroy()
+{
+	bgfx::DynamicVertexBufferHandle* vertexBuffers[] = { &instanceInput, &instanceOutput };
+	for (bgfx::DynamicVertexBufferHandle* handle : vertexBuffers)
+	{
+		if (bgfx::isValid(*handle))
+		{
+			bgfx::destroy(*handle);
+			*handle = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	if (bgfx::isValid(drawCounts))
+	{
+		bgfx::destroy(drawCounts);
+		drawCounts = BGFX_INVALID_HANDLE;
+	}
+
+	if (bgfx::isValid(indirectBuffer))
+	{
+		bgfx::destroy(indirectBuffer);
+		indirectBuffer = BGFX_INVALID_HANDLE;
+	}
+
+	bgfx::UniformHandle* uniforms[] = { &cullParamsUniform, &hizParamsUniform, &planesUniform, &batchesUniform, &prevViewProjUniform, &hizSizeUniform, &hizSampler, &depthSampler };
+	for (bgfx::UniformHandle* handle : uniforms)
+	{
+		if (bgfx::isValid(*handle))
+		{
+			bgfx::destroy(*handle);
+			*handle = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	bgfx::TextureHandle* textures[] = { &hiz, &hizPlaceholder };
+	for (bgfx::TextureHandle* handle : textures)
+	{
+		if (bgfx::isValid(*handle))
+		{
+			bgfx::destroy(*handle);
+			*handle = BGFX_INVALID_HANDLE;
+		}
+	}
+	hizValid = false;
+
+	cullProgram.reset();
+	drawProgram.reset();
+	hizProgram.reset();
+
+	maxInstances = 0;
+}
+
+uint32_t GpuDrivenScene::addBatch(const Geometry* geometry)
+{
+	if (batches.size() >= kMaxBatches)
+	{
+		std::cerr << "GPU driven scene supports at most " << kMaxBatches << " batches" << std::endl;
+		return kMaxBatches - 1;
+	}
+
+	batches.push_back({ geometry, {} });
+	dirty = true;
+	return static_cast<uint32_t>(batches.size() - 1);
+}
+
+void GpuDrivenScene::clearInstances()
+{
+	for (Batch& batch : batches)
+	{
+		batch.instances.clear();
+	}
+	instanceCount = 0;
+	dirty = true;
+}
+
+bool GpuDrivenScene::addInstance(uint32_t batch, const InstanceData& instance)
+{
+	if (batch >= batches.size() || instanceCount >= maxInstances)
+		return false;
+
+	batches[batch].instances.push_back(instance);
+	++instanceCount;
+	dirty = true;
+	return true;
+}
+
+void GpuDrivenScene::upload()
+{
+	dirty = false;
+
+	if (!bgfx::isValid(instanceInput) || instanceCount == 0)
+		return;
+
+	// Instances are stored batch by batch so each batch owns a contiguous output range
+	const bgfx::Memory* mem = bgfx::alloc(instanceCount * kInputStride * 4 * sizeof(float));
+	float* out = reinterpret_cast<float*>(mem->data);
+
+	for (uint32_t batchIndex = 0; batchIndex < batches.size(); ++batchIndex)
+	{
+		const Batch& batch = batches[batchIndex];
+		const float* center = batch.geometry->getBoundsCenter();
+		const float radius = batch.geometry->getBoundsRadius();
+
+		for (const InstanceData& instance : batch.instances)
+		{
+			const float* model = instance.transform;
+			std::memcpy(out, &instance, sizeof(InstanceData));
+
+			// World space bounding sphere, radius scaled by the largest axis
+			float scale = 0.0f;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float* column = &model[axis * 4];
+				scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+			}
+
+			for (int k = 0; k < 3; ++k)
+			{
+				out[20 + k] = model[k] * center[0] + model[4 + k] * center[1] + model[8 + k] * center[2] + model[12 + k];
+			}
+			out[23] = radius * scale;
+
+			out[24] = static_cast<float>(batchIndex);
+			out[25] = 0.0f;
+			out[26] = 0.0f;
+			out[27] = 0.0f;
+
+			out += kInputStride * 4;
+		}
+	}
+
+	bgfx::update(instanceInput, 0, mem);
+}
+
+void GpuDrivenScene::cull(bgfx::ViewId view, const float* viewProj)
+{
+	if (!bgfx::isValid(instanceInput))
+		return;
+
+	if (dirty)
+		upload();
+
+	std::memcpy(cullViewProj, viewProj, sizeof(cullViewProj));
+
+	if (instanceCount == 0)
+		return;
+
+	// Batch table: index count, first index, first instance
+	float batchTable[kMaxBatches][4] = {};
+	uint32_t firstInstance = 0;
+	for (uint32_t i = 0; i < batches.size(); ++i)
+	{
+		batchTable[i][0] = static_cast<float>(batches[i].geometry->getTriangleCount(0) * 3);
+		batchTable[i][1] = 0.0f; // Level 0 sits at the front of the index buffer
+		batchTable[i][2] = static_cast<float>(firstInstance);
+		firstInstance += static_cast<uint32_t>(batches[i].instances.size());
+	}
+
+	const bool occlusion = occlusionEnabled && hizValid;
+	const float cullParams[4] = { static_cast<float>(instanceCount), static_cast<float>(batches.size()), occlusion ? 1.0f : 0.0f, static_cast<float>(hizMips) };
+
+	const bgfx::Caps* caps = bgfx::getCaps();
+	const float hizParams[4] = { static_cast<float>(hizWidth), static_cast<float>(hizHeight), caps->homogeneousDepth ? 1.0f : 0.0f, caps->originBottomLeft ? 1.0f : 0.0f };
+
+	const Frustum frustum = Frustum::fromViewProj(viewProj);
+
+	bgfx::setUniform(cullParamsUniform, cullParams);
+	bgfx::setUniform(hizParamsUniform, hizParams);
+	bgfx::setUniform(planesUniform, frustum.planes, 6);
+	bgfx::setUniform(batchesUniform, batchTable, kMaxBatches);
+	bgfx::setUniform(prevViewProjUniform, hizViewProj);
+
+	bgfx::setBuffer(0, instanceInput, bgfx::Access::Read);
+	bgfx::setBuffer(1, instanceOutput, bgfx::Access::Write);
+	bgfx::setBuffer(2, drawCounts, bgfx::Access::ReadWrite);
+	if (occlusion)
+	{
+		bgfx::setTexture(3, hizSampler, hiz);
+	}
+	bgfx::dispatch(view, cullProgram->m_program, (instanceCount + kCullGroupSize - 1) / kCullGroupSize);
+
+	// Turn the per-batch counters into indirect draw commands
+	bgfx::setUniform(cullParamsUniform, cullParams);
+	bgfx::setUniform(batchesUniform, batchTable, kMaxBatches);
+	bgfx::setBuffer(0, drawCounts, bgfx::Access::ReadWrite);
+	bgfx::setBuffer(1, indirectBuffer, bgfx::Access::Write);
+	bgfx::dispatch(view, drawProgram->m_program, 1);
+}
+
+void GpuDrivenScene::draw(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state) const
+{
+	if (!bgfx::isValid(indirectBuffer) || instanceCount == 0)
+		return;
+
+	// One submit per batch regardless of how many instances survived culling. Texture bindings set by the
+	// caller are kept across batches and released after the last one.
+	for (uint32_t i = 0; i < batches.size(); ++i)
+	{
+		const Geometry* geometry = batches[i].geometry;
+		if (batches[i].instances.empty() || !bgfx::isValid(geometry->getVBO()) || !bgfx::isValid(geometry->getIBO()))
+			continue;
+
+		bgfx::setVertexBuffer(0, geometry->getVBO());
+		bgfx::setIndexBuffer(geometry->getIBO());
+		bgfx::setInstanceDataBuffer(instanceOutput, 0, instanceCount);
+		bgfx::setState(state);
+		bgfx::submit(view, program, indirectBuffer, static_cast<uint16_t>(i), 1, 0, BGFX_DISCARD_ALL & ~BGFX_DISCARD_BINDINGS);
+	}
+
+	bgfx::discard(BGFX_DISCARD_ALL);
+}
+
+void GpuDrivenScene::createHiZ(int width, int height)
+{
+	if (bgfx::isValid(hiz))
+	{
+		bgfx::destroy(hiz);
+	}
+
+	hizWidth = std::max(width / 2, 1);
+	hizHeight = std::max(height / 2, 1);
+	hizMips = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(hizWidth, hizHeight)))));
+	hizValid = false;
+
+	hiz = bgfx::createTexture2D(uint16_t(hizWidth), uint16_t(hizHeight), true, 1, bgfx::TextureFormat::R32F, BGFX_TEXTURE_COMPUTE_WRITE | BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP);
+}
+
+void GpuDrivenScene::buildHiZ(bgfx::ViewId view, bgfx::TextureHandle depth, int width, int height)
+{
+	if (!hizProgram || !bgfx::isValid(depth) || width <= 0 || height <= 0)
+		return;
+
+	if (!bgfx::isValid(hiz) || hizWidth != std::max(width / 2, 1) || hizHeight != std::max(height / 2, 1))
+	{
+		createHiZ(width, height);
+	}
+
+	// Level 0 reduces the depth buffer, each further level reduces the one before it
+	for (int mip = 0; mip < hizMips; ++mip)
+	{
+		const int mipWidth = std::max(hizWidth >> mip, 1);
+		const int mipHeight = std::max(hizHeight >> mip, 1);
+		const float hizSize[4] = { static_cast<float>(mipWidth), static_cast<float>(mipHeight), mip == 0 ? 1.0f : 0.0f, 0.0f };
+
+		bgfx::setUniform(hizSizeUniform, hizSize);
+		bgfx::setTexture(0, depthSampler, depth);
+		if (mip == 0)
+		{
+			bgfx::setImage(1, hizPlaceholder, 0, bgfx::Access::Read, bgfx::TextureFormat::R32F);
+		}
+		else
+		{
+			bgfx::setImage(1, hiz, uint8_t(mip - 1), bgfx::Access::Read, bgfx::TextureFormat::R32F);
+		}
+		bgfx::setImage(2, hiz, uint8_t(mip), bgfx::Access::Write, bgfx::TextureFormat::R32F);
+		bgfx::dispatch(view, hizProgram->m_program, (mipWidth + kHiZGroupSize - 1) / kHiZGroupSize, (mipHeight + kHiZGroupSize - 1) / kHiZGroupSize);
+	}
+
+	// The pyramid now matches the camera the scene was culled with this frame
+	std::memcpy(hizViewProj, cullViewProj, sizeof(hizViewProj));
+	hizValid = true;
+}
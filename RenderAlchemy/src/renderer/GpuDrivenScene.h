@@ -0,0 +1,111 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "SceneInstances.h"
+
+class Geometry;
+class Shader;
+
+// Draws many instances of a few geometries without per-instance CPU work.
+// A compute pass culls instances against the frustum and the previous frame's hierarchical depth,
+// compacts the survivors per batch and writes indirect draw commands; each batch is then drawn
+// with a single indirect submit.
+class GpuDrivenScene
+{
+public:
+	// Batches are described by a uniform array of this size
+	static constexpr uint32_t kMaxBatches = 16;
+
+	GpuDrivenScene();
+	~GpuDrivenScene();
+
+	// True when the renderer supports compute, indirect draws and instancing
+	static bool isSupported();
+
+	// Create GPU resources for up to maxInstances instances; returns false when unsupported
+	bool create(uint32_t maxInstances);
+
+	// Release all GPU resources
+	void destroy();
+
+	// Register a geometry drawn as one batch; returns its index
+	uint32_t addBatch(const Geometry* geometry);
+
+	// Remove all instances, registered batches are kept
+	void clearInstances();
+
+	// Add an instance of a batch; returns false when the batch is unknown or the scene is full
+	bool addInstance(uint32_t batch, const InstanceData& instance);
+
+	// Cull all instances on the GPU with this frame's view-projection matrix
+	void cull(bgfx::ViewId view, const float* viewProj);
+
+	// Draw every batch with one indirect submit each
+	void draw(bgfx::ViewId view, bgfx::ProgramHandle program, uint64_t state) const;
+
+	// Build the depth pyramid from the scene depth, used for occlusion culling in the next frame
+	void buildHiZ(bgfx::ViewId view, bgfx::TextureHandle depth, int width, int height);
+
+	// Enable or disable the occlusion test against the previous frame's depth
+	void setOcclusionEnabled(bool enabled) { occlusionEnabled = enabled; }
+
+	// Number of instances across all batches
+	uint32_t getInstanceCount() const { return instanceCount; }
+
+	// Number of batches, equal to the number of draw calls issued by draw()
+	uint32_t getBatchCount() const { return static_cast<uint32_t>(batches.size()); }
+
+	// Maximum number of instances
+	uint32_t getCapacity() const { return maxInstances; }
+
+private:
+	struct Batch
+	{
+		const Geometry* geometry;
+		std::vector<InstanceData> instances;
+	};
+
+	// Upload instance transforms and world space bounds after instances changed
+	void upload();
+
+	// Recreate the depth pyramid for a new scene size
+	void createHiZ(int width, int height);
+
+	std::vector<Batch> batches;
+	uint32_t instanceCount = 0;
+	uint32_t maxInstances = 0;
+	bool dirty = false;
+	bool occlusionEnabled = true;
+
+	std::unique_ptr<Shader> cullProgram;
+	std::unique_ptr<Shader> drawProgram;
+	std::unique_ptr<Shader> hizProgram;
+
+	bgfx::DynamicVertexBufferHandle instanceInput = BGFX_INVALID_HANDLE;
+	bgfx::DynamicVertexBufferHandle instanceOutput = BGFX_INVALID_HANDLE;
+	bgfx::DynamicIndexBufferHandle drawCounts = BGFX_INVALID_HANDLE;
+	bgfx::IndirectBufferHandle indirectBuffer = BGFX_INVALID_HANDLE;
+
+	bgfx::UniformHandle cullParamsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle hizParamsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle planesUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle batchesUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle prevViewProjUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle hizSizeUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle hizSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle depthSampler = BGFX_INVALID_HANDLE;
+
+	// Depth pyramid at half the scene resolution, the camera it was rendered with and whether it holds data
+	bgfx::TextureHandle hiz = BGFX_INVALID_HANDLE;
+	bgfx::TextureHandle hizPlaceholder = BGFX_INVALID_HANDLE;
+	int hizWidth = 0;
+	int hizHeight = 0;
+	int hizMips = 0;
+	bool hizValid = false;
+	float cullViewProj[16];
+	float hizViewProj[16];
+};
@@ -0,0 +1,128 @@
+#include "GpuScopes.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "Shader.h"
+
+namespace
+{
+	constexpr int kGroupSize = 16;
+
+	// Histogram, waveform and vectorscope bins, matching the offsets in the scope shaders
+	constexpr uint32_t kBinCount = GpuScopes::kBins * 4 + GpuScopes::kBins * GpuScopes::kBins * 2;
+} // namespace
+
+GpuScopes::~GpuScopes()
+{
+	destroy();
+}
+
+bool GpuScopes::isSupported()
+{
+	const bgfx::Caps* caps = bgfx::getCaps();
+	return caps != nullptr && (caps->supported & BGFX_CAPS_COMPUTE) != 0;
+}
+
+bool GpuScopes::create()
+{
+	destroy();
+
+	if (!isSupported())
+	{
+		std::cerr << "GPU scopes require compute support" << std::endl;
+		return false;
+	}
+
+	accumulateProgram = std::make_unique<Shader>("shaders/cs_scope_accumulate.sc");
+	resolveProgram = std::make_unique<Shader>("shaders/cs_scope_resolve.sc");
+	histogramProgram = std::make_unique<Shader>("shaders/cs_scope_histogram.sc");
+
+	if (!bgfx::isValid(accumulateProgram->m_program) || !bgfx::isValid(resolveProgram->m_program) || !bgfx::isValid(histogramProgram->m_program))
+	{
+		std::cerr << "Failed to create GPU scope programs" << std::endl;
+		destroy();
+		return false;
+	}
+
+	// Bins start at zero; the resolve passes clear them after reading
+	std::vector<uint32_t> zeroBins(kBinCount, 0);
+	bins = bgfx::createDynamicIndexBuffer(bgfx::copy(zeroBins.data(), sizeof(uint32_t) * kBinCount), BGFX_BUFFER_COMPUTE_READ_WRITE | BGFX_BUFFER_INDEX32);
+
+	const uint64_t flags = BGFX_TEXTURE_COMPUTE_WRITE | BGFX_SAMPLER_UVW_CLAMP;
+	histogram = bgfx::createTexture2D(uint16_t(kBins), uint16_t(kHistogramHeight), false, 1, bgfx::TextureFormat::RGBA8, flags);
+	waveform = bgfx::createTexture2D(uint16_t(kBins), uint16_t(kBins), false, 1, bgfx::TextureFormat::RGBA8, flags);
+	vectorscope = bgfx::createTexture2D(uint16_t(kBins), uint16_t(kBins), false, 1, bgfx::TextureFormat::RGBA8, flags);
+
+	sourceSampler = bgfx::createUniform("s_scopeSource", bgfx::UniformType::Sampler);
+	paramsUniform = bgfx::createUniform("u_scopeParams", bgfx::UniformType::Vec4);
+	sourceUniform = bgfx::createUniform("u_scopeSource", bgfx::UniformType::Vec4);
+	resolveUniform = bgfx::createUniform("u_scopeResolve", bgfx::UniformType::Vec4);
+
+	return true;
+}
+
+void GpuScopes::destroy()
+{
+	if (bgfx::isValid(bins))
+	{
+		bgfx::destroy(bins);
+		bins = BGFX_INVALID_HANDLE;
+	}
+
+	bgfx::TextureHandle* textures[] = { &histogram, &waveform, &vectorscope };
+	for (bgfx::TextureHandle* texture : textures)
+	{
+		if (bgfx::isValid(*texture))
+		{
+			bgfx::destroy(*texture);
+			*texture = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	bgfx::UniformHandle* uniforms[] = { &sourceSampler, &paramsUniform, &sourceUniform, &resolveUniform };
+	for (bgfx::UniformHandle* uniform : uniforms)
+	{
+		if (bgfx::isValid(*uniform))
+		{
+			bgfx::destroy(*uniform);
+			*uniform = BGFX_INVALID_HANDLE;
+		}
+	}
+
+	accumulateProgram.reset();
+	resolveProgram.reset();
+	histogramProgram.reset();
+}
+
+void GpuScopes::update(bgfx::ViewId view, bgfx::TextureHandle source, int width, int height, bool hdr, float exposure)
+{
+	if (!isValid() || !bgfx::isValid(source) || width <= 0 || height <= 0)
+		return;
+
+	const int samplesX = std::min(width, kMaxSamplesX);
+	const int samplesY = std::min(height, kMaxSamplesY);
+	sampleCount = uint32_t(samplesX) * samplesY;
+
+	const float params[4] = { float(samplesX), float(samplesY), hdr ? 1.0f : 0.0f, exposure };
+	const float sourceSize[4] = { float(width), float(height), 0.0f, 0.0f };
+	bgfx::setUniform(paramsUniform, params);
+	bgfx::setUniform(sourceUniform, sourceSize);
+	bgfx::setTexture(0, sourceSampler, source, BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP);
+	bgfx::setBuffer(1, bins, bgfx::Access::ReadWrite);
+	bgfx::dispatch(view, accumulateProgram->m_program, uint32_t(samplesX + kGroupSize - 1) / kGroupSize, uint32_t(samplesY + kGroupSize - 1) / kGroupSize);
+
+	// Gain relative to an even spread, so trace brightness does not depend on the sample count
+	const float averageCount = float(sampleCount) / (kBins * kBins);
+	const float resolve[4] = { density * 0.25f / std::max(averageCount, 1.0f), 0.0f, 0.0f, 0.0f };
+	bgfx::setUniform(resolveUniform, resolve);
+	bgfx::setBuffer(0, bins, bgfx::Access::ReadWrite);
+	bgfx::setImage(1, waveform, 0, bgfx::Access::Write, bgfx::TextureFormat::RGBA8);
+	bgfx::setImage(2, vectorscope, 0, bgfx::Access::Write, bgfx::TextureFormat::RGBA8);
+	bgfx::dispatch(view, resolveProgram->m_program, kBins / kGroupSize, kBins / kGroupSize);
+
+	bgfx::setBuffer(0, bins, bgfx::Access::ReadWrite);
+	bgfx::setImage(1, histogram, 0, bgfx::Access::Write, bgfx::TextureFormat::RGBA8);
+	bgfx::dispatch(view, histogramProgram->m_program, 1);
+}
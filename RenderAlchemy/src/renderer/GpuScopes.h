@@ -0,0 +1,71 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <memory>
+
+class Shader;
+
+// Video scopes measured entirely on the GPU: RGB and luma histogram, luma waveform and vectorscope.
+// A compute pass samples the image on a reduced grid and counts into a small buffer with atomics, the
+// histogram per group in shared memory first. Two more passes turn the counts into RGBA8 images for the
+// UI and clear them again, so nothing is read back and the cost does not grow with the resolution.
+class GpuScopes
+{
+public:
+	static constexpr int kBins = 256;
+	static constexpr int kHistogramHeight = 128;
+
+	// Largest sample grid; smaller images are sampled once per pixel
+	static constexpr int kMaxSamplesX = 480;
+	static constexpr int kMaxSamplesY = 270;
+
+	GpuScopes() = default;
+	~GpuScopes();
+
+	// True when the renderer supports compute
+	static bool isSupported();
+
+	// Create the programs, buffer and scope images; returns false when unsupported
+	bool create();
+
+	// Release all GPU resources
+	void destroy();
+
+	// Measure source, width by height pixels, and redraw the scope images. An HDR source is scaled by
+	// exposure and log encoded first, a graded one is measured as is.
+	void update(bgfx::ViewId view, bgfx::TextureHandle source, int width, int height, bool hdr, float exposure);
+
+	// Brightness of the waveform and vectorscope traces
+	void setDensity(float value) { density = value; }
+	float getDensity() const { return density; }
+
+	bool isValid() const { return bgfx::isValid(histogram); }
+
+	bgfx::TextureHandle getHistogram() const { return histogram; }
+	bgfx::TextureHandle getWaveform() const { return waveform; }
+	bgfx::TextureHandle getVectorscope() const { return vectorscope; }
+
+	// Samples taken by the last update
+	uint32_t getSampleCount() const { return sampleCount; }
+
+private:
+	float density = 1.0f;
+	uint32_t sampleCount = 0;
+
+	std::unique_ptr<Shader> accumulateProgram;
+	std::unique_ptr<Shader> resolveProgram;
+	std::unique_ptr<Shader> histogramProgram;
+
+	// Histogram bins for R, G, B and luma, then the waveform and vectorscope grids
+	bgfx::DynamicIndexBufferHandle bins = BGFX_INVALID_HANDLE;
+
+	bgfx::TextureHandle histogram = BGFX_INVALID_HANDLE;
+	bgfx::TextureHandle waveform = BGFX_INVALID_HANDLE;
+	bgfx::TextureHandle vectorscope = BGFX_INVALID_HANDLE;
+
+	bgfx::UniformHandle sourceSampler = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle paramsUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle sourceUniform = BGFX_INVALID_HANDLE;
+	bgfx::UniformHandle resolveUniform = BGFX_INVALID_HANDLE;
+};
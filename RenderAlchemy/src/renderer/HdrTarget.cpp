@@ -0,0 +1,71 @@
+#include "HdrTarget.h"
+
+bool HdrTarget::isCompactSupported()
+{
+	const bgfx::Caps* caps = bgfx::getCaps();
+	const uint16_t required = BGFX_CAPS_FORMAT_TEXTURE_2D | BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER;
+	return caps != nullptr && (caps->formats[bgfx::TextureFormat::RG11B10F] & required) == required;
+}
+
+bgfx::TextureFormat::Enum HdrTarget::getFormat(HdrFormatTier formatTier)
+{
+	if (formatTier == HdrFormatTier::Compact && isCompactSupported())
+		return bgfx::TextureFormat::RG11B10F;
+
+	return bgfx::TextureFormat::RGBA16F;
+}
+
+const char* HdrTarget::getName(HdrFormatTier formatTier)
+{
+	return formatTier == HdrFormatTier::Compact ? "RG11B10F" : "RGBA16F";
+}
+
+void HdrTarget::startBenchmark()
+{
+	benchmarking = true;
+	measured = HdrFormatTier::Full;
+	frames = 0;
+	samples = 0;
+	sceneSum = 0.0f;
+	postSum = 0.0f;
+	results[0] = Result();
+	results[1] = Result();
+}
+
+bgfx::TextureFormat::Enum HdrTarget::beginFrame()
+{
+	return getFormat(benchmarking ? measured : tier);
+}
+
+void HdrTarget::endFrame(float sceneGpuMs, float postGpuMs, uint32_t colorBytes)
+{
+	if (!benchmarking)
+		return;
+
+	if (++frames <= kWarmupFrames)
+		return;
+
+	sceneSum += sceneGpuMs;
+	postSum += postGpuMs;
+	if (++samples < kSampleFrames)
+		return;
+
+	// Finished timing one tier, move on to the other or back to the selected one
+	Result& result = results[static_cast<int>(measured)];
+	result.sceneMs = sceneSum / samples;
+	result.postMs = postSum / samples;
+	result.colorBytes = colorBytes;
+	frames = 0;
+	samples = 0;
+	sceneSum = 0.0f;
+	postSum = 0.0f;
+
+	if (measured == HdrFormatTier::Full && isCompactSupported())
+	{
+		measured = HdrFormatTier::Compact;
+	}
+	else
+	{
+		benchmarking = false;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+
+enum class HdrFormatTier
+{
+	Full,   // RGBA16F, 8 bytes per pixel
+	Compact // RG11B10F, 4 bytes per pixel, no alpha and no negative values
+};
+
+// Chooses the colour format of the HDR scene target and compares the tiers on request.
+// The compact tier halves the bandwidth of every pass writing or reading the scene colour, which matters
+// most on integrated GPUs at high resolutions; renderers without RG11B10F render targets fall back to RGBA16F.
+// The benchmark renders each tier for a fixed number of frames and averages the scene and post pass GPU times.
+class HdrTarget
+{
+public:
+	// GPU timings lag a few frames behind submission, so samples right after a switch are dropped
+	static constexpr int kWarmupFrames = 4;
+	static constexpr int kSampleFrames = 64;
+
+	struct Result
+	{
+		float sceneMs = -1.0f; // Negative until measured
+		float postMs = -1.0f;
+		uint32_t colorBytes = 0;
+	};
+
+	// True when RG11B10F can be rendered to and sampled
+	static bool isCompactSupported();
+
+	// Format used for a tier on this renderer
+	static bgfx::TextureFormat::Enum getFormat(HdrFormatTier tier);
+	static const char* getName(HdrFormatTier tier);
+
+	void setTier(HdrFormatTier newTier) { tier = newTier; }
+	HdrFormatTier getTier() const { return tier; }
+
+	// Time both tiers, then return to the selected one
+	void startBenchmark();
+	bool isBenchmarking() const { return benchmarking; }
+
+	// Start a frame; returns the format the scene target must have this frame
+	bgfx::TextureFormat::Enum beginFrame();
+
+	// Report the GPU times of the frame started with beginFrame and the size of its colour target
+	void endFrame(float sceneGpuMs, float postGpuMs, uint32_t colorBytes);
+
+	// Averages from the last benchmark
+	const Result& getResult(HdrFormatTier resultTier) const { return results[static_cast<int>(resultTier)]; }
+
+private:
+	HdrFormatTier tier = HdrFormatTier::Full;
+	HdrFormatTier measured = HdrFormatTier::Full;
+	bool benchmarking = false;
+
+	int frames = 0;
+	int samples = 0;
+	float sceneSum = 0.0f;
+	float postSum = 0.0f;
+	Result results[2];
+};
@@ -0,0 +1,144 @@
+#include "MeshLod.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../meshoptimizer/meshoptimizer.h"
+
+namespace MeshLod
+{
+	// Stop simplifying once a level is this small; coarser levels are not worth an extra range
+	constexpr size_t kMinIndexCount = 36;
+
+	// A level must remove at least this fraction of the previous level to be kept
+	constexpr float kMinReduction = 0.1f;
+
+	LodChain buildChain(const std::vector<uint32_t>& indices, const float* positions, size_t vertexCount, size_t positionStride, const float* attributes, size_t attributeStride, size_t attributeCount)
+	{
+		LodChain chain;
+		chain.indices = indices;
+		chain.levels.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+		if (indices.empty() || vertexCount == 0)
+		{
+			return chain;
+		}
+
+		// meshopt reports relative errors, the scale converts them to object space units
+		const float errorScale = meshopt_simplifyScale(positions, vertexCount, positionStride);
+
+		// Attributes are weighted below position so silhouettes drive the reduction
+		std::vector<float> attributeWeights(attributeCount, 0.5f);
+
+		std::vector<uint32_t> source = indices;
+		std::vector<uint32_t> lod(indices.size());
+		float error = 0.0f;
+
+		while (static_cast<int>(chain.levels.size()) < kMaxLevels && source.size() > kMinIndexCount)
+		{
+			const size_t targetCount = (source.size() / 2) / 3 * 3;
+			float resultError = 0.0f;
+			size_t lodCount = 0;
+
+			if (attributes != nullptr && attributeCount > 0)
+			{
+				lodCount = meshopt_simplifyWithAttributes(lod.data(), source.data(), source.size(), positions, vertexCount, positionStride, attributes, attributeStride, attributeWeights.data(), attributeCount, nullptr, targetCount, 1.0f, meshopt_SimplifyLockBorder, &resultError);
+			}
+			else
+			{
+				lodCount = meshopt_simplify(lod.data(), source.data(), source.size(), positions, vertexCount, positionStride, targetCount, 1.0f, meshopt_SimplifyLockBorder, &resultError);
+			}
+
+			// Topology constraints can stall the regular simplifier, fall back to the sloppy one
+			if (lodCount > source.size() * (1.0f - kMinReduction))
+			{
+				lodCount = meshopt_simplifySloppy(lod.data(), source.data(), source.size(), positions, vertexCount, positionStride, targetCount, 1.0f, &resultError);
+			}
+
+			if (lodCount == 0 || lodCount > source.size() * (1.0f - kMinReduction))
+			{
+				break;
+			}
+
+			// Levels are simplified from each other and each error is measured against the level before, so the
+			// sum bounds the deviation from the full detail mesh; the selection relies on this staying conservative
+			error += resultError * errorScale;
+
+			LodLevel level;
+			level.indexStart = static_cast<uint32_t>(chain.indices.size());
+			level.indexCount = static_cast<uint32_t>(lodCount);
+			level.error = error;
+			chain.levels.push_back(level);
+
+			meshopt_optimizeVertexCache(lod.data(), lod.data(), lodCount, vertexCount);
+			chain.indices.insert(chain.indices.end(), lod.begin(), lod.begin() + lodCount);
+
+			source.assign(lod.begin(), lod.begin() + lodCount);
+		}
+
+		return chain;
+	}
+
+	JobFuture<LodChain> buildChainAsync(std::vector<uint32_t> indices, std::vector<float> positions, std::vector<float> attributes, size_t attributeCount)
+	{
+		return JobSystem::async([indices = std::move(indices), positions = std::move(positions), attributes = std::move(attributes), attributeCount]()
+		{
+			const size_t vertexCount = positions.size() / 3;
+			const float* attributeData = attributes.empty() ? nullptr : attributes.data();
+			return buildChain(indices, positions.data(), vertexCount, sizeof(float) * 3, attributeData, sizeof(float) * attributeCount, attributeCount);
+		});
+	}
+
+	float projectionScale(float fovY, int viewportHeight)
+	{
+		return static_cast<float>(viewportHeight) / (2.0f * std::tan(fovY * 0.5f));
+	}
+
+	int selectLevel(const std::vector<LodLevel>& levels, const float* center, float radius, const float* model, const LodSelection& selection)
+	{
+		if (levels.size() <= 1)
+		{
+			return 0;
+		}
+
+		// Bounding sphere centre in world space (column-major model matrix)
+		float world[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			world[i] = model[i] * center[0] + model[4 + i] * center[1] + model[8 + i] * center[2] + model[12 + i];
+		}
+
+		// Largest axis scale, so errors stay conservative under non-uniform scaling
+		float scale = 0.0f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float* column = &model[axis * 4];
+			scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+		}
+
+		const float dx = world[0] - selection.eye[0];
+		const float dy = world[1] - selection.eye[1];
+		const float dz = world[2] - selection.eye[2];
+
+		// Distance to the closest point of the sphere; the camera inside the sphere always gets full detail
+		const float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - radius * scale;
+		if (distance <= 0.0f)
+		{
+			return 0;
+		}
+
+		const float pixelsPerUnit = selection.projScale * scale / distance;
+
+		int level = 0;
+		for (int i = 1; i < static_cast<int>(levels.size()); ++i)
+		{
+			if (levels[i].error * pixelsPerUnit > selection.pixelThreshold)
+			{
+				break;
+			}
+			level = i;
+		}
+
+		return level;
+	}
+} // namespace MeshLod
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../core/JobSystem.h"
+
+// A single level of detail, stored as a range in a shared index buffer
+struct LodLevel
+{
+	uint32_t indexStart;
+	uint32_t indexCount;
+	float error; // Absolute (object space) deviation from the full detail mesh
+};
+
+// Result of a LOD build: all levels concatenated in one index buffer, level 0 first
+struct LodChain
+{
+	std::vector<uint32_t> indices;
+	std::vector<LodLevel> levels;
+};
+
+// Settings used to pick a level at draw time
+struct LodSelection
+{
+	float eye[3];         // Camera position in world space
+	float projScale;      // Pixels per world unit at distance 1, see MeshLod::projectionScale
+	float pixelThreshold; // Largest tolerated screen space error in pixels
+};
+
+namespace MeshLod
+{
+	// Maximum number of levels generated per mesh, including the source level
+	constexpr int kMaxLevels = 6;
+
+	// Build a LOD chain with meshopt_simplify, each level targeting half the triangles of the previous one.
+	// Positions are read as float3 from the start of each vertex; attributes (e.g. normals) are optional.
+	LodChain buildChain(const std::vector<uint32_t>& indices, const float* positions, size_t vertexCount, size_t positionStride, const float* attributes = nullptr, size_t attributeStride = 0, size_t attributeCount = 0);
+
+	// Same as buildChain but runs as a job; the inputs are copied so the caller may release them
+	JobFuture<LodChain> buildChainAsync(std::vector<uint32_t> indices, std::vector<float> positions, std::vector<float> attributes = {}, size_t attributeCount = 0);
+
+	// Convert a vertical field of view and viewport height into a projection scale
+	float projectionScale(float fovY, int viewportHeight);
+
+	// Pick the coarsest level whose projected error stays below the threshold
+	int selectLevel(const std::vector<LodLevel>& levels, const float* center, float radius, const float* model, const LodSelection& selection);
+} // namespace MeshLod
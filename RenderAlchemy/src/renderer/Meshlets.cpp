@@ -0,0 +1,106 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../meshoptimizer/meshoptimizer.h"
+
+namespace Meshlets
+{
+	// Trade some spatial locality for narrower normal cones, which improves backface culling
+	constexpr float kConeWeight = 0.25f;
+
+	MeshletSet build(const std::vector<uint32_t>& indices, const float* positions, size_t vertexCount, size_t positionStride)
+	{
+		MeshletSet set;
+		if (indices.empty() || vertexCount == 0)
+		{
+			return set;
+		}
+
+		const size_t maxMeshlets = meshopt_buildMeshletsBound(indices.size(), kMaxVertices, kMaxTriangles);
+		std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+		std::vector<unsigned int> meshletVertices(maxMeshlets * kMaxVertices);
+		std::vector<unsigned char> meshletTriangles(maxMeshlets * kMaxTriangles * 3);
+
+		const size_t meshletCount = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(), indices.data(), indices.size(), positions, vertexCount, positionStride, kMaxVertices, kMaxTriangles, kConeWeight);
+
+		set.indices.reserve(indices.size());
+		set.meshlets.reserve(meshletCount);
+
+		for (size_t i = 0; i < meshletCount; ++i)
+		{
+			const meshopt_Meshlet& source = meshlets[i];
+			const unsigned int* vertices = &meshletVertices[source.vertex_offset];
+			const unsigned char* triangles = &meshletTriangles[source.triangle_offset];
+
+			const meshopt_Bounds bounds = meshopt_computeMeshletBounds(vertices, triangles, source.triangle_count, positions, vertexCount, positionStride);
+
+			Meshlet meshlet;
+			meshlet.indexStart = static_cast<uint32_t>(set.indices.size());
+			meshlet.indexCount = source.triangle_count * 3;
+			meshlet.radius = bounds.radius;
+			meshlet.coneCutoff = bounds.cone_cutoff;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				meshlet.center[axis] = bounds.center[axis];
+				meshlet.coneApex[axis] = bounds.cone_apex[axis];
+				meshlet.coneAxis[axis] = bounds.cone_axis[axis];
+			}
+
+			// Expand the local triangle list back into mesh vertex indices so it can feed a regular index buffer
+			for (size_t j = 0; j < size_t(source.triangle_count) * 3; ++j)
+			{
+				set.indices.push_back(vertices[triangles[j]]);
+			}
+
+			set.meshlets.push_back(meshlet);
+			set.culler.add(meshlet.center, meshlet.radius);
+		}
+
+		return set;
+	}
+
+	uint32_t cull(const MeshletSet& set, const Frustum& frustum, const float* model, const float* eye, std::vector<uint32_t>& visible)
+	{
+		// Frustum test every meshlet in SIMD batches first, the cone test then only runs on survivors
+		set.culler.cull(frustum, model, visible);
+
+		uint32_t triangles = 0;
+		size_t written = 0;
+
+		for (size_t i = 0; i < visible.size(); ++i)
+		{
+			const Meshlet& meshlet = set.meshlets[visible[i]];
+
+			if (meshlet.coneCutoff < 1.0f)
+			{
+				// Move the cone into world space; assumes rotation and uniform scale, like the rest of the scene
+				float apex[3];
+				float axis[3];
+				for (int k = 0; k < 3; ++k)
+				{
+					apex[k] = model[k] * meshlet.coneApex[0] + model[4 + k] * meshlet.coneApex[1] + model[8 + k] * meshlet.coneApex[2] + model[12 + k];
+					axis[k] = model[k] * meshlet.coneAxis[0] + model[4 + k] * meshlet.coneAxis[1] + model[8 + k] * meshlet.coneAxis[2];
+				}
+
+				// The apex form is tighter than the bounding sphere form for clusters close to the camera
+				const float toApex[3] = { apex[0] - eye[0], apex[1] - eye[1], apex[2] - eye[2] };
+				const float lengths = std::sqrt(toApex[0] * toApex[0] + toApex[1] * toApex[1] + toApex[2] * toApex[2]) * std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+				const float facing = (toApex[0] * axis[0] + toApex[1] * axis[1] + toApex[2] * axis[2]) / std::max(lengths, 1e-8f);
+
+				// Every triangle in the cluster faces away from the camera
+				if (facing >= meshlet.coneCutoff)
+				{
+					continue;
+				}
+			}
+
+			visible[written++] = visible[i];
+			triangles += meshlet.indexCount / 3;
+		}
+
+		visible.resize(written);
+		return triangles;
+	}
+} // namespace Meshlets
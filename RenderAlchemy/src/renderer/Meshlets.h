@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FrustumCuller.h"
+
+// A small cluster of triangles with bounds for frustum and backface cone culling
+struct Meshlet
+{
+	uint32_t indexStart; // First index of the cluster in MeshletSet::indices
+	uint32_t indexCount;
+	float center[3];     // Bounding sphere in object space
+	float radius;
+	float coneApex[3];   // Normal cone; the cluster is backfacing when the camera lies inside the cone behind the apex
+	float coneAxis[3];
+	float coneCutoff;    // Cosine of the cone angle; 1 means the cone is degenerate and never culls
+};
+
+// Meshlets of one mesh; their triangles are stored back to back using the mesh's vertex indices
+struct MeshletSet
+{
+	std::vector<uint32_t> indices;
+	std::vector<Meshlet> meshlets;
+	FrustumCuller culler; // Meshlet bounding spheres in SIMD friendly layout
+};
+
+namespace Meshlets
+{
+	// Cluster limits; 64/124 keeps clusters small enough for tight cones and fits mesh shader limits
+	constexpr size_t kMaxVertices = 64;
+	constexpr size_t kMaxTriangles = 124;
+
+	// Split a mesh into meshlets with meshopt_buildMeshlets and compute their bounds.
+	// Positions are read as float3 from the start of each vertex.
+	MeshletSet build(const std::vector<uint32_t>& indices, const float* positions, size_t vertexCount, size_t positionStride);
+
+	// Cull meshlets against the frustum and by their normal cones for a camera at eye (world space).
+	// Indices of the surviving meshlets are written to visible; returns the number of triangles they hold.
+	uint32_t cull(const MeshletSet& set, const Frustum& frustum, const float* model, const float* eye, std::vector<uint32_t>& visible);
+} // namespace Meshlets
@@ -0,0 +1,401 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "../core/JobSystem.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#	include <emmintrin.h>
+#	define RA_OCCLUSION_SSE 1
+#else
+#	define RA_OCCLUSION_SSE 0
+#endif
+
+namespace
+{
+	constexpr int kTilesX = OcclusionCuller::kWidth / OcclusionCuller::kTileWidth;
+	constexpr int kTilesY = OcclusionCuller::kHeight / OcclusionCuller::kTileHeight;
+	constexpr int kSubtiles = OcclusionCuller::kSubtilesPerTile;
+	constexpr int kSubtileWidth = OcclusionCuller::kSubtileWidth;
+	constexpr int kTileHeight = OcclusionCuller::kTileHeight;
+	constexpr uint32_t kFullMask = 0xffffffffu;
+
+	// Vertices closer than this (clip space w) are not rasterized and make bounds count as visible
+	constexpr float kNearW = 1e-3f;
+
+	// Cleared depth; anything is in front of it
+	constexpr float kFarDepth = 1.0f;
+
+	// Depth of an empty working layer, behind which nothing is hidden
+	constexpr float kEmptyDepth = -FLT_MAX;
+
+	void multiply(float* result, const float* a, const float* b)
+	{
+		// Column-major a * b
+		for (int col = 0; col < 4; ++col)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < 4; ++k)
+				{
+					sum += a[k * 4 + row] * b[col * 4 + k];
+				}
+				result[col * 4 + row] = sum;
+			}
+		}
+	}
+
+	// Edge function, positive on the inner side of a counter-clockwise edge a -> b
+	inline float edge(const float* a, const float* b, float x, float y)
+	{
+		return (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+	}
+} // namespace
+
+OcclusionCuller::OcclusionCuller()
+	: tiles(kTilesX * kTilesY)
+{
+	std::fill(std::begin(viewProj), std::end(viewProj), 0.0f);
+}
+
+void OcclusionCuller::beginFrame(const float* frameViewProj)
+{
+	std::memcpy(viewProj, frameViewProj, sizeof(viewProj));
+	for (Tile& tile : tiles)
+	{
+		for (int i = 0; i < kSubtiles; ++i)
+		{
+			tile.referenceDepth[i] = kFarDepth;
+			tile.workingDepth[i] = kEmptyDepth;
+			tile.mask[i] = 0;
+		}
+	}
+	triangles.clear();
+	occluderCount = 0;
+	tested = 0;
+	culled = 0;
+}
+
+void OcclusionCuller::addOccluder(const float* positions, const uint32_t* indices, uint32_t indexCount, const float* model)
+{
+	float mvp[16];
+	multiply(mvp, viewProj, model);
+
+	++occluderCount;
+
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		float screen[9];
+		bool clipped = false;
+
+		for (int v = 0; v < 3; ++v)
+		{
+			const float* p = &positions[indices[i + v] * 3];
+			float clip[4];
+			for (int k = 0; k < 4; ++k)
+			{
+				clip[k] = mvp[k] * p[0] + mvp[4 + k] * p[1] + mvp[8 + k] * p[2] + mvp[12 + k];
+			}
+
+			// Triangles crossing the near plane are dropped, which only ever makes culling less aggressive
+			if (clip[3] < kNearW)
+			{
+				clipped = true;
+				break;
+			}
+
+			const float invW = 1.0f / clip[3];
+			screen[v * 3 + 0] = (clip[0] * invW * 0.5f + 0.5f) * kWidth;
+			screen[v * 3 + 1] = (0.5f - clip[1] * invW * 0.5f) * kHeight;
+			screen[v * 3 + 2] = clip[2] * invW;
+		}
+
+		if (clipped)
+		{
+			continue;
+		}
+
+		// Occluders are treated as double sided, flip clockwise triangles
+		const float area = edge(&screen[0], &screen[3], screen[6], screen[7]);
+		if (std::abs(area) < 1e-6f)
+		{
+			continue;
+		}
+		if (area < 0.0f)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				std::swap(screen[3 + k], screen[6 + k]);
+			}
+		}
+
+		triangles.insert(triangles.end(), screen, screen + 9);
+	}
+}
+
+void OcclusionCuller::rasterize()
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	// One band of tile rows per thread, since every band sets up all triangles
+	const uint32_t threads = static_cast<uint32_t>(std::clamp(JobSystem::getThreadCount(), 1, kTilesY));
+	const uint32_t tileRowsPerBand = (kTilesY + threads - 1) / threads;
+
+	JobSystem::parallelFor(0, kTilesY, [this](uint32_t tileRowBegin, uint32_t tileRowEnd) {
+		rasterizeBand(static_cast<int>(tileRowBegin), static_cast<int>(tileRowEnd));
+	}, tileRowsPerBand);
+
+	rasterizeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void OcclusionCuller::mergeTriangle(Tile& tile, const uint32_t* coverage, const float* depth)
+{
+	for (int i = 0; i < kSubtiles; ++i)
+	{
+		// A triangle behind the reference layer cannot hide anything more
+		if (coverage[i] == 0 || depth[i] >= tile.referenceDepth[i])
+		{
+			continue;
+		}
+
+		// Keep the working layer only while the triangle is closer to it than to the reference layer;
+		// otherwise merging would push the working depth back towards the reference and lose both
+		const float toWorking = depth[i] - tile.workingDepth[i];
+		const float toReference = tile.referenceDepth[i] - depth[i];
+		if (toWorking > toReference)
+		{
+			tile.workingDepth[i] = kEmptyDepth;
+			tile.mask[i] = 0;
+		}
+
+		tile.workingDepth[i] = std::max(tile.workingDepth[i], depth[i]);
+		tile.mask[i] |= coverage[i];
+
+		// A full working layer bounds every pixel, it replaces the reference layer
+		if (tile.mask[i] == kFullMask)
+		{
+			tile.referenceDepth[i] = std::min(tile.referenceDepth[i], tile.workingDepth[i]);
+			tile.workingDepth[i] = kEmptyDepth;
+			tile.mask[i] = 0;
+		}
+	}
+}
+
+void OcclusionCuller::rasterizeBand(int tileRowBegin, int tileRowEnd)
+{
+	const size_t triangleCount = triangles.size() / 9;
+	const float rowBegin = static_cast<float>(tileRowBegin * kTileHeight);
+	const float rowEnd = static_cast<float>(tileRowEnd * kTileHeight);
+
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		const float* v0 = &triangles[t * 9 + 0];
+		const float* v1 = &triangles[t * 9 + 3];
+		const float* v2 = &triangles[t * 9 + 6];
+
+		const float minXf = std::min({ v0[0], v1[0], v2[0] });
+		const float maxXf = std::max({ v0[0], v1[0], v2[0] });
+		const float minYf = std::min({ v0[1], v1[1], v2[1] });
+		const float maxYf = std::max({ v0[1], v1[1], v2[1] });
+		if (maxYf < rowBegin || minYf >= rowEnd || maxXf < 0.0f || minXf >= kWidth)
+		{
+			continue;
+		}
+
+		const int tileX0 = std::max(static_cast<int>(std::floor(minXf)), 0) / kTileWidth;
+		const int tileX1 = std::min(static_cast<int>(std::ceil(maxXf)), kWidth - 1) / kTileWidth;
+		const int tileY0 = std::max(static_cast<int>(std::floor(minYf)) / kTileHeight, tileRowBegin);
+		const int tileY1 = std::min(std::min(static_cast<int>(std::ceil(maxYf)), kHeight - 1) / kTileHeight, tileRowEnd - 1);
+
+		// Edge and depth planes: value = a * x + b * y + c
+		const float area = edge(v0, v1, v2[0], v2[1]);
+		const float e0a = -(v2[1] - v1[1]), e0b = v2[0] - v1[0], e0c = -(e0a * v1[0] + e0b * v1[1]);
+		const float e1a = -(v0[1] - v2[1]), e1b = v0[0] - v2[0], e1c = -(e1a * v2[0] + e1b * v2[1]);
+		const float e2a = -(v1[1] - v0[1]), e2b = v1[0] - v0[0], e2c = -(e2a * v0[0] + e2b * v0[1]);
+
+		const float invArea = 1.0f / area;
+		const float za = (e0a * v0[2] + e1a * v1[2] + e2a * v2[2]) * invArea;
+		const float zb = (e0b * v0[2] + e1b * v1[2] + e2b * v2[2]) * invArea;
+		const float zc = (e0c * v0[2] + e1c * v1[2] + e2c * v2[2]) * invArea;
+		const float farthestVertex = std::max({ v0[2], v1[2], v2[2] });
+
+		for (int tileY = tileY0; tileY <= tileY1; ++tileY)
+		{
+			const float y0 = static_cast<float>(tileY * kTileHeight);
+
+			for (int tileX = tileX0; tileX <= tileX1; ++tileX)
+			{
+				const float x0 = static_cast<float>(tileX * kTileWidth);
+				uint32_t coverage[kSubtiles] = {};
+
+				// Coverage of the pixel centres, four pixels at a time; bit y * 8 + x of each subtile
+				for (int row = 0; row < kTileHeight; ++row)
+				{
+					const float py = y0 + row + 0.5f;
+#if RA_OCCLUSION_SSE
+					const __m128 zero = _mm_setzero_ps();
+					const __m128 step = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+					const __m128 row0 = _mm_set1_ps(e0b * py + e0c);
+					const __m128 row1 = _mm_set1_ps(e1b * py + e1c);
+					const __m128 row2 = _mm_set1_ps(e2b * py + e2c);
+
+					for (int group = 0; group < kTileWidth / 4; ++group)
+					{
+						const __m128 px = _mm_add_ps(_mm_set1_ps(x0 + group * 4), step);
+						const __m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0a), px), row0);
+						const __m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1a), px), row1);
+						const __m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2a), px), row2);
+						const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+
+						const uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(inside));
+						coverage[group / 2] |= bits << (row * kSubtileWidth + (group & 1) * 4);
+					}
+#else
+					for (int x = 0; x < kTileWidth; ++x)
+					{
+						const float px = x0 + x + 0.5f;
+						if (e0a * px + e0b * py + e0c >= 0.0f && e1a * px + e1b * py + e1c >= 0.0f && e2a * px + e2b * py + e2c >= 0.0f)
+						{
+							coverage[x / kSubtileWidth] |= 1u << (row * kSubtileWidth + x % kSubtileWidth);
+						}
+					}
+#endif
+				}
+
+				if ((coverage[0] | coverage[1] | coverage[2] | coverage[3]) == 0)
+				{
+					continue;
+				}
+
+				// Farthest depth of the triangle over each subtile: the depth plane at the far corner, which can
+				// overshoot past the triangle's edges, so never beyond its farthest vertex
+				float depth[kSubtiles];
+				const float cornerY = zb > 0.0f ? y0 + kTileHeight : y0;
+				for (int i = 0; i < kSubtiles; ++i)
+				{
+					const float subtileX = x0 + i * kSubtileWidth;
+					const float cornerX = za > 0.0f ? subtileX + kSubtileWidth : subtileX;
+					depth[i] = std::min(za * cornerX + zb * cornerY + zc, farthestVertex);
+				}
+
+				mergeTriangle(tiles[tileY * kTilesX + tileX], coverage, depth);
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::isVisible(const float* center, float radius) const
+{
+	++tested;
+
+	float minX = static_cast<float>(kWidth);
+	float maxX = 0.0f;
+	float minY = static_cast<float>(kHeight);
+	float maxY = 0.0f;
+	float nearest = kFarDepth;
+
+	// Screen rectangle and nearest depth of the sphere's bounding box
+	for (int i = 0; i < 8; ++i)
+	{
+		const float corner[3] = {
+			center[0] + ((i & 1) ? radius : -radius),
+			center[1] + ((i & 2) ? radius : -radius),
+			center[2] + ((i & 4) ? radius : -radius)
+		};
+
+		float clip[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			clip[k] = viewProj[k] * corner[0] + viewProj[4 + k] * corner[1] + viewProj[8 + k] * corner[2] + viewProj[12 + k];
+		}
+
+		if (clip[3] < kNearW)
+		{
+			return true;
+		}
+
+		const float invW = 1.0f / clip[3];
+		const float x = (clip[0] * invW * 0.5f + 0.5f) * kWidth;
+		const float y = (0.5f - clip[1] * invW * 0.5f) * kHeight;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearest = std::min(nearest, clip[2] * invW);
+	}
+
+	const int x0 = std::max(static_cast<int>(std::floor(minX)), 0);
+	const int x1 = std::min(static_cast<int>(std::ceil(maxX)), kWidth - 1);
+	const int y0 = std::max(static_cast<int>(std::floor(minY)), 0);
+	const int y1 = std::min(static_cast<int>(std::ceil(maxY)), kHeight - 1);
+
+	// Off screen bounds are left to frustum culling
+	if (x0 > x1 || y0 > y1)
+	{
+		return true;
+	}
+
+	for (int subtileY = y0 / kTileHeight; subtileY <= y1 / kTileHeight; ++subtileY)
+	{
+		for (int subtileX = x0 / kSubtileWidth; subtileX <= x1 / kSubtileWidth; ++subtileX)
+		{
+			const Tile& tile = tiles[subtileY * kTilesX + subtileX / kSubtiles];
+			const int i = subtileX % kSubtiles;
+
+			// Every pixel of the subtile is in front of the bound
+			if (nearest > tile.referenceDepth[i])
+			{
+				continue;
+			}
+
+			// Pixels of the working layer are no farther than either layer
+			if (nearest <= std::min(tile.referenceDepth[i], tile.workingDepth[i]))
+			{
+				return true;
+			}
+
+			// Only the reference layer is behind the bound, so it shows through any pixel outside the mask
+			const int px0 = std::max(x0, subtileX * kSubtileWidth) - subtileX * kSubtileWidth;
+			const int px1 = std::min(x1, subtileX * kSubtileWidth + kSubtileWidth - 1) - subtileX * kSubtileWidth;
+			const int py0 = std::max(y0, subtileY * kTileHeight) - subtileY * kTileHeight;
+			const int py1 = std::min(y1, subtileY * kTileHeight + kTileHeight - 1) - subtileY * kTileHeight;
+			const uint32_t rowBits = ((2u << px1) - 1u) & ~((1u << px0) - 1u);
+			uint32_t boundMask = 0;
+			for (int y = py0; y <= py1; ++y)
+			{
+				boundMask |= rowBits << (y * kSubtileWidth);
+			}
+
+			if ((boundMask & ~tile.mask[i]) != 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	++culled;
+	return false;
+}
+
+bool OcclusionCuller::isVisible(const float* center, float radius, const float* model) const
+{
+	float world[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		world[k] = model[k] * center[0] + model[4 + k] * center[1] + model[8 + k] * center[2] + model[12 + k];
+	}
+
+	float scale = 0.0f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const float* column = &model[axis * 4];
+		scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+	}
+
+	return isVisible(world, radius * scale);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// CPU occlusion culling against a low resolution masked depth buffer, after Intel's Masked Occlusion Culling.
+// The buffer is split into 32x4 pixel tiles of four 8x4 subtiles. Instead of a depth per pixel every subtile
+// keeps a 32 bit coverage mask and two depths: a reference layer bounding all of its pixels, and a working
+// layer bounding the pixels in the mask. Occluder triangles are rasterized with SSE a tile at a time into
+// bands of tile rows that worker threads fill independently, and only update the masks and layers; once a
+// working layer covers its whole subtile it becomes the reference layer.
+class OcclusionCuller
+{
+public:
+	// Buffer resolution; width must be a multiple of the tile width and height of the tile height
+	static constexpr int kWidth = 256;
+	static constexpr int kHeight = 128;
+	static constexpr int kTileWidth = 32;
+	static constexpr int kTileHeight = 4;
+	static constexpr int kSubtileWidth = 8;
+	static constexpr int kSubtilesPerTile = kTileWidth / kSubtileWidth;
+
+	OcclusionCuller();
+
+	// Start a new frame: clear the depth buffer and occluder list
+	void beginFrame(const float* viewProj);
+
+	// Queue an occluder; positions are float3, indices form triangles, model is column-major
+	void addOccluder(const float* positions, const uint32_t* indices, uint32_t indexCount, const float* model);
+
+	// Rasterize all queued occluders on worker threads; must be called before any visibility test
+	void rasterize();
+
+	// Test a world space bounding sphere; returns false when it is completely hidden
+	bool isVisible(const float* center, float radius) const;
+
+	// Test an object space bounding sphere transformed by a column-major model matrix
+	bool isVisible(const float* center, float radius, const float* model) const;
+
+	// Per frame statistics
+	uint32_t getOccluderCount() const { return occluderCount; }
+	uint32_t getTriangleCount() const { return static_cast<uint32_t>(triangles.size() / 9); }
+	uint32_t getTestedCount() const { return tested; }
+	uint32_t getCulledCount() const { return culled; }
+	float getRasterizeTime() const { return rasterizeMs; }
+
+private:
+	// Subtiles of one tile side by side, so a triangle updates them together
+	struct alignas(16) Tile
+	{
+		float referenceDepth[kSubtilesPerTile]; // Farthest depth of any pixel of the subtile
+		float workingDepth[kSubtilesPerTile];   // Farthest depth of the pixels in the mask
+		uint32_t mask[kSubtilesPerTile];        // Pixels of the working layer, bit y * 8 + x
+	};
+
+	// Rasterize every triangle into the tile rows [tileRowBegin, tileRowEnd)
+	void rasterizeBand(int tileRowBegin, int tileRowEnd);
+
+	// Merge a triangle covering the given pixels of each subtile, no farther than depth, into a tile
+	static void mergeTriangle(Tile& tile, const uint32_t* coverage, const float* depth);
+
+	float viewProj[16];
+
+	// Screen space triangles: x, y, depth per vertex
+	std::vector<float> triangles;
+	std::vector<Tile> tiles;
+	uint32_t occluderCount = 0;
+
+	mutable uint32_t tested = 0;
+	mutable uint32_t culled = 0;
+	float rasterizeMs = 0.0f;
+};
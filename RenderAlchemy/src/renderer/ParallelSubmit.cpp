@@ -0,0 +1,112 @@
+#include "ParallelSubmit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "../core/JobSystem.h"
+#include "ClusteredLights.h"
+#include "Geometry.h"
+
+namespace ParallelSubmit
+{
+	// What every range records with; jobs point at it so their captures stay within std::function's inline storage
+	struct Recording
+	{
+		const Geometry* geometry;
+		bgfx::ProgramHandle program;
+		uint64_t state;
+		const bgfx::InstanceDataBuffer* instances;
+		int lod;
+		const ClusteredLights* lights;
+	};
+
+	// Record draws [begin, end) into an encoder, each reading its own entry of the instance buffer
+	static void record(bgfx::Encoder* encoder, const Recording& recording, uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			encoder->setInstanceDataBuffer(recording.instances, i, 1);
+			if (recording.lights)
+			{
+				recording.lights->bind(encoder);
+			}
+			recording.geometry->draw(encoder, recording.program, recording.state, recording.lod, i);
+		}
+	}
+
+	SubmitStats submit(const Geometry& geometry, bgfx::ProgramHandle program, uint64_t state, const InstanceData* instances, uint32_t count, int lod, const ClusteredLights* lights, int threadCount)
+	{
+		SubmitStats stats;
+		const uint16_t stride = sizeof(InstanceData);
+		count = count > 0 ? bgfx::getAvailInstanceDataBuffer(count, stride) : 0;
+		if (count == 0)
+			return stats;
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		// One transient buffer shared by every draw, filled here since only the API thread may allocate it
+		bgfx::InstanceDataBuffer instanceBuffer;
+		bgfx::allocInstanceDataBuffer(&instanceBuffer, count, stride);
+		std::memcpy(instanceBuffer.data, instances, size_t(count) * stride);
+		const Recording recording = { &geometry, program, state, &instanceBuffer, lod, lights };
+
+		// More ranges than job threads would only add encoders without adding parallelism
+		const uint32_t threads = static_cast<uint32_t>(std::clamp(std::min(threadCount, JobSystem::getThreadCount()), 1, kMaxThreads));
+		const uint32_t chunk = (count + threads - 1) / threads;
+
+		struct Range
+		{
+			uint32_t begin;
+			uint32_t end;
+			bool recorded;
+		};
+
+		// Jobs take every range but the first; a job that gets no encoder leaves its range to the caller.
+		// There is at most one range per thread, so they live on the stack.
+		Range ranges[kMaxThreads];
+		uint32_t rangeCount = 0;
+		for (uint32_t begin = chunk; begin < count; begin += chunk)
+		{
+			ranges[rangeCount++] = { begin, std::min(begin + chunk, count), false };
+		}
+
+		JobCounter counter;
+		for (uint32_t i = 0; i < rangeCount; ++i)
+		{
+			JobSystem::run([recording = &recording, range = &ranges[i]]() {
+				bgfx::Encoder* encoder = bgfx::begin(true);
+				if (!encoder)
+					return;
+
+				record(encoder, *recording, range->begin, range->end);
+				bgfx::end(encoder);
+				range->recorded = true;
+			}, &counter);
+		}
+
+		// The calling thread records the first range on the main encoder meanwhile
+		bgfx::Encoder* encoder = bgfx::begin();
+		record(encoder, recording, 0, std::min(chunk, count));
+		stats.encoders = 1;
+
+		JobSystem::wait(counter);
+		for (uint32_t i = 0; i < rangeCount; ++i)
+		{
+			const Range& range = ranges[i];
+			if (range.recorded)
+			{
+				++stats.encoders;
+			}
+			else
+			{
+				record(encoder, recording, range.begin, range.end);
+			}
+		}
+		bgfx::end(encoder);
+
+		stats.draws = count;
+		stats.cpuMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return stats;
+	}
+} // namespace ParallelSubmit
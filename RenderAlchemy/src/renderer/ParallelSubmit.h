@@ -0,0 +1,30 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+
+#include "SceneInstances.h"
+
+class ClusteredLights;
+class Geometry;
+
+// Result of a parallel submission
+struct SubmitStats
+{
+	uint32_t draws = 0;
+	uint32_t encoders = 0; // Encoders that recorded draws, including the calling thread's
+	float cpuMs = 0.0f;    // Wall time spent recording on all threads
+};
+
+namespace ParallelSubmit
+{
+	// Upper bound on recording threads; bgfx must be initialised with at least this many encoders
+	constexpr int kMaxThreads = 16;
+
+	// Submit one draw per instance, split into contiguous ranges over up to threadCount jobs that each
+	// record into their own bgfx encoder. Every draw gets its index as sort depth, so with the view in
+	// ViewMode::DepthAscending the order reaching the GPU does not depend on how the work was split.
+	// program is the instanced scene program: each draw reads its own entry of one instance buffer, so the
+	// image, per instance tint included, matches a single instanced draw of the same instances.
+	SubmitStats submit(const Geometry& geometry, bgfx::ProgramHandle program, uint64_t state, const InstanceData* instances, uint32_t count, int lod, const ClusteredLights* lights, int threadCount);
+} // namespace ParallelSubmit
@@ -0,0 +1,76 @@
+#include "SceneInstances.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace SceneInstances
+{
+	// Height of the instance plane, just below the default camera
+	constexpr float kGroundHeight = -1.0f;
+
+	static void setTransform(InstanceData& instance, float x, float z, float angle, float scale)
+	{
+		const float c = std::cos(angle) * scale;
+		const float s = std::sin(angle) * scale;
+
+		// Rotation around Y followed by translation, column-major
+		const float transform[16] = {
+			c, 0.0f, -s, 0.0f,
+			0.0f, scale, 0.0f, 0.0f,
+			s, 0.0f, c, 0.0f,
+			x, kGroundHeight, z, 1.0f
+		};
+		std::copy(std::begin(transform), std::end(transform), instance.transform);
+	}
+
+	static void setTint(InstanceData& instance, float hue, float value)
+	{
+		// Cheap hue wheel so neighbouring instances are easy to tell apart
+		const float tau = 6.28318530718f;
+		instance.tint[0] = value * (0.5f + 0.5f * std::cos(tau * hue));
+		instance.tint[1] = value * (0.5f + 0.5f * std::cos(tau * (hue - 1.0f / 3.0f)));
+		instance.tint[2] = value * (0.5f + 0.5f * std::cos(tau * (hue - 2.0f / 3.0f)));
+		instance.tint[3] = 1.0f;
+	}
+
+	void generate(const InstanceLayout& layout, std::vector<InstanceData>& instances)
+	{
+		const int count = std::max(layout.count, 0);
+		instances.resize(count);
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+		const float extent = side * layout.spacing;
+
+		if (layout.placement == InstancePlacement::Grid)
+		{
+			const float offset = (side - 1) * layout.spacing * 0.5f;
+			for (int i = 0; i < count; ++i)
+			{
+				const int column = i % side;
+				const int row = i / side;
+				setTransform(instances[i], column * layout.spacing - offset, -row * layout.spacing, 0.0f, layout.scale);
+				setTint(instances[i], static_cast<float>(column) / side, 0.6f + 0.4f * static_cast<float>(row) / side);
+			}
+			return;
+		}
+
+		std::mt19937 rng(layout.seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		for (int i = 0; i < count; ++i)
+		{
+			const float x = (unit(rng) - 0.5f) * extent;
+			const float z = -unit(rng) * extent;
+			const float angle = unit(rng) * 6.28318530718f;
+			const float scale = layout.scale * (0.5f + unit(rng));
+			setTransform(instances[i], x, z, angle, scale);
+			setTint(instances[i], unit(rng), 0.6f + 0.4f * unit(rng));
+		}
+	}
+} // namespace SceneInstances
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Per-instance data as uploaded to bgfx instance buffers (i_data0..i_data4)
+struct InstanceData
+{
+	float transform[16]; // Column-major model matrix
+	float tint[4];       // RGBA multiplier for the base color
+};
+
+enum class InstancePlacement
+{
+	Grid,
+	Random
+};
+
+// Describes how repeated scene objects are placed
+struct InstanceLayout
+{
+	InstancePlacement placement = InstancePlacement::Grid;
+	int count = 1000;
+	float spacing = 1.5f; // Distance between grid cells; random layouts use the same average density
+	float scale = 0.5f;
+	uint32_t seed = 1;
+
+	bool operator==(const InstanceLayout& other) const
+	{
+		return placement == other.placement && count == other.count && spacing == other.spacing && scale == other.scale && seed == other.seed;
+	}
+
+	bool operator!=(const InstanceLayout& other) const { return !(*this == other); }
+};
+
+namespace SceneInstances
+{
+	// Most instances drawn through a transient instance buffer, chosen to fit bgfx's default pool
+	constexpr int kMaxTransientInstances = 50000;
+
+	// Fill instances according to the layout. Objects are spread over the XZ plane below and in front
+	// of the default camera; the same layout and seed always give the same result.
+	void generate(const InstanceLayout& layout, std::vector<InstanceData>& instances);
+} // namespace SceneInstances
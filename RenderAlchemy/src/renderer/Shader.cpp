@@ -14,6 +14,14 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
     m_program = bgfx::createProgram(vsh, fsh, true);
 }
 
+Shader::Shader(const std::string& computePath) {
+    compileShader(computePath, "compute.bin");
+
+    bgfx::ShaderHandle csh = loadShader("compute.bin");
+
+    m_program = bgfx::createProgram(csh, true);
+}
+
 Shader::~Shader() {
     bgfx::destroy(m_program);
     for (auto& pair : m_uniforms) {
@@ -21,13 +29,13 @@ Shader::~Shader() {
     }
 }
 
-void Shader::setUniform(const std::string& name, const void* value, uint16_t num) {
+void Shader::setUniform(std::string_view name, const void* value, uint16_t num) {
     bgfx::setUniform(getUniform(name), value, num);
 }
 
-void Shader::setTexture(const std::string& name, bgfx::TextureHandle texture, uint8_t stage)
+void Shader::setTexture(std::string_view name, bgfx::TextureHandle texture, uint8_t stage)
 {
-	bgfx::setTexture(stage, getUniform(name), texture);
+	bgfx::setTexture(stage, getUniform(name, bgfx::UniformType::Sampler), texture);
 }
 
 static const bgfx::Memory* loadMem(bx::FileReaderI* _reader, const bx::FilePath& _filePath)
@@ -125,14 +133,15 @@ void Shader::compileShader(const std::string& path, const std::string& output)
 {
 }
 
-bgfx::UniformHandle Shader::getUniform(const std::string& name)
+bgfx::UniformHandle Shader::getUniform(std::string_view name, bgfx::UniformType::Enum type)
 {
     auto it = m_uniforms.find(name);
     if (it != m_uniforms.end()) {
         return it->second;
     }
 
-    bgfx::UniformHandle uniform = bgfx::createUniform(name.c_str(), bgfx::UniformType::Vec4);
-    m_uniforms[name] = uniform;
+    std::string key(name);
+    bgfx::UniformHandle uniform = bgfx::createUniform(key.c_str(), type);
+    m_uniforms.emplace(std::move(key), uniform);
     return uniform;
 }
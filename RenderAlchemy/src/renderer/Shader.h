@@ -2,23 +2,31 @@
 
 #include <bgfx/bgfx.h>
 #include <bgfx/platform.h>
+#include <functional>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 
 class Shader {
 public:
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
+    explicit Shader(const std::string& computePath);
     ~Shader();
 
-    void setUniform(const std::string& name, const void* value, uint16_t num = 1);
-	void setTexture(const std::string& name, bgfx::TextureHandle texture, uint8_t stage = 0);
+    // Names are looked up without building a std::string, so setting uniforms every frame does not allocate
+    void setUniform(std::string_view name, const void* value, uint16_t num = 1);
+	void setTexture(std::string_view name, bgfx::TextureHandle texture, uint8_t stage = 0);
 
     bgfx::ProgramHandle m_program;
 private:
-    std::unordered_map<std::string, bgfx::UniformHandle> m_uniforms;
+    struct UniformNameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+    std::unordered_map<std::string, bgfx::UniformHandle, UniformNameHash, std::equal_to<>> m_uniforms;
 
     bgfx::ShaderHandle loadShader(const std::string& path);
     void compileShader(const std::string& path, const std::string& output);
-    bgfx::UniformHandle getUniform(const std::string& name);
+    bgfx::UniformHandle getUniform(std::string_view name, bgfx::UniformType::Enum type = bgfx::UniformType::Vec4);
 };
 
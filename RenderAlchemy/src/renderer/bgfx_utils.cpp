@@ -3,6 +3,7 @@
  * License: https://github.com/bkaradzic/bgfx/blob/master/LICENSE
  */
 
+#include <chrono>
 #include <string>
 
 #include <bgfx/bgfx.h>
@@ -376,6 +377,18 @@ namespace bgfx
 	int32_t read(bx::ReaderI* _reader, bgfx::VertexLayout& _layout, bx::Error* _err);
 }
 
+static void unpackPositions(std::vector<float>& _positions, const bgfx::VertexLayout& _layout, const void* _data, uint32_t _numVertices)
+{
+	_positions.resize(_numVertices*3);
+
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		float pos[4];
+		bgfx::vertexUnpack(pos, bgfx::Attrib::Position, _layout, _data, ii);
+		bx::memCopy(&_positions[ii*3], pos, 3*sizeof(float) );
+	}
+}
+
 void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 {
 	constexpr uint32_t kChunkVertexBuffer           = BX_MAKEFOURCC('V', 'B', ' ', 0x1);
@@ -389,6 +402,10 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 
 	Group group;
 
+	// CPU copies of the current group, handed to a worker thread for LOD generation
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+
 	bx::AllocatorI* allocator = entry::getAllocator();
 
 	uint32_t chunk;
@@ -412,6 +429,8 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				const bgfx::Memory* mem = bgfx::alloc(group.m_numVertices*stride);
 				read(_reader, mem->data, mem->size, &err);
 
+				unpackPositions(positions, m_layout, mem->data, group.m_numVertices);
+
 				if (_ramcopy)
 				{
 					group.m_vertices = (uint8_t*)bx::alloc(allocator, group.m_numVertices*stride);
@@ -446,6 +465,8 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 
 				bx::free(allocator, compressedVertices);
 
+				unpackPositions(positions, m_layout, mem->data, group.m_numVertices);
+
 				if (_ramcopy)
 				{
 					group.m_vertices = (uint8_t*)bx::alloc(allocator, group.m_numVertices*stride);
@@ -463,6 +484,8 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				const bgfx::Memory* mem = bgfx::alloc(group.m_numIndices*2);
 				read(_reader, mem->data, mem->size, &err);
 
+				indices.assign( (const uint16_t*)mem->data, (const uint16_t*)mem->data + group.m_numIndices);
+
 				if (_ramcopy)
 				{
 					group.m_indices = (uint16_t*)bx::alloc(allocator, group.m_numIndices*2);
@@ -490,6 +513,8 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 
 				bx::free(allocator, compressedIndices);
 
+				indices.assign( (const uint16_t*)mem->data, (const uint16_t*)mem->data + group.m_numIndices);
+
 				if (_ramcopy)
 				{
 					group.m_indices = (uint16_t*)bx::alloc(allocator, group.m_numIndices*2);
@@ -532,8 +557,15 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 					group.m_prims.push_back(prim);
 				}
 
+				const float center[3] = { group.m_sphere.center.x, group.m_sphere.center.y, group.m_sphere.center.z };
+				m_culler.add(center, group.m_sphere.radius);
+
 				m_groups.push_back(group);
 				group.reset();
+
+				m_pendingLods.push_back(MeshLod::buildChainAsync(std::move(indices), std::move(positions) ) );
+				indices.clear();
+				positions.clear();
 			}
 				break;
 
@@ -546,6 +578,9 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 
 void Mesh::unload()
 {
+	// LOD builds still running own their inputs and result, so dropping the futures is safe.
+	m_pendingLods.clear();
+
 	bx::AllocatorI* allocator = entry::getAllocator();
 
 	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
@@ -569,9 +604,64 @@ void Mesh::unload()
 		}
 	}
 	m_groups.clear();
+	m_culler.clear();
 }
 
-void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const
+bool Mesh::updateLods()
+{
+	bool updated = false;
+
+	for (uint32_t ii = 0, num = uint32_t(m_pendingLods.size() ); ii < num; ++ii)
+	{
+		JobFuture<LodChain>& pending = m_pendingLods[ii];
+
+		if (!pending.valid()
+		||  !pending.isReady() )
+		{
+			continue;
+		}
+
+		LodChain chain = pending.get();
+
+		Group& group = m_groups[ii];
+		if (1 >= chain.levels.size()
+		||  !bgfx::isValid(group.m_ibh) )
+		{
+			continue;
+		}
+
+		// All levels share one index buffer with level 0 at the front, so primitive ranges stay valid.
+		const bgfx::Memory* mem = bgfx::alloc(uint32_t(chain.indices.size()*sizeof(uint16_t) ) );
+		uint16_t* lodIndices = (uint16_t*)mem->data;
+
+		for (uint32_t jj = 0, numIndices = uint32_t(chain.indices.size() ); jj < numIndices; ++jj)
+		{
+			lodIndices[jj] = uint16_t(chain.indices[jj]);
+		}
+
+		bgfx::destroy(group.m_ibh);
+		group.m_ibh  = bgfx::createIndexBuffer(mem);
+		group.m_lods = chain.levels;
+
+		updated = true;
+	}
+
+	return updated;
+}
+
+static void setGroupIndexBuffer(const Group& _group, int32_t _lod)
+{
+	if (_group.m_lods.empty() )
+	{
+		bgfx::setIndexBuffer(_group.m_ibh);
+		return;
+	}
+
+	const LodLevel& level = _group.m_lods[bx::min(_lod, int32_t(_group.m_lods.size() ) - 1)];
+	bgfx::setIndexBuffer(_group.m_ibh, level.indexStart, level.indexCount);
+}
+
+static uint32_t submitGroups(const GroupArray& _groups, const uint32_t* _visible, uint32_t _numVisible, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const LodSelection* _lod)
 {
 	if (BGFX_STATE_MASK == _state)
 	{
@@ -588,11 +678,18 @@ void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _
 	bgfx::setTransform(_mtx);
 	bgfx::setState(_state);
 
-	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
+	for (uint32_t ii = 0; ii < _numVisible; ++ii)
 	{
-		const Group& group = *it;
+		const Group& group = _groups[NULL != _visible ? _visible[ii] : ii];
 
-		bgfx::setIndexBuffer(group.m_ibh);
+		int32_t lod = 0;
+		if (NULL != _lod)
+		{
+			const float center[3] = { group.m_sphere.center.x, group.m_sphere.center.y, group.m_sphere.center.z };
+			lod = MeshLod::selectLevel(group.m_lods, center, group.m_sphere.radius, _mtx, *_lod);
+		}
+
+		setGroupIndexBuffer(group, lod);
 		bgfx::setVertexBuffer(0, group.m_vbh);
 		bgfx::submit(
 			  _id
@@ -604,6 +701,47 @@ void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _
 	}
 
 	bgfx::discard();
+
+	return _numVisible;
+}
+
+void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const
+{
+	submitGroups(m_groups, NULL, uint32_t(m_groups.size() ), _id, _program, _mtx, _state, NULL);
+}
+
+void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const LodSelection& _lod) const
+{
+	submitGroups(m_groups, NULL, uint32_t(m_groups.size() ), _id, _program, _mtx, _state, &_lod);
+}
+
+uint32_t Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const Frustum& _frustum, const LodSelection* _lod, const OcclusionCuller* _occlusion) const
+{
+	// Test all group bounds in SIMD batches first, then submit the compacted list.
+	uint32_t numVisible = m_culler.cull(_frustum, _mtx, m_visible);
+
+	// Drop groups hidden behind the occluders, keeping the list compact.
+	if (NULL != _occlusion)
+	{
+		uint32_t numUnoccluded = 0;
+		for (uint32_t ii = 0; ii < numVisible; ++ii)
+		{
+			const bx::Sphere& sphere = m_groups[m_visible[ii] ].m_sphere;
+			const float center[3] = { sphere.center.x, sphere.center.y, sphere.center.z };
+			if (_occlusion->isVisible(center, sphere.radius, _mtx) )
+			{
+				m_visible[numUnoccluded++] = m_visible[ii];
+			}
+		}
+		numVisible = numUnoccluded;
+	}
+
+	if (0 == numVisible)
+	{
+		return 0;
+	}
+
+	return submitGroups(m_groups, m_visible.data(), numVisible, _id, _program, _mtx, _state, _lod);
 }
 
 void Mesh::submit(const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices) const
@@ -632,7 +770,7 @@ void Mesh::submit(const MeshState*const* _state, uint8_t _numPasses, const float
 		{
 			const Group& group = *it;
 
-			bgfx::setIndexBuffer(group.m_ibh);
+			setGroupIndexBuffer(group, 0);
 			bgfx::setVertexBuffer(0, group.m_vbh);
 			bgfx::submit(
 				  state.m_viewId
@@ -695,6 +833,16 @@ void meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _progra
 	_mesh->submit(_id, _program, _mtx, _state);
 }
 
+void meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const LodSelection& _lod)
+{
+	_mesh->submit(_id, _program, _mtx, _state, _lod);
+}
+
+uint32_t meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const Frustum& _frustum, const LodSelection* _lod, const OcclusionCuller* _occlusion)
+{
+	return _mesh->submit(_id, _program, _mtx, _state, _frustum, _lod, _occlusion);
+}
+
 void meshSubmit(const Mesh* _mesh, const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices)
 {
 	_mesh->submit(_state, _numPasses, _mtx, _numMatrices);
@@ -14,6 +14,10 @@
 
 #include <vector>
 
+#include "FrustumCuller.h"
+#include "MeshLod.h"
+#include "OcclusionCuller.h"
+
 ///
 void* load(const bx::FilePath& _filePath, uint32_t* _size = NULL);
 
@@ -111,6 +115,7 @@ struct Group
 	bx::Aabb   m_aabb;
 	bx::Obb    m_obb;
 	PrimitiveArray m_prims;
+	std::vector<LodLevel> m_lods;
 };
 typedef std::vector<Group> GroupArray;
 
@@ -118,11 +123,17 @@ struct Mesh
 {
 	void load(bx::ReaderSeekerI* _reader, bool _ramcopy);
 	void unload();
+	bool updateLods();
 	void submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const;
+	void submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const LodSelection& _lod) const;
+	uint32_t submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const Frustum& _frustum, const LodSelection* _lod = NULL, const OcclusionCuller* _occlusion = NULL) const;
 	void submit(const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices) const;
 
 	bgfx::VertexLayout m_layout;
 	GroupArray m_groups;
+	std::vector<JobFuture<LodChain> > m_pendingLods;
+	FrustumCuller m_culler;
+	mutable std::vector<uint32_t> m_visible;
 };
 
 ///
@@ -140,6 +151,13 @@ void meshStateDestroy(MeshState* _meshState);
 ///
 void meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state = BGFX_STATE_MASK);
 
+/// Submit with per-group level of detail picked by projected screen-space error.
+void meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const LodSelection& _lod);
+
+/// Submit only the groups whose bounding spheres intersect the frustum and, when an occlusion culler
+/// is given, are not hidden behind its rasterized occluders. Returns number of groups submitted.
+uint32_t meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const Frustum& _frustum, const LodSelection* _lod = NULL, const OcclusionCuller* _occlusion = NULL);
+
 ///
 void meshSubmit(const Mesh* _mesh, const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices = 1);
 